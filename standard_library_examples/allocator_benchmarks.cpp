@@ -0,0 +1,406 @@
+#include "slab_allocator.hpp"
+
+#include <algorithm>       // std::max, std::nth_element
+#include <array>           // std::array
+#include <atomic>          // std::atomic
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstddef>         // std::byte, std::ptrdiff_t
+#include <cstdint>         // std::size_t, std::int64_t, std::uint64_t
+#include <deque>           // std::pmr::deque
+#include <fstream>         // std::ifstream, std::ofstream
+#include <functional>      // std::less
+#include <iostream>        // std::cout, std::cerr
+#include <memory>          // std::unique_ptr
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::monotonic_buffer_resource
+#include <queue>           // std::queue, std::priority_queue
+#include <sstream>         // std::istringstream
+#include <stdexcept>       // std::invalid_argument
+#include <string>          // std::string, std::stoul
+#include <thread>          // std::thread, std::this_thread::yield
+#include <vector>          // std::vector, std::pmr::vector
+
+#include <unistd.h> // sysconf
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t elements_per_operation = 256;
+
+/// @brief Point of a QuadTree.
+struct Point
+{
+    double x, y;
+};
+
+/// @brief Fills and drains a queue on a deque, as the ThreadSafeQueue does.
+std::size_t queueOperation(std::pmr::memory_resource *resource, std::size_t seed)
+{
+    std::queue<std::size_t, std::pmr::deque<std::size_t>> queue{std::pmr::deque<std::size_t>(resource)};
+    for (std::size_t i = 0; i < elements_per_operation; ++i)
+    {
+        queue.push(seed + i);
+    }
+    std::size_t checksum = 0;
+    while (!queue.empty())
+    {
+        checksum += queue.front();
+        queue.pop();
+    }
+    return checksum;
+}
+
+/// @brief Fills and drains a priority queue on a vector, as the priority queue examples do.
+std::size_t priorityQueueOperation(std::pmr::memory_resource *resource, std::size_t seed)
+{
+    std::priority_queue<std::size_t, std::pmr::vector<std::size_t>> queue{std::less<std::size_t>(),
+                                                                          std::pmr::vector<std::size_t>(resource)};
+    for (std::size_t i = 0; i < elements_per_operation; ++i)
+    {
+        queue.push((seed * 7919 + i * 104729) % 1000);
+    }
+    std::size_t checksum = 0;
+    while (!queue.empty())
+    {
+        checksum += queue.top();
+        queue.pop();
+    }
+    return checksum;
+}
+
+/// @brief Collects points into per-node vectors and appends them to one result, as QuadTree::query does.
+std::size_t pointVectorOperation(std::pmr::memory_resource *resource, std::size_t seed)
+{
+    std::pmr::vector<Point> result(resource);
+    for (std::size_t node = 0; node < 16; ++node)
+    {
+        std::pmr::vector<Point> node_result(resource);
+        for (std::size_t i = 0; i < elements_per_operation / 16; ++i)
+        {
+            node_result.push_back({static_cast<double>(seed + node), static_cast<double>(i)});
+        }
+        result.insert(result.end(), node_result.begin(), node_result.end());
+    }
+    return result.size();
+}
+
+/// @brief Container workload of the matrix. One operation builds a container from scratch and destroys it.
+struct ContainerBenchmark
+{
+    const char *name;
+    std::size_t (*operation)(std::pmr::memory_resource *, std::size_t);
+};
+
+constexpr std::array<ContainerBenchmark, 3> container_benchmarks = {{
+    {"queue<deque>", queueOperation},
+    {"priority_queue<vector>", priorityQueueOperation},
+    {"vector<Point>", pointVectorOperation},
+}};
+
+/// @brief Memory resources of the matrix. Resources that are not thread-safe are created per thread.
+enum class AllocatorKind
+{
+    Default,
+    Monotonic,
+    UnsynchronizedPool,
+    SynchronizedPool,
+    Slab,
+};
+
+constexpr std::array<AllocatorKind, 5> allocator_kinds = {AllocatorKind::Default, AllocatorKind::Monotonic,
+                                                          AllocatorKind::UnsynchronizedPool,
+                                                          AllocatorKind::SynchronizedPool, AllocatorKind::Slab};
+
+const char *allocatorName(AllocatorKind kind)
+{
+    switch (kind)
+    {
+    case AllocatorKind::Default:
+        return "new_delete_resource";
+    case AllocatorKind::Monotonic:
+        return "monotonic_buffer_resource per thread";
+    case AllocatorKind::UnsynchronizedPool:
+        return "unsynchronized_pool_resource per thread";
+    case AllocatorKind::SynchronizedPool:
+        return "synchronized_pool_resource";
+    case AllocatorKind::Slab:
+        return "SlabResource";
+    }
+    return "unknown";
+}
+
+/// @brief Result of one cell of the matrix.
+struct BenchmarkResult
+{
+    std::string container;
+    std::string allocator;
+    std::size_t threads;
+    std::uint64_t operations;
+    double operations_per_second;
+    double p50_latency_ns;
+    double p99_latency_ns;
+    std::int64_t rss_kib;
+    std::int64_t rss_growth_kib;
+};
+
+/// @brief Returns the resident set size of the process in KiB, or -1 if it cannot be read.
+std::int64_t residentSetKib()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::int64_t size_pages = 0;
+    std::int64_t resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages))
+    {
+        return -1;
+    }
+    return resident_pages * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/// @brief Returns the latency below which the given fraction of the samples lie.
+double percentile(std::vector<double> &samples, double fraction)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+    const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+/// @brief Runs the operation of the container on every thread with the given allocator and measures the throughput
+/// of all threads together, the latency of every single operation and the growth of the resident set.
+BenchmarkResult runCell(const ContainerBenchmark &container, AllocatorKind allocator, std::size_t number_of_threads,
+                        std::size_t operations_per_thread)
+{
+    std::pmr::synchronized_pool_resource synchronized_pool;
+    SlabResource slab_resource;
+    std::vector<std::vector<double>> latencies(number_of_threads);
+    std::atomic<std::size_t> ready_threads{0};
+    std::atomic<bool> start{false};
+    const std::int64_t rss_before = residentSetKib();
+
+    std::vector<std::thread> threads;
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        threads.emplace_back([&, thread_no] {
+            // Resources that are not thread-safe belong to the thread, the monotonic one reuses its buffer
+            auto monotonic_buffer = std::make_unique<std::array<std::byte, 64 * 1024>>();
+            std::pmr::monotonic_buffer_resource monotonic(monotonic_buffer->data(), monotonic_buffer->size());
+            std::pmr::unsynchronized_pool_resource unsynchronized_pool;
+            std::pmr::memory_resource *resource = std::pmr::new_delete_resource();
+            switch (allocator)
+            {
+            case AllocatorKind::Default:
+                break;
+            case AllocatorKind::Monotonic:
+                resource = &monotonic;
+                break;
+            case AllocatorKind::UnsynchronizedPool:
+                resource = &unsynchronized_pool;
+                break;
+            case AllocatorKind::SynchronizedPool:
+                resource = &synchronized_pool;
+                break;
+            case AllocatorKind::Slab:
+                resource = &slab_resource;
+                break;
+            }
+
+            std::vector<double> &samples = latencies[thread_no];
+            samples.reserve(operations_per_thread);
+            ready_threads.fetch_add(1);
+            while (!start.load())
+            {
+                std::this_thread::yield();
+            }
+
+            std::size_t checksum = 0;
+            for (std::size_t operation_no = 0; operation_no < operations_per_thread; ++operation_no)
+            {
+                const auto start_time = std::chrono::high_resolution_clock::now();
+                checksum += container.operation(resource, operation_no);
+                if (allocator == AllocatorKind::Monotonic)
+                {
+                    monotonic.release();
+                }
+                const auto stop_time = std::chrono::high_resolution_clock::now();
+                samples.push_back(static_cast<double>((stop_time - start_time).count()));
+            }
+            doNotOptimize(checksum);
+        });
+    }
+
+    while (ready_threads.load() < number_of_threads)
+    {
+        std::this_thread::yield();
+    }
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    start.store(true);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    const std::int64_t rss_after = residentSetKib();
+
+    std::vector<double> samples;
+    for (const auto &thread_samples : latencies)
+    {
+        samples.insert(samples.end(), thread_samples.begin(), thread_samples.end());
+    }
+    const std::uint64_t operations = number_of_threads * operations_per_thread;
+    const double elapsed_seconds = (stop_time - start_time).count() / 1e9;
+
+    BenchmarkResult result;
+    result.container = container.name;
+    result.allocator = allocatorName(allocator);
+    result.threads = number_of_threads;
+    result.operations = operations;
+    result.operations_per_second = operations / elapsed_seconds;
+    result.p50_latency_ns = percentile(samples, 0.50);
+    result.p99_latency_ns = percentile(samples, 0.99);
+    result.rss_kib = rss_after;
+    result.rss_growth_kib = rss_after - rss_before;
+    return result;
+}
+
+/// @brief Writes the results as CSV with one row per cell of the matrix.
+void writeCsv(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    out << "container,allocator,threads,operations,ops_per_second,p50_latency_ns,p99_latency_ns,rss_kib,"
+           "rss_growth_kib\n";
+    for (const auto &result : results)
+    {
+        out << "\"" << result.container << "\",\"" << result.allocator << "\"," << result.threads << ","
+            << result.operations << "," << result.operations_per_second << "," << result.p50_latency_ns << ","
+            << result.p99_latency_ns << "," << result.rss_kib << "," << result.rss_growth_kib << "\n";
+    }
+}
+
+/// @brief Writes the results as a JSON array with one object per cell of the matrix.
+void writeJson(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    out << "[";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult &result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "  {\"container\": \"" << result.container << "\", \"allocator\": \""
+            << result.allocator << "\", \"threads\": " << result.threads << ", \"operations\": " << result.operations
+            << ", \"ops_per_second\": " << result.operations_per_second
+            << ", \"p50_latency_ns\": " << result.p50_latency_ns << ", \"p99_latency_ns\": " << result.p99_latency_ns
+            << ", \"rss_kib\": " << result.rss_kib << ", \"rss_growth_kib\": " << result.rss_growth_kib << "}";
+    }
+    out << (results.empty() ? "]\n" : "\n]\n");
+}
+
+/// @brief Parses a comma separated list of thread counts.
+std::vector<std::size_t> parseThreadCounts(const std::string &text)
+{
+    std::vector<std::size_t> thread_counts;
+    std::istringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        const std::size_t thread_count = std::stoul(item);
+        if (thread_count == 0)
+        {
+            throw std::invalid_argument("thread count must be positive");
+        }
+        thread_counts.push_back(thread_count);
+    }
+    return thread_counts;
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [--format csv|json] [--output <path>] [--threads <n,n,...>]"
+              << " [--operations <per thread>]\n";
+}
+
+int main(int argc, const char **argv)
+{
+    std::string format = "csv";
+    std::string output_path;
+    std::vector<std::size_t> thread_counts = {1, 2, std::max(4U, std::thread::hardware_concurrency())};
+    std::size_t operations_per_thread = 10'000;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (i + 1 == argc)
+            {
+                throw std::invalid_argument("missing value for " + argument);
+            }
+            const std::string value = argv[++i];
+            if (argument == "--format" && (value == "csv" || value == "json"))
+            {
+                format = value;
+            }
+            else if (argument == "--output")
+            {
+                output_path = value;
+            }
+            else if (argument == "--threads")
+            {
+                thread_counts = parseThreadCounts(value);
+            }
+            else if (argument == "--operations")
+            {
+                operations_per_thread = std::stoul(value);
+            }
+            else
+            {
+                throw std::invalid_argument("invalid argument " + argument + " " + value);
+            }
+        }
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << "\n";
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const auto &container : container_benchmarks)
+    {
+        for (const auto allocator : allocator_kinds)
+        {
+            for (const auto number_of_threads : thread_counts)
+            {
+                results.push_back(runCell(container, allocator, number_of_threads, operations_per_thread));
+                const BenchmarkResult &result = results.back();
+                std::cerr << result.container << ", " << result.allocator << ", " << result.threads
+                          << " threads: " << result.operations_per_second << " ops/s, p50 " << result.p50_latency_ns
+                          << " ns, p99 " << result.p99_latency_ns << " ns" << std::endl;
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!output_path.empty())
+    {
+        file.open(output_path);
+        if (!file)
+        {
+            std::cerr << "Cannot open " << output_path << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream &out = output_path.empty() ? std::cout : file;
+    if (format == "json")
+    {
+        writeJson(out, results);
+    }
+    else
+    {
+        writeCsv(out, results);
+    }
+
+    return EXIT_SUCCESS;
+}
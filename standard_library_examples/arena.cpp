@@ -0,0 +1,128 @@
+#include "arena.hpp"
+
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <iostream>        // std::cout
+#include <memory_resource> // std::pmr::new_delete_resource, std::pmr::monotonic_buffer_resource
+#include <string>          // std::pmr::string
+#include <unordered_map>   // std::pmr::unordered_map
+#include <vector>          // std::pmr::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_requests = 100'000;
+constexpr std::size_t number_of_items = 256;
+
+/// @brief Simulates handling one request: collects item ids into a vector, indexes them in a hash map and looks every
+/// id up again. All temporary containers allocate from the given resource and die with the request.
+std::size_t handleRequest(std::pmr::memory_resource *resource, const std::size_t request_no)
+{
+    std::pmr::vector<int> ids(resource);
+    std::pmr::unordered_map<int, std::size_t> positions(resource);
+    for (std::size_t i = 0; i < number_of_items; ++i)
+    {
+        const auto id = static_cast<int>((request_no + i * 7919) % 100'003);
+        ids.push_back(id);
+        positions.emplace(id, i);
+    }
+
+    std::size_t checksum = 0;
+    for (const auto id : ids)
+    {
+        checksum += positions.find(id)->second;
+    }
+    return checksum;
+}
+
+/// @brief Handles every request with the temporary containers allocating from the global heap.
+double benchmarkHeap()
+{
+    std::size_t checksum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t request_no = 0; request_no < number_of_requests; ++request_no)
+    {
+        checksum += handleRequest(std::pmr::new_delete_resource(), request_no);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(checksum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Handles every request with a fresh monotonic_buffer_resource, which grows from the heap on every request.
+double benchmarkMonotonicBuffer()
+{
+    std::size_t checksum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t request_no = 0; request_no < number_of_requests; ++request_no)
+    {
+        std::pmr::monotonic_buffer_resource buffer;
+        checksum += handleRequest(&buffer, request_no);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(checksum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Handles every request from one arena that is reset in between, so after the first request the chunks are
+/// reused and the heap is not touched at all.
+template <typename ArenaType> double benchmarkArena(ArenaType &arena)
+{
+    std::size_t checksum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t request_no = 0; request_no < number_of_requests; ++request_no)
+    {
+        checksum += handleRequest(&arena, request_no);
+        arena.reset();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(checksum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    {
+        StackArena<1024> arena;
+        std::pmr::vector<int> frame_data({1, 2, 3}, &arena);
+
+        {
+            // Everything allocated inside the scope is released when it ends, frame_data stays valid
+            ArenaScope scope(arena);
+            std::pmr::string scratch("temporary scratch text that does not fit the small string buffer", &arena);
+            std::pmr::vector<double> samples(512, 1.0, &arena);
+            std::cout << "Chunks inside the scope: " << arena.numberOfChunks() << std::endl;
+        }
+
+        frame_data.push_back(4);
+        for (const auto value : frame_data)
+        {
+            std::cout << value << " ";
+        }
+        std::cout << std::endl;
+
+        // The chunk grown for the samples is kept and reused by the next frame
+        arena.reset();
+        std::pmr::vector<double> next_samples(512, 2.0, &arena);
+        std::cout << "Chunks after the reset: " << arena.numberOfChunks() << std::endl;
+    }
+
+    std::cout << "Elapsed time (default heap): " << benchmarkHeap() << std::endl;
+    std::cout << "Elapsed time (monotonic_buffer_resource per request): " << benchmarkMonotonicBuffer() << std::endl;
+
+    Arena heap_arena;
+    std::cout << "Elapsed time (Arena reset per request): " << benchmarkArena(heap_arena) << std::endl;
+    std::cout << "Chunks: " << heap_arena.numberOfChunks() << std::endl;
+
+    StackArena<64 * 1024> stack_arena;
+    std::cout << "Elapsed time (StackArena<64 KiB> reset per request): " << benchmarkArena(stack_arena) << std::endl;
+    std::cout << "Chunks: " << stack_arena.numberOfChunks() << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>       // std::max
+#include <cstddef>         // std::byte, std::max_align_t
+#include <cstdint>         // std::size_t, std::uintptr_t
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::get_default_resource
+#include <new>             // std::bad_alloc
+
+/// @brief Arena is a bump allocator for memory that is released all at once, e.g. everything allocated while
+/// handling one request or one frame. Allocating moves a cursor through the current chunk and deallocating does
+/// nothing; reset() rewinds the cursor to the start of the first chunk in O(1). When a chunk is exhausted the arena
+/// moves on to the next chunk, allocating it from the upstream resource with twice the size of the previous one if
+/// it does not exist yet. Chunks are kept across resets, so once the arena has grown to the peak demand of a request,
+/// later requests do not allocate from the upstream resource at all. The first chunk can be a caller-provided buffer,
+/// typically on the stack, see StackArena. mark() and rollback() release only what was allocated after a checkpoint,
+/// see ArenaScope.
+class Arena : public std::pmr::memory_resource
+{
+    /// @brief Header of a chunk allocated from the upstream resource, followed by the chunk's memory.
+    struct Chunk
+    {
+        Chunk *next;
+        std::size_t size;
+
+        std::byte *begin() noexcept
+        {
+            return reinterpret_cast<std::byte *>(this + 1);
+        }
+
+        std::byte *end() noexcept
+        {
+            return begin() + size;
+        }
+    };
+
+  public:
+    /// @brief Position of the cursor, which allocations after it can be rolled back to.
+    struct Marker
+    {
+        Chunk *chunk;
+        std::byte *cursor;
+        std::byte *end;
+    };
+
+    /// @brief Smallest chunk, in bytes, that is allocated from the upstream resource.
+    static constexpr std::size_t min_chunk_size = 4096;
+
+    /// @brief Constructor of the Arena class without an initial buffer.
+    /// @param upstream Resource that the chunks are allocated from.
+    explicit Arena(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : Arena(nullptr, 0, upstream)
+    {
+    }
+
+    /// @brief Constructor of the Arena class that uses a caller-provided buffer as its first chunk. The buffer is
+    /// not owned by the arena and must outlive it.
+    /// @param buffer Memory used before any chunk is allocated from the upstream resource.
+    /// @param buffer_size Size of the buffer in bytes.
+    /// @param upstream Resource that the chunks are allocated from.
+    Arena(void *buffer, std::size_t buffer_size,
+          std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : upstream_(upstream), buffer_(static_cast<std::byte *>(buffer)), buffer_size_(buffer_size),
+          next_chunk_size_(std::max(min_chunk_size, buffer_size)), cursor_(buffer_), end_(buffer_ + buffer_size)
+    {
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /// @brief Destructor of the Arena class, returns all chunks to the upstream resource.
+    ~Arena() override
+    {
+        release();
+    }
+
+    /// @brief Rewinds the arena to the start of its first chunk, keeping all chunks for reuse. All memory allocated
+    /// from the arena becomes invalid, and no destructors are run.
+    void reset() noexcept
+    {
+        current_chunk_ = nullptr;
+        cursor_ = buffer_;
+        end_ = buffer_ + buffer_size_;
+    }
+
+    /// @brief Rewinds the arena and returns all chunks to the upstream resource.
+    void release() noexcept
+    {
+        while (first_chunk_ != nullptr)
+        {
+            Chunk *next = first_chunk_->next;
+            upstream_->deallocate(first_chunk_, sizeof(Chunk) + first_chunk_->size, alignof(Chunk));
+            first_chunk_ = next;
+        }
+        next_chunk_size_ = std::max(min_chunk_size, buffer_size_);
+        reset();
+    }
+
+    /// @brief Returns a checkpoint of the current cursor position.
+    Marker mark() const noexcept
+    {
+        return {current_chunk_, cursor_, end_};
+    }
+
+    /// @brief Releases everything that was allocated after the marker was taken. Markers taken after it become
+    /// invalid, markers taken before it stay valid, so checkpoints nest like a stack.
+    /// @param marker Checkpoint returned by mark().
+    void rollback(const Marker &marker) noexcept
+    {
+        current_chunk_ = marker.chunk;
+        cursor_ = marker.cursor;
+        end_ = marker.end;
+    }
+
+    /// @brief Returns the number of chunks allocated from the upstream resource.
+    std::size_t numberOfChunks() const noexcept
+    {
+        std::size_t count = 0;
+        for (const Chunk *chunk = first_chunk_; chunk != nullptr; chunk = chunk->next)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    /// @brief Returns the upstream resource that the chunks are allocated from.
+    std::pmr::memory_resource *upstream_resource() const noexcept
+    {
+        return upstream_;
+    }
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (std::byte *pointer = bump(bytes, alignment))
+        {
+            return pointer;
+        }
+        advance(bytes, alignment);
+        return bump(bytes, alignment);
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override
+    {
+        // Memory is only released by reset(), rollback() and release()
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    /// @brief Allocates from the current chunk, or returns nullptr if the request does not fit.
+    std::byte *bump(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        const auto cursor = reinterpret_cast<std::uintptr_t>(cursor_);
+        const auto aligned = (cursor + alignment - 1) & ~(alignment - 1);
+        const auto available = reinterpret_cast<std::uintptr_t>(end_);
+        if (cursor_ == nullptr || aligned > available || bytes > available - aligned)
+        {
+            return nullptr;
+        }
+        cursor_ = reinterpret_cast<std::byte *>(aligned + bytes);
+        return reinterpret_cast<std::byte *>(aligned);
+    }
+
+    /// @brief Makes the chunk after the current one current. A kept chunk is reused if the request fits into it,
+    /// otherwise a new chunk is allocated from the upstream resource and linked in before it.
+    void advance(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t required = bytes + alignment - 1;
+        Chunk *&link = (current_chunk_ == nullptr) ? first_chunk_ : current_chunk_->next;
+        if (link == nullptr || link->size < required)
+        {
+            const std::size_t size = std::max(next_chunk_size_, required);
+            auto *chunk = static_cast<Chunk *>(upstream_->allocate(sizeof(Chunk) + size, alignof(Chunk)));
+            chunk->next = link;
+            chunk->size = size;
+            link = chunk;
+            next_chunk_size_ = 2 * size;
+        }
+        current_chunk_ = link;
+        cursor_ = link->begin();
+        end_ = link->end();
+    }
+
+    std::pmr::memory_resource *upstream_;
+    std::byte *buffer_;
+    std::size_t buffer_size_;
+    std::size_t next_chunk_size_;
+    Chunk *first_chunk_ = nullptr;
+    Chunk *current_chunk_ = nullptr;
+    std::byte *cursor_;
+    std::byte *end_;
+};
+
+/// @brief Arena whose first chunk is a buffer of Bytes bytes inside the object itself, so an arena declared as a
+/// local variable serves small requests from the stack and only falls back to the upstream resource for the rest.
+/// @tparam Bytes Size of the inline buffer
+template <std::size_t Bytes> class StackArena final : public Arena
+{
+  public:
+    /// @brief Constructor of the StackArena class.
+    /// @param upstream Resource that the chunks beyond the inline buffer are allocated from.
+    explicit StackArena(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : Arena(buffer_, Bytes, upstream)
+    {
+    }
+
+  private:
+    alignas(std::max_align_t) std::byte buffer_[Bytes];
+};
+
+/// @brief ArenaScope takes a checkpoint of an arena when it is created and rolls the arena back to it when it is
+/// destroyed, releasing everything that was allocated in between. Scopes nest. Objects allocated from the arena
+/// inside the scope must not be used after the scope ends.
+class ArenaScope final
+{
+  public:
+    /// @brief Constructor of the ArenaScope class.
+    /// @param arena Arena to take the checkpoint of.
+    explicit ArenaScope(Arena &arena) noexcept : arena_(arena), marker_(arena.mark())
+    {
+    }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    /// @brief Destructor of the ArenaScope class, rolls the arena back to the checkpoint.
+    ~ArenaScope()
+    {
+        arena_.rollback(marker_);
+    }
+
+  private:
+    Arena &arena_;
+    Arena::Marker marker_;
+};
@@ -1,22 +1,21 @@
-#include <iostream>
-#include <memory_resource>
-#include <vector>
+#include "slab_allocator.hpp"
 
-template <typename T> struct Allocator
-{
-    using value_type = T;
-    T *allocate(std::size_t n)
-    {
-        std::cout << "Allocating " << n << " objects of size " << sizeof(T) << std::endl;
-        return static_cast<T *>(::operator new(n * sizeof(T)));
-    }
+#include <algorithm>       // std::max
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <iostream>        // std::cout
+#include <list>            // std::list
+#include <map>             // std::map
+#include <memory_resource> // std::pmr::monotonic_buffer_resource, std::pmr::synchronized_pool_resource
+#include <string>          // std::string
+#include <thread>          // std::thread
+#include <vector>          // std::vector
 
-    void deallocate(T *p, std::size_t n)
-    {
-        std::cout << "Deallocating " << n << " objects of size " << sizeof(T) << std::endl;
-        ::operator delete(p);
-    }
-};
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
 
 template <typename ValueType, typename AllocatorType>
 void printVector(const std::vector<ValueType, AllocatorType> &vector)
@@ -29,11 +28,63 @@ void printVector(const std::vector<ValueType, AllocatorType> &vector)
     std::cout << std::endl;
 }
 
+constexpr std::size_t number_of_elements = 1'000;
+constexpr std::size_t number_of_rounds = 1'000;
+
+/// @brief Every thread creates its own container and repeatedly fills and empties it, so that the allocator serves a
+/// steady stream of allocations and frees from all threads at once.
+/// @param number_of_threads Number of threads churning concurrently.
+/// @param make_container Callable returning an empty container that uses the allocator under test.
+/// @param churn Callable that fills and empties the container once.
+template <typename MakeContainer, typename Churn>
+double benchmarkChurn(const std::size_t number_of_threads, MakeContainer make_container, Churn churn)
+{
+    std::vector<std::thread> threads;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        threads.emplace_back([&] {
+            auto container = make_container();
+            for (std::size_t round = 0; round < number_of_rounds; ++round)
+            {
+                churn(container);
+                doNotOptimize(container);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Runs the churn of one container type with malloc, a shared std::pmr::synchronized_pool_resource, the
+/// SlabResource and the SlabAllocator.
+template <typename MallocContainer, typename PmrContainer, typename SlabContainer, typename Churn>
+void compareAllocators(const std::string &name, const std::size_t number_of_threads, Churn churn)
+{
+    std::pmr::synchronized_pool_resource pool;
+    SlabResource slab_resource;
+
+    std::cout << "Elapsed time (" << name << ", malloc, " << number_of_threads << " threads): "
+              << benchmarkChurn(number_of_threads, [] { return MallocContainer(); }, churn) << std::endl;
+    std::cout << "Elapsed time (" << name << ", synchronized_pool_resource, " << number_of_threads << " threads): "
+              << benchmarkChurn(number_of_threads, [&pool] { return PmrContainer(&pool); }, churn) << std::endl;
+    std::cout << "Elapsed time (" << name << ", SlabResource, " << number_of_threads << " threads): "
+              << benchmarkChurn(number_of_threads, [&slab_resource] { return PmrContainer(&slab_resource); }, churn)
+              << std::endl;
+    std::cout << "Elapsed time (" << name << ", SlabAllocator, " << number_of_threads << " threads): "
+              << benchmarkChurn(number_of_threads, [] { return SlabContainer(); }, churn) << std::endl;
+}
+
 int main()
 {
     {
-        // Declare a vector with a custom allocator
-        std::vector<int, Allocator<int>> vector;
+        // Declare a vector with the slab allocator
+        std::vector<int, SlabAllocator<int>> vector;
 
         // Reserve space for 10 element
         vector.reserve(10);
@@ -61,5 +112,54 @@ int main()
         printVector(pmr_vector);
     }
 
+    {
+        // The slab heap is also available as a memory resource, and memory may be freed on any thread
+        SlabResource slab_resource;
+        std::pmr::vector<int> pmr_vector({21, 22, 23}, &slab_resource);
+        std::thread([moved = std::move(pmr_vector)] { printVector(moved); }).join();
+        std::cout << "Slabs carved: " << SlabHeap::numberOfSlabs() << std::endl;
+    }
+
+    const std::size_t number_of_threads = std::max(2U, std::thread::hardware_concurrency());
+
+    compareAllocators<std::vector<int>, std::pmr::vector<int>, std::vector<int, SlabAllocator<int>>>(
+        "std::vector", number_of_threads, [](auto &vector) {
+            for (std::size_t i = 0; i < number_of_elements; ++i)
+            {
+                vector.push_back(static_cast<int>(i));
+            }
+            while (!vector.empty())
+            {
+                vector.pop_back();
+            }
+            // Releases the buffer, so that every round grows the vector from scratch
+            vector.shrink_to_fit();
+        });
+
+    compareAllocators<std::list<int>, std::pmr::list<int>, std::list<int, SlabAllocator<int>>>(
+        "std::list", number_of_threads, [](auto &list) {
+            for (std::size_t i = 0; i < number_of_elements; ++i)
+            {
+                list.push_back(static_cast<int>(i));
+            }
+            while (!list.empty())
+            {
+                list.pop_front();
+            }
+        });
+
+    compareAllocators<std::map<int, int>, std::pmr::map<int, int>,
+                      std::map<int, int, std::less<int>, SlabAllocator<std::pair<const int, int>>>>(
+        "std::map", number_of_threads, [](auto &map) {
+            for (std::size_t i = 0; i < number_of_elements; ++i)
+            {
+                map.emplace(static_cast<int>(i), static_cast<int>(i));
+            }
+            while (!map.empty())
+            {
+                map.erase(map.begin());
+            }
+        });
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>  // std::atomic, std::atomic_thread_fence
+#include <climits> // INT_MAX
+#include <cstdint> // std::uint32_t, std::uint64_t
+
+#include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#include <sys/syscall.h> // SYS_futex
+#include <time.h>        // timespec
+#include <unistd.h>      // syscall
+
+/// @brief Sleeps while the 32 bit word at the address holds the expected value, but at most for the timeout if one is
+/// given. May return spuriously.
+inline void futexWait(const void *address, std::uint32_t expected, const timespec *timeout = nullptr) noexcept
+{
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+
+/// @brief Wakes up to number_of_threads threads that sleep on the 32 bit word at the address.
+inline void futexWake(const void *address, int number_of_threads) noexcept
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, number_of_threads, nullptr, nullptr, 0);
+}
+
+/// @brief EventCount lets threads sleep until a condition, such as "a queue is not empty", may have become true,
+/// without a mutex on the side of the threads that make it true. A waiter announces itself with prepareWait(), checks
+/// the condition once more, and then either calls cancelWait() or sleeps in commitWait(). A notifier first makes the
+/// condition true and then calls notifyOne(). Waiters and pending signals are counted, so notifyOne() costs only a
+/// fence and a load while every waiter has already been signalled, and otherwise signals exactly one waiter and wakes
+/// one sleeper with a futex. A notification between prepareWait() and commitWait() is never lost, because the waiter
+/// finds the pending signal instead of sleeping.
+class EventCount
+{
+    // The state packs the number of announced waiters, the number of signals that no waiter has consumed yet, and an
+    // epoch that changes with every signal and that the sleepers wait on
+    static constexpr std::uint64_t waiter = 1;
+    static constexpr std::uint64_t signal = std::uint64_t{1} << 16;
+    static constexpr std::uint64_t epoch = std::uint64_t{1} << 32;
+    static constexpr std::uint64_t count_mask = 0xFFFF;
+
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The futex is the upper half of the state");
+
+  public:
+    /// @brief Announces the calling thread as a waiter. The caller must check its condition again afterwards.
+    void prepareWait() noexcept
+    {
+        state_.fetch_add(waiter, std::memory_order_seq_cst);
+    }
+
+    /// @brief Withdraws the announcement of prepareWait() because the condition became true, together with a signal
+    /// if every waiter has been signalled.
+    void cancelWait() noexcept
+    {
+        std::uint64_t state = state_.load(std::memory_order_relaxed);
+        std::uint64_t next = 0;
+        do
+        {
+            next = state - waiter;
+            if (signals(state) == waiters(state))
+            {
+                next -= signal;
+            }
+        } while (!state_.compare_exchange_weak(state, next, std::memory_order_seq_cst, std::memory_order_relaxed));
+    }
+
+    /// @brief Sleeps until there is a signal for the calling thread and consumes it.
+    void commitWait() noexcept
+    {
+        std::uint64_t state = state_.load(std::memory_order_acquire);
+        while (true)
+        {
+            if (signals(state) > 0)
+            {
+                if (state_.compare_exchange_weak(state, state - waiter - signal, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire))
+                {
+                    return;
+                }
+                continue;
+            }
+            futexWait(epochAddress(), static_cast<std::uint32_t>(state >> 32));
+            state = state_.load(std::memory_order_acquire);
+        }
+    }
+
+    /// @brief Signals one waiter and wakes it, unless every waiter has been signalled already.
+    void notifyOne() noexcept
+    {
+        // Orders the caller's update of the condition before the load of the state, pairing with prepareWait()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t state = state_.load(std::memory_order_relaxed);
+        do
+        {
+            if (signals(state) == waiters(state))
+            {
+                return;
+            }
+        } while (!state_.compare_exchange_weak(state, state + signal + epoch, std::memory_order_seq_cst,
+                                               std::memory_order_relaxed));
+        futexWake(epochAddress(), 1);
+    }
+
+    /// @brief Signals and wakes all waiters.
+    void notifyAll() noexcept
+    {
+        std::uint64_t state = state_.load(std::memory_order_relaxed);
+        std::uint64_t next = 0;
+        do
+        {
+            next = ((state & ~(count_mask * signal)) | waiters(state) * signal) + epoch;
+        } while (!state_.compare_exchange_weak(state, next, std::memory_order_seq_cst, std::memory_order_relaxed));
+        futexWake(epochAddress(), INT_MAX);
+    }
+
+  private:
+    static std::uint64_t waiters(std::uint64_t state) noexcept
+    {
+        return state & count_mask;
+    }
+
+    static std::uint64_t signals(std::uint64_t state) noexcept
+    {
+        return (state >> 16) & count_mask;
+    }
+
+    /// @brief Returns the address of the epoch, the upper 32 bits of the state, which the sleepers wait on.
+    const void *epochAddress() const noexcept
+    {
+        return reinterpret_cast<const std::uint32_t *>(&state_) + 1;
+    }
+
+    std::atomic<std::uint64_t> state_{0};
+};
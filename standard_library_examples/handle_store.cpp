@@ -0,0 +1,222 @@
+#include "handle_store.hpp"
+
+#include <algorithm> // std::max, std::shuffle
+#include <chrono>    // std::chrono::high_resolution_clock
+#include <cstdint>   // std::int64_t, std::size_t, std::uint32_t, std::uint64_t
+#include <fstream>   // std::ifstream
+#include <iostream>  // std::cout
+#include <random>    // std::mt19937
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+#include <unistd.h> // sysconf
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t peak_records = 1'000'000;
+constexpr std::size_t number_of_rounds = 8;
+constexpr std::size_t moves_per_step = 4096;
+
+/// @brief Long-lived record of 64 bytes, such as a node of a scene graph or an entry of a session table.
+struct Record
+{
+    double x, y, width, height;
+    std::uint32_t children[4];
+    std::uint64_t payload[2];
+};
+
+/// @brief Returns the resident set size of the process in KiB, or -1 if it cannot be read.
+std::int64_t residentSetKib()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::int64_t size_pages = 0;
+    std::int64_t resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages))
+    {
+        return -1;
+    }
+    return resident_pages * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/// @brief Returns a record whose fields are derived from the sequence number.
+Record makeRecord(const std::size_t sequence_no)
+{
+    const auto value = static_cast<double>(sequence_no);
+    const auto index = static_cast<std::uint32_t>(sequence_no);
+    return {value, value, 1.0, 1.0, {index, index + 1, index + 2, index + 3}, {sequence_no, sequence_no}};
+}
+
+/// @brief Check: alternates single compaction steps with new objects, which must not land in the block that is being
+/// emptied, and verifies that every handle still refers to its own record afterwards.
+bool testCompactionWithEmplace()
+{
+    HandleStore<Record> store;
+    std::vector<StoreHandle> handles;
+    std::vector<std::size_t> sequence_nos;
+    std::size_t sequence_no = 0;
+    for (; sequence_no < 4 * HandleStore<Record>::slots_per_block; ++sequence_no)
+    {
+        handles.push_back(store.emplace(makeRecord(sequence_no)));
+        sequence_nos.push_back(sequence_no);
+    }
+    for (std::size_t i = 0; i < handles.size(); i += 4)
+    {
+        store.erase(handles[i]);
+        store.erase(handles[i + 1]);
+        store.erase(handles[i + 2]);
+    }
+    for (std::size_t step = 0; step < 4 * HandleStore<Record>::slots_per_block; ++step, ++sequence_no)
+    {
+        store.compact(1);
+        handles.push_back(store.emplace(makeRecord(sequence_no)));
+        sequence_nos.push_back(sequence_no);
+    }
+    for (std::size_t i = 0; i < handles.size(); ++i)
+    {
+        const Record *record = store.get(handles[i]);
+        if (record != nullptr && record->payload[0] != sequence_nos[i])
+        {
+            return false;
+        }
+    }
+    return store.size() == handles.size() - 3 * HandleStore<Record>::slots_per_block;
+}
+
+/// @brief Check: a default constructed handle is null, also once the first table entry holds an object, and even
+/// after the generation of that entry has wrapped around.
+bool testNullHandle()
+{
+    HandleStore<Record> store;
+    for (std::size_t round_no = 0; round_no < 256; ++round_no)
+    {
+        const StoreHandle handle = store.emplace(makeRecord(round_no));
+        if (store.get(StoreHandle{}) != nullptr || store.contains(StoreHandle{}) || handle == StoreHandle{})
+        {
+            return false;
+        }
+        store.erase(handle);
+    }
+    const StoreHandle handle = store.emplace(makeRecord(0));
+    store.erase(StoreHandle{});
+    return store.get(StoreHandle{}) == nullptr && store.contains(handle);
+}
+
+/// @brief Fills the store up to peak_records, then erases a random half of the live records in every round and
+/// creates a tenth as many new ones, so that the survivors end up scattered over the memory of the peak. Calls idle
+/// after every round, and prints the growth of the resident set over the start of the run after every round.
+/// @param create Creates a record and returns its handle.
+/// @param destroy Destroys the record of a handle.
+/// @param idle Runs in the idle period after every round.
+/// @return Handles of the records that are still alive.
+template <typename Handle, typename Create, typename Destroy, typename Idle>
+std::vector<Handle> runFragmentationStress(const std::string &name, Create create, Destroy destroy, Idle idle)
+{
+    std::mt19937 generator(42);
+    std::vector<Handle> live;
+    live.reserve(peak_records);
+    std::size_t sequence_no = 0;
+    const std::int64_t baseline_kib = residentSetKib();
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    while (live.size() < peak_records)
+    {
+        live.push_back(create(sequence_no++));
+    }
+    std::cout << name << ", peak: " << live.size() << " records, RSS growth "
+              << (residentSetKib() - baseline_kib) / 1024 << " MiB" << std::endl;
+
+    for (std::size_t round_no = 1; round_no <= number_of_rounds; ++round_no)
+    {
+        std::shuffle(live.begin(), live.end(), generator);
+        const std::size_t number_to_erase = live.size() / 2;
+        for (std::size_t i = 0; i < number_to_erase; ++i)
+        {
+            destroy(live.back());
+            live.pop_back();
+        }
+        for (std::size_t i = 0; i < number_to_erase / 10; ++i)
+        {
+            live.push_back(create(sequence_no++));
+        }
+        idle();
+        std::cout << name << ", round " << round_no << ": " << live.size() << " records, RSS growth "
+                  << (residentSetKib() - baseline_kib) / 1024 << " MiB" << std::endl;
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (" << name << "): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    return live;
+}
+
+/// @brief Runs the fragmentation stress on a HandleStore, compacting it in every idle period if requested.
+void benchmarkHandleStore(const bool compact)
+{
+    HandleStore<Record> store;
+    double longest_step = 0.0;
+    std::size_t number_of_moves = 0;
+    const auto idle = [&] {
+        if (!compact)
+        {
+            return;
+        }
+        std::size_t moves = 0;
+        do
+        {
+            const auto start_time = std::chrono::high_resolution_clock::now();
+            moves = store.compact(moves_per_step);
+            const auto stop_time = std::chrono::high_resolution_clock::now();
+            longest_step = std::max(longest_step, (stop_time - start_time).count() / 1e9);
+            number_of_moves += moves;
+        } while (moves > 0);
+    };
+
+    const std::string name = compact ? "HandleStore with compaction" : "HandleStore without compaction";
+    const std::vector<StoreHandle> live = runFragmentationStress<StoreHandle>(
+        name, [&](std::size_t sequence_no) { return store.emplace(makeRecord(sequence_no)); },
+        [&](StoreHandle handle) { store.erase(handle); }, idle);
+    std::cout << "Blocks: " << store.numberOfBlocks() << ", occupancy: " << store.occupancy()
+              << ", moved records: " << number_of_moves << ", longest compaction step: " << longest_step << std::endl;
+}
+
+/// @brief Runs the fragmentation stress with every record allocated by new.
+void benchmarkNewDelete()
+{
+    std::uint64_t checksum = 0;
+    const std::vector<Record *> live = runFragmentationStress<Record *>(
+        "new/delete", [](std::size_t sequence_no) { return new Record(makeRecord(sequence_no)); },
+        [&](Record *record) {
+            checksum += record->payload[0];
+            delete record;
+        },
+        [] {});
+    for (Record *record : live)
+    {
+        delete record;
+    }
+    doNotOptimize(checksum);
+}
+
+int main()
+{
+    if (!testCompactionWithEmplace())
+    {
+        std::cout << "HandleStore lost records while compacting" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!testNullHandle())
+    {
+        std::cout << "HandleStore resolved a null handle" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The HandleStore runs come first, because the heap keeps the memory of the new/delete run
+    benchmarkHandleStore(false);
+    benchmarkHandleStore(true);
+    benchmarkNewDelete();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <cstddef>     // std::byte
+#include <cstdint>     // std::size_t, std::uint8_t, std::uint32_t
+#include <new>         // std::bad_alloc, ::new
+#include <stdexcept>   // std::length_error, std::out_of_range
+#include <type_traits> // std::is_nothrow_move_constructible_v
+#include <utility>     // std::forward, std::move
+#include <vector>      // std::vector
+
+#include <sys/mman.h> // mmap, munmap
+
+/// @brief Stable reference to an object of a HandleStore: a 24 bit index into the store's handle table and an 8 bit
+/// generation, which tells a handle to an erased object from a handle to the object that reuses its table entry.
+/// Generations start at 1 and skip 0 when they wrap, so a default constructed handle is null and never refers to an
+/// object.
+struct StoreHandle
+{
+    std::uint32_t value = 0;
+
+    friend bool operator==(StoreHandle lhs, StoreHandle rhs) noexcept
+    {
+        return lhs.value == rhs.value;
+    }
+
+    friend bool operator!=(StoreHandle lhs, StoreHandle rhs) noexcept
+    {
+        return lhs.value != rhs.value;
+    }
+};
+
+/// @brief Size of a HandleStore block, which is mapped and unmapped as a whole.
+inline constexpr std::size_t handle_store_block_bytes = 64 * 1024;
+
+/// @brief HandleStore keeps objects of type T in fixed-size blocks that are mapped directly from the operating system,
+/// and hands out 32 bit handles instead of pointers. Because every access goes through the handle table, objects can
+/// be relocated: compact() moves the objects of the sparsest block into the holes of the other blocks, a bounded
+/// number of objects per call, so that it can run in idle periods. A block whose last object is erased or moved away
+/// is unmapped at once, so the resident memory follows the number of live objects instead of their peak, which a
+/// long-running process with a fragmented malloc heap cannot achieve. New objects fill the lowest non-full block
+/// first, which keeps the live objects packed towards the front. Pointers returned by get() are only valid until the
+/// next call of compact().
+/// @tparam T Type of the stored objects, which must be nothrow move constructible to be relocated
+template <typename T> class HandleStore final
+{
+    static_assert(std::is_nothrow_move_constructible_v<T>, "HandleStore relocates objects by moving them");
+
+    /// @brief Storage of one object, and the table entry that refers to it, or no_entry if the slot is free.
+    struct Slot
+    {
+        union {
+            alignas(T) std::byte storage[sizeof(T)];
+            std::uint32_t next_free;
+        };
+        std::uint32_t entry;
+
+        T &object() noexcept
+        {
+            return *std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    /// @brief Bookkeeping of one block. A released block keeps its index with slots set to nullptr.
+    struct Block
+    {
+        Slot *slots = nullptr;
+        std::uint32_t live = 0;
+        std::uint32_t carved = 0;
+        std::uint32_t free_head = no_entry;
+    };
+
+    /// @brief Entry of the handle table: the location of a live object, or the link to the next free entry.
+    struct Entry
+    {
+        std::uint32_t block;
+        std::uint32_t slot;
+        std::uint8_t generation;
+        bool live;
+    };
+
+  public:
+    /// @brief Number of objects per block.
+    static constexpr std::size_t slots_per_block = handle_store_block_bytes / sizeof(Slot);
+
+    /// @brief Largest number of handle table entries, limited by the 24 bit index of a handle.
+    static constexpr std::size_t max_entries = std::size_t{1} << 24;
+
+    HandleStore() = default;
+
+    HandleStore(const HandleStore &) = delete;
+    HandleStore &operator=(const HandleStore &) = delete;
+
+    /// @brief Destructor of the HandleStore class, destroys the live objects and unmaps all blocks.
+    ~HandleStore()
+    {
+        for (const Entry &entry : entries_)
+        {
+            if (entry.live)
+            {
+                blocks_[entry.block].slots[entry.slot].object().~T();
+            }
+        }
+        for (const Block &block : blocks_)
+        {
+            if (block.slots != nullptr)
+            {
+                munmap(block.slots, handle_store_block_bytes);
+            }
+        }
+    }
+
+    /// @brief Creates an object in the store and returns its handle.
+    /// @param args Arguments forwarded to the constructor of T.
+    template <typename... Args> StoreHandle emplace(Args &&...args)
+    {
+        const std::uint32_t entry_index = takeEntry();
+        const std::uint32_t block_index = nonFullBlock();
+        Block &block = blocks_[block_index];
+        const std::uint32_t slot_index = (block.free_head != no_entry) ? block.free_head : block.carved;
+        Slot &slot = block.slots[slot_index];
+        const std::uint32_t next_free = (block.free_head != no_entry) ? slot.next_free : no_entry;
+        try
+        {
+            ::new (slot.storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            entries_[entry_index].slot = free_entry_;
+            free_entry_ = entry_index;
+            if (block.live == 0)
+            {
+                releaseBlock(block_index);
+            }
+            throw;
+        }
+
+        if (slot_index == block.carved)
+        {
+            ++block.carved;
+        }
+        else
+        {
+            block.free_head = next_free;
+        }
+        slot.entry = entry_index;
+        if (++block.live == slots_per_block)
+        {
+            setNonFull(block_index, false);
+        }
+
+        Entry &entry = entries_[entry_index];
+        entry.block = block_index;
+        entry.slot = slot_index;
+        entry.live = true;
+        ++size_;
+        return {entry_index << 8 | entry.generation};
+    }
+
+    /// @brief Destroys the object of the handle. Unmaps its block if it was the block's last object. Erasing through
+    /// a stale handle does nothing.
+    void erase(StoreHandle handle) noexcept
+    {
+        if (!contains(handle))
+        {
+            return;
+        }
+        const std::uint32_t entry_index = handle.value >> 8;
+        Entry &entry = entries_[entry_index];
+        freeSlot(entry.block, entry.slot);
+        entry.live = false;
+        if (++entry.generation == 0)
+        {
+            entry.generation = 1;
+        }
+        entry.slot = free_entry_;
+        free_entry_ = entry_index;
+        --size_;
+    }
+
+    /// @brief Returns whether the handle refers to a live object.
+    bool contains(StoreHandle handle) const noexcept
+    {
+        const std::uint32_t entry_index = handle.value >> 8;
+        return entry_index < entries_.size() && entries_[entry_index].live &&
+               entries_[entry_index].generation == static_cast<std::uint8_t>(handle.value);
+    }
+
+    /// @brief Returns the object of the handle, or nullptr if the handle is stale. The pointer is invalidated by
+    /// compact().
+    T *get(StoreHandle handle) noexcept
+    {
+        if (!contains(handle))
+        {
+            return nullptr;
+        }
+        const Entry &entry = entries_[handle.value >> 8];
+        return &blocks_[entry.block].slots[entry.slot].object();
+    }
+
+    /// @brief Returns the object of the handle.
+    /// @throws std::out_of_range if the handle is stale.
+    T &at(StoreHandle handle)
+    {
+        T *object = get(handle);
+        if (object == nullptr)
+        {
+            throw std::out_of_range("Stale handle");
+        }
+        return *object;
+    }
+
+    /// @brief Returns the number of live objects.
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /// @brief Returns the number of mapped blocks.
+    std::size_t numberOfBlocks() const noexcept
+    {
+        return blocks_.size() - released_blocks_.size();
+    }
+
+    /// @brief Returns the fraction of the slots of the mapped blocks that hold live objects.
+    double occupancy() const noexcept
+    {
+        const std::size_t number_of_blocks = numberOfBlocks();
+        return (number_of_blocks == 0) ? 1.0 : static_cast<double>(size_) / (number_of_blocks * slots_per_block);
+    }
+
+    /// @brief Relocates up to max_moves objects from the sparsest block into the holes of the other blocks, and
+    /// unmaps the block once it is empty. Does nothing while the live objects would not fit into one block less.
+    /// @param max_moves Largest number of objects to move in this step.
+    /// @return Number of objects that were moved, 0 once the store is compact.
+    std::size_t compact(std::size_t max_moves)
+    {
+        std::size_t moves = 0;
+        while (moves < max_moves)
+        {
+            if (size_ + slots_per_block > numberOfBlocks() * slots_per_block)
+            {
+                break;
+            }
+            if (compaction_source_ == no_entry)
+            {
+                compaction_source_ = sparsestBlock();
+                compaction_cursor_ = 0;
+            }
+
+            // Move the source's objects in slot order, resuming where the previous step stopped. New objects do not
+            // go into the source, so it is empty once the cursor has passed its carved slots.
+            const std::uint32_t source_index = compaction_source_;
+            while (moves < max_moves && compaction_source_ == source_index)
+            {
+                if (compaction_cursor_ >= blocks_[source_index].carved)
+                {
+                    compaction_source_ = no_entry;
+                    break;
+                }
+                Slot &slot = blocks_[source_index].slots[compaction_cursor_++];
+                if (slot.entry != no_entry)
+                {
+                    relocate(source_index, compaction_cursor_ - 1);
+                    ++moves;
+                }
+            }
+        }
+        return moves;
+    }
+
+  private:
+    /// @brief Marker of a free slot and end of the free lists.
+    static constexpr std::uint32_t no_entry = ~std::uint32_t{0};
+
+    /// @brief Returns a free handle table entry, growing the table if there is none.
+    std::uint32_t takeEntry()
+    {
+        if (free_entry_ != no_entry)
+        {
+            const std::uint32_t entry_index = free_entry_;
+            free_entry_ = entries_[entry_index].slot;
+            return entry_index;
+        }
+        if (entries_.size() == max_entries)
+        {
+            throw std::length_error("HandleStore is full");
+        }
+        entries_.push_back({0, 0, 1, false});
+        return static_cast<std::uint32_t>(entries_.size() - 1);
+    }
+
+    /// @brief Returns the lowest block with a free slot other than the compaction source, which would otherwise be
+    /// refilled behind the compaction cursor. Gives up the compaction if only the source has a free slot, and maps a
+    /// new block if all blocks are full.
+    std::uint32_t nonFullBlock()
+    {
+        const std::uint32_t lowest = lowestNonFullBlock(compaction_source_);
+        if (lowest != no_entry)
+        {
+            return lowest;
+        }
+        if (compaction_source_ != no_entry && blocks_[compaction_source_].live < slots_per_block)
+        {
+            const std::uint32_t source_index = compaction_source_;
+            compaction_source_ = no_entry;
+            return source_index;
+        }
+
+        void *memory = mmap(nullptr, handle_store_block_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                            0);
+        if (memory == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        std::uint32_t block_index = 0;
+        if (released_blocks_.empty())
+        {
+            try
+            {
+                released_blocks_.reserve(blocks_.size() + 1);
+                non_full_blocks_.resize(blocks_.size() / 64 + 1);
+                blocks_.emplace_back();
+            }
+            catch (...)
+            {
+                munmap(memory, handle_store_block_bytes);
+                throw;
+            }
+            block_index = static_cast<std::uint32_t>(blocks_.size() - 1);
+        }
+        else
+        {
+            block_index = released_blocks_.back();
+            released_blocks_.pop_back();
+        }
+        blocks_[block_index] = {static_cast<Slot *>(memory), 0, 0, no_entry};
+        setNonFull(block_index, true);
+        return block_index;
+    }
+
+    /// @brief Destroys the object in the slot and returns the slot to its block, unmapping the block if it is empty.
+    void freeSlot(std::uint32_t block_index, std::uint32_t slot_index) noexcept
+    {
+        Block &block = blocks_[block_index];
+        Slot &slot = block.slots[slot_index];
+        slot.object().~T();
+        slot.entry = no_entry;
+        slot.next_free = block.free_head;
+        block.free_head = slot_index;
+
+        if (--block.live == 0)
+        {
+            releaseBlock(block_index);
+        }
+        else if (block.live == slots_per_block - 1)
+        {
+            setNonFull(block_index, true);
+        }
+    }
+
+    /// @brief Unmaps an empty block. Never allocates, because the list of released blocks has room for every block.
+    void releaseBlock(std::uint32_t block_index) noexcept
+    {
+        munmap(blocks_[block_index].slots, handle_store_block_bytes);
+        blocks_[block_index] = Block{};
+        setNonFull(block_index, false);
+        released_blocks_.push_back(block_index);
+        if (compaction_source_ == block_index)
+        {
+            compaction_source_ = no_entry;
+        }
+    }
+
+    /// @brief Sets or clears the bit of the block in the bitmap of blocks with a free slot.
+    void setNonFull(std::uint32_t block_index, bool non_full) noexcept
+    {
+        const std::uint64_t bit = std::uint64_t{1} << (block_index % 64);
+        if (non_full)
+        {
+            non_full_blocks_[block_index / 64] |= bit;
+        }
+        else
+        {
+            non_full_blocks_[block_index / 64] &= ~bit;
+        }
+    }
+
+    /// @brief Returns the lowest block with a free slot other than the excluded block, or no_entry if there is none.
+    std::uint32_t lowestNonFullBlock(std::uint32_t excluded) const noexcept
+    {
+        for (std::size_t word_index = 0; word_index < non_full_blocks_.size(); ++word_index)
+        {
+            std::uint64_t word = non_full_blocks_[word_index];
+            if (excluded / 64 == word_index)
+            {
+                word &= ~(std::uint64_t{1} << (excluded % 64));
+            }
+            if (word != 0)
+            {
+                return static_cast<std::uint32_t>(word_index * 64 + __builtin_ctzll(word));
+            }
+        }
+        return no_entry;
+    }
+
+    /// @brief Returns the mapped block with the fewest live objects.
+    std::uint32_t sparsestBlock() const noexcept
+    {
+        std::uint32_t sparsest = no_entry;
+        for (std::uint32_t block_index = 0; block_index < blocks_.size(); ++block_index)
+        {
+            const Block &block = blocks_[block_index];
+            if (block.slots != nullptr && (sparsest == no_entry || block.live < blocks_[sparsest].live))
+            {
+                sparsest = block_index;
+            }
+        }
+        return sparsest;
+    }
+
+    /// @brief Moves the object in the slot of the compaction source to the lowest other block with a free slot and
+    /// points its handle table entry to the new location.
+    void relocate(std::uint32_t source_index, std::uint32_t slot_index)
+    {
+        const std::uint32_t target_index = lowestNonFullBlock(source_index);
+        Block &target_block = blocks_[target_index];
+        const std::uint32_t target_slot_index =
+            (target_block.free_head != no_entry) ? target_block.free_head : target_block.carved;
+        Slot &target_slot = target_block.slots[target_slot_index];
+        if (target_slot_index == target_block.carved)
+        {
+            ++target_block.carved;
+        }
+        else
+        {
+            target_block.free_head = target_slot.next_free;
+        }
+
+        Slot &source_slot = blocks_[source_index].slots[slot_index];
+        const std::uint32_t entry_index = source_slot.entry;
+        ::new (target_slot.storage) T(std::move(source_slot.object()));
+        target_slot.entry = entry_index;
+        if (++target_block.live == slots_per_block)
+        {
+            setNonFull(target_index, false);
+        }
+        entries_[entry_index].block = target_index;
+        entries_[entry_index].slot = target_slot_index;
+        freeSlot(source_index, slot_index);
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<Block> blocks_;
+    std::vector<std::uint32_t> released_blocks_;
+    std::vector<std::uint64_t> non_full_blocks_;
+    std::uint32_t free_entry_ = no_entry;
+    std::uint32_t compaction_source_ = no_entry;
+    std::uint32_t compaction_cursor_ = 0;
+    std::size_t size_ = 0;
+};
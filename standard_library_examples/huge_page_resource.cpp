@@ -0,0 +1,127 @@
+#include "huge_page_resource.hpp"
+
+#include <algorithm>       // std::min
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <iostream>        // std::cout
+#include <limits>          // std::numeric_limits
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::new_delete_resource
+#include <string>          // std::string
+#include <vector>          // std::pmr::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t array_size = 16 * 1024 * 1024;
+constexpr std::size_t number_of_repetitions = 10;
+
+/// @brief Bandwidth of the four STREAM kernels, in GB/s.
+struct StreamResult
+{
+    double copy = 0.0;
+    double scale = 0.0;
+    double add = 0.0;
+    double triad = 0.0;
+};
+
+/// @brief Runs the kernel number_of_repetitions times and returns the bandwidth of the fastest run.
+template <typename Kernel> double measureBandwidth(const std::size_t bytes_per_run, Kernel kernel)
+{
+    double best_time = std::numeric_limits<double>::max();
+    for (std::size_t repetition = 0; repetition < number_of_repetitions; ++repetition)
+    {
+        const auto start_time = std::chrono::high_resolution_clock::now();
+        kernel();
+        const auto stop_time = std::chrono::high_resolution_clock::now();
+        best_time = std::min(best_time, (stop_time - start_time).count() / 1e9);
+    }
+    return bytes_per_run / best_time / 1e9;
+}
+
+/// @brief Runs the STREAM copy, scale, add and triad kernels over three arrays allocated from the resource. The
+/// arrays are much larger than the caches, so the kernels are bound by memory bandwidth and by TLB misses, which
+/// huge pages reduce.
+StreamResult runStream(std::pmr::memory_resource *resource, const std::string &name)
+{
+    // Constructing with a value touches every page, so the kernels do not measure page faults
+    std::pmr::vector<double> a(array_size, 1.0, resource);
+    std::pmr::vector<double> b(array_size, 2.0, resource);
+    std::pmr::vector<double> c(array_size, 0.0, resource);
+    constexpr double scalar = 3.0;
+
+    if (auto *huge_page_resource = dynamic_cast<HugePageResource *>(resource))
+    {
+        const auto mapping = huge_page_resource->mappingInfo(a.data());
+        std::cout << name << ": " << pageKindName(mapping ? mapping->kind : PageKind::Upstream) << ", "
+                  << huge_page_resource->hugePageBytes(a.data()) / (1024 * 1024) << " of "
+                  << array_size * sizeof(double) / (1024 * 1024) << " MiB backed by huge pages, NUMA policy "
+                  << (mapping && mapping->numa_policy_applied ? "applied" : "not applied") << std::endl;
+    }
+
+    StreamResult result;
+    result.copy = measureBandwidth(2 * sizeof(double) * array_size, [&] {
+        for (std::size_t i = 0; i < array_size; ++i)
+        {
+            c[i] = a[i];
+        }
+        doNotOptimize(c);
+    });
+    result.scale = measureBandwidth(2 * sizeof(double) * array_size, [&] {
+        for (std::size_t i = 0; i < array_size; ++i)
+        {
+            b[i] = scalar * c[i];
+        }
+        doNotOptimize(b);
+    });
+    result.add = measureBandwidth(3 * sizeof(double) * array_size, [&] {
+        for (std::size_t i = 0; i < array_size; ++i)
+        {
+            c[i] = a[i] + b[i];
+        }
+        doNotOptimize(c);
+    });
+    result.triad = measureBandwidth(3 * sizeof(double) * array_size, [&] {
+        for (std::size_t i = 0; i < array_size; ++i)
+        {
+            a[i] = b[i] + scalar * c[i];
+        }
+        doNotOptimize(a);
+    });
+    return result;
+}
+
+/// @brief Prints the bandwidth of the four kernels.
+void printStream(const std::string &name, const StreamResult &result)
+{
+    std::cout << "Bandwidth in GB/s (" << name << "): copy " << result.copy << ", scale " << result.scale << ", add "
+              << result.add << ", triad " << result.triad << std::endl;
+}
+
+int main()
+{
+    {
+        // Small allocations are not worth a mapping of their own and go to the upstream resource
+        HugePageResource resource;
+        std::pmr::vector<int> small(16, 0, &resource);
+        std::pmr::vector<char> large(3 * 1024 * 1024, 'x', &resource);
+        std::cout << "16 ints: " << (resource.mappingInfo(small.data()) ? "mapped" : "upstream") << std::endl;
+        std::cout << "3 MiB: mapping of " << resource.mappingInfo(large.data())->size / (1024 * 1024) << " MiB"
+                  << std::endl;
+    }
+
+    printStream("default heap", runStream(std::pmr::new_delete_resource(), "default heap"));
+
+    HugePageResource huge_page_resource;
+    printStream("HugePageResource", runStream(&huge_page_resource, "HugePageResource"));
+
+    // Interleaving spreads the arrays over the memory controllers of all nodes. Node 0 exists on every machine, list
+    // all nodes of /sys/devices/system/node on a multi-socket machine.
+    HugePageResource interleaved_resource(NumaPolicy::Interleave, {0});
+    printStream("HugePageResource interleaved",
+                runStream(&interleaved_resource, "HugePageResource interleaved"));
+
+    return EXIT_SUCCESS;
+}
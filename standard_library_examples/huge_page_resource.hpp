@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cerrno>          // errno, EINVAL
+#include <cstdint>         // std::size_t, std::uintptr_t
+#include <fstream>         // std::ifstream
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::get_default_resource
+#include <mutex>           // std::mutex, std::lock_guard
+#include <new>             // std::bad_alloc
+#include <optional>        // std::optional
+#include <sstream>         // std::istringstream
+#include <string>          // std::string
+#include <unordered_map>   // std::unordered_map
+#include <utility>         // std::move
+#include <vector>          // std::vector
+
+#include <sys/mman.h>    // mmap, munmap, madvise
+#include <sys/syscall.h> // SYS_mbind
+#include <unistd.h>      // syscall
+
+/// @brief How the pages of a mapping are placed on the NUMA nodes.
+enum class NumaPolicy
+{
+    /// @brief Leave placement to the kernel, which puts pages on the node of the thread that first touches them.
+    Default,
+    /// @brief Put pages on the given nodes, falling back to any other node if they are full. Preferring several
+    /// nodes needs MPOL_PREFERRED_MANY of Linux 5.15; older kernels only prefer the lowest given node.
+    Preferred,
+    /// @brief Only put pages on the given nodes.
+    Bind,
+    /// @brief Spread pages round robin over the given nodes, for buffers that all nodes stream through.
+    Interleave,
+};
+
+/// @brief Kind of pages that back an allocation of a HugePageResource.
+enum class PageKind
+{
+    /// @brief The allocation was smaller than the mapping threshold and came from the upstream resource.
+    Upstream,
+    /// @brief Explicit huge pages from the reserved hugetlbfs pool (vm.nr_hugepages).
+    HugeTlb,
+    /// @brief A mapping advised for transparent huge pages, which the kernel backs with huge pages where it can.
+    TransparentHuge,
+    /// @brief A mapping with normal pages, because transparent huge pages are unavailable.
+    Normal,
+};
+
+/// @brief Returns the name of a page kind.
+inline const char *pageKindName(PageKind kind) noexcept
+{
+    switch (kind)
+    {
+    case PageKind::Upstream:
+        return "upstream";
+    case PageKind::HugeTlb:
+        return "hugetlb";
+    case PageKind::TransparentHuge:
+        return "transparent huge pages";
+    case PageKind::Normal:
+        return "normal pages";
+    }
+    return "unknown";
+}
+
+/// @brief HugePageResource serves large allocations with their own anonymous mappings, aligned to and sized in
+/// multiples of the 2 MiB huge page size, so that one TLB entry covers 2 MiB instead of 4 KiB. It first tries the
+/// explicitly reserved hugetlbfs pool, then a normal mapping advised with MADV_HUGEPAGE, and keeps normal pages if
+/// neither is available. Before the pages are touched, the mapping is bound to or interleaved across NUMA nodes
+/// according to the policy. Allocations below the threshold are forwarded to the upstream resource. Linux only.
+class HugePageResource final : public std::pmr::memory_resource
+{
+  public:
+    /// @brief Size of a huge page on x86-64 and the granularity of the mappings.
+    static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    /// @brief Description of one mapping made by the resource.
+    struct MappingInfo
+    {
+        std::size_t size;
+        PageKind kind;
+        bool numa_policy_applied;
+    };
+
+    /// @brief Constructor of the HugePageResource class.
+    /// @param policy Placement of the pages on the NUMA nodes.
+    /// @param nodes NUMA nodes the policy refers to, ignored for NumaPolicy::Default.
+    /// @param threshold Smallest allocation, in bytes, that gets its own mapping.
+    /// @param upstream Resource that serves the allocations below the threshold.
+    explicit HugePageResource(NumaPolicy policy = NumaPolicy::Default, std::vector<int> nodes = {},
+                              std::size_t threshold = huge_page_size,
+                              std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : policy_(policy), nodes_(std::move(nodes)), threshold_(threshold), upstream_(upstream)
+    {
+    }
+
+    HugePageResource(const HugePageResource &) = delete;
+    HugePageResource &operator=(const HugePageResource &) = delete;
+
+    /// @brief Destructor of the HugePageResource class, unmaps the mappings that were not deallocated.
+    ~HugePageResource() override
+    {
+        for (const auto &[address, mapping] : mappings_)
+        {
+            munmap(reinterpret_cast<void *>(address), mapping.size);
+        }
+    }
+
+    /// @brief Returns how the allocation is backed, or std::nullopt if it is not a mapping of this resource.
+    /// @param pointer Pointer returned by allocate.
+    std::optional<MappingInfo> mappingInfo(const void *pointer) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto mapping = mappings_.find(reinterpret_cast<std::uintptr_t>(pointer));
+        if (mapping == mappings_.end())
+        {
+            return std::nullopt;
+        }
+        return mapping->second;
+    }
+
+    /// @brief Returns how many bytes of the allocation the kernel currently backs with huge pages, as reported in
+    /// /proc/self/smaps. Transparent huge pages are only assigned when the memory is first touched, so this is only
+    /// meaningful after the buffer has been written.
+    /// @param pointer Pointer returned by allocate.
+    std::size_t hugePageBytes(const void *pointer) const
+    {
+        const std::optional<MappingInfo> mapping = mappingInfo(pointer);
+        if (!mapping)
+        {
+            return 0;
+        }
+        if (mapping->kind == PageKind::HugeTlb)
+        {
+            return mapping->size;
+        }
+
+        // Sum the AnonHugePages of all kernel mappings that overlap the allocation
+        const auto begin = reinterpret_cast<std::uintptr_t>(pointer);
+        const auto end = begin + mapping->size;
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        bool overlaps = false;
+        std::size_t huge_page_bytes = 0;
+        while (std::getline(smaps, line))
+        {
+            std::uintptr_t range_begin = 0;
+            std::uintptr_t range_end = 0;
+            char dash = 0;
+            std::istringstream range(line);
+            if (range >> std::hex >> range_begin >> dash >> range_end && dash == '-')
+            {
+                overlaps = range_begin < end && range_end > begin;
+            }
+            else if (overlaps && line.rfind("AnonHugePages:", 0) == 0)
+            {
+                std::istringstream field(line.substr(line.find(':') + 1));
+                std::size_t kilobytes = 0;
+                field >> kilobytes;
+                huge_page_bytes += kilobytes * 1024;
+            }
+        }
+        return huge_page_bytes;
+    }
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (bytes < threshold_ || alignment > huge_page_size)
+        {
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        const std::size_t size = (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+        PageKind kind = PageKind::HugeTlb;
+        void *pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pointer == MAP_FAILED)
+        {
+            pointer = mapAligned(size);
+            kind = (madvise(pointer, size, MADV_HUGEPAGE) == 0) ? PageKind::TransparentHuge : PageKind::Normal;
+        }
+        const bool numa_policy_applied = applyNumaPolicy(pointer, size);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        try
+        {
+            mappings_.emplace(reinterpret_cast<std::uintptr_t>(pointer), MappingInfo{size, kind, numa_policy_applied});
+        }
+        catch (...)
+        {
+            munmap(pointer, size);
+            throw;
+        }
+        return pointer;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto mapping = mappings_.find(reinterpret_cast<std::uintptr_t>(p));
+            if (mapping != mappings_.end())
+            {
+                munmap(p, mapping->second.size);
+                mappings_.erase(mapping);
+                return;
+            }
+        }
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    /// @brief Maps size bytes at a huge page aligned address by over-mapping and trimming both ends, so that the
+    /// kernel can back every 2 MiB of the mapping with one huge page.
+    static void *mapAligned(std::size_t size)
+    {
+        const std::size_t padded_size = size + huge_page_size;
+        void *padded = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (padded == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+
+        const auto padded_begin = reinterpret_cast<std::uintptr_t>(padded);
+        const auto begin = (padded_begin + huge_page_size - 1) & ~(huge_page_size - 1);
+        if (begin > padded_begin)
+        {
+            munmap(padded, begin - padded_begin);
+        }
+        const std::size_t tail = padded_begin + padded_size - (begin + size);
+        if (tail > 0)
+        {
+            munmap(reinterpret_cast<void *>(begin + size), tail);
+        }
+        return reinterpret_cast<void *>(begin);
+    }
+
+    /// @brief Sets the NUMA memory policy of the mapping with the mbind system call, which is used directly so that
+    /// libnuma is not needed. Returns whether the policy was applied.
+    bool applyNumaPolicy(void *pointer, std::size_t size) const noexcept
+    {
+        // Memory policy modes of <numaif.h>
+        constexpr int mpol_preferred = 1;
+        constexpr int mpol_bind = 2;
+        constexpr int mpol_interleave = 3;
+        constexpr int mpol_preferred_many = 5;
+        constexpr std::size_t bits_per_word = 8 * sizeof(unsigned long);
+        constexpr std::size_t max_nodes = 1024;
+
+        int mode = 0;
+        switch (policy_)
+        {
+        case NumaPolicy::Default:
+            return true;
+        case NumaPolicy::Preferred:
+            mode = (nodes_.size() > 1) ? mpol_preferred_many : mpol_preferred;
+            break;
+        case NumaPolicy::Bind:
+            mode = mpol_bind;
+            break;
+        case NumaPolicy::Interleave:
+            mode = mpol_interleave;
+            break;
+        }
+
+        unsigned long node_mask[max_nodes / bits_per_word] = {};
+        for (const int node : nodes_)
+        {
+            if (node < 0 || static_cast<std::size_t>(node) >= max_nodes)
+            {
+                return false;
+            }
+            node_mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+        }
+        if (syscall(SYS_mbind, pointer, size, mode, node_mask, max_nodes + 1, 0) == 0)
+        {
+            return true;
+        }
+        // Kernels before 5.15 reject MPOL_PREFERRED_MANY, while MPOL_PREFERRED prefers the lowest node of the mask
+        return mode == mpol_preferred_many && errno == EINVAL &&
+               syscall(SYS_mbind, pointer, size, mpol_preferred, node_mask, max_nodes + 1, 0) == 0;
+    }
+
+    const NumaPolicy policy_;
+    const std::vector<int> nodes_;
+    const std::size_t threshold_;
+    std::pmr::memory_resource *upstream_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::uintptr_t, MappingInfo> mappings_;
+};
@@ -0,0 +1,177 @@
+#include "inplace_function.hpp"
+#include "work_stealing_thread_pool.hpp"
+
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono::high_resolution_clock
+#include <cstdint>    // std::size_t, std::uint64_t
+#include <cstdlib>    // std::malloc, std::free
+#include <functional> // std::function
+#include <iostream>   // std::cout
+#include <memory>     // std::make_shared
+#include <new>        // std::bad_alloc
+#include <string>     // std::string
+#include <thread>     // std::this_thread::yield
+#include <utility>    // std::forward, std::move
+#include <vector>     // std::vector
+
+namespace
+{
+std::atomic<std::size_t> number_of_allocations = 0;
+}
+
+/// @brief Counts every allocation of the program, so that the benchmark can show how many allocations a task costs.
+void *operator new(std::size_t size)
+{
+    number_of_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_tasks = 10'000'000;
+constexpr std::size_t queue_capacity = 1024;
+constexpr std::size_t number_of_pool_tasks = 1'000'000;
+
+/// @brief Bounded FIFO of tasks in a ring buffer whose slots are created once, as a task queue does in steady state,
+/// so that the only allocations left are the ones of the task type itself.
+template <typename Task> class TaskRing
+{
+  public:
+    TaskRing() : tasks_(queue_capacity)
+    {
+    }
+
+    template <typename F> void push(F &&task)
+    {
+        tasks_[tail_++ % queue_capacity] = std::forward<F>(task);
+    }
+
+    Task pop()
+    {
+        return std::move(tasks_[head_++ % queue_capacity]);
+    }
+
+    std::size_t size() const
+    {
+        return tail_ - head_;
+    }
+
+  private:
+    std::vector<Task> tasks_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+};
+
+/// @brief Pushes number_of_tasks tasks made by make_task through a TaskRing of Task, running every popped task, and
+/// prints the elapsed time and the allocations per task.
+template <typename Task, typename MakeTask> void benchmarkTasks(const std::string &name, MakeTask make_task)
+{
+    TaskRing<Task> ring;
+    std::uint64_t sum = 0;
+    const std::size_t allocations_before = number_of_allocations;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t task_no = 0; task_no < number_of_tasks; ++task_no)
+    {
+        ring.push(make_task(sum, task_no));
+        if (ring.size() == queue_capacity / 2)
+        {
+            while (ring.size() > 0)
+            {
+                ring.pop()();
+            }
+        }
+    }
+    while (ring.size() > 0)
+    {
+        ring.pop()();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(sum);
+
+    std::cout << "Elapsed time (" << name << "): " << (stop_time - start_time).count() / 1e9
+              << ", allocations per task: "
+              << static_cast<double>(number_of_allocations - allocations_before) / number_of_tasks << std::endl;
+}
+
+/// @brief Pushes number_of_pool_tasks tasks with 40 byte captures onto the pool, from this thread or from a task on a
+/// worker, waits for all of them, and returns the allocations per task.
+double poolAllocationsPerTask(WorkStealingThreadPool &pool, bool from_worker)
+{
+    std::atomic<std::size_t> completed{0};
+    const auto push_tasks = [&pool, &completed] {
+        for (std::size_t task_no = 0; task_no < number_of_pool_tasks; ++task_no)
+        {
+            pool.pushTask([&completed, a = task_no, b = task_no + 1, c = task_no + 2, d = task_no + 3] {
+                completed.fetch_add((a + b + c + d) > 0 ? 1 : 0, std::memory_order_relaxed);
+            });
+        }
+    };
+    const std::size_t allocations_before = number_of_allocations.load();
+    if (from_worker)
+    {
+        pool.pushTask(push_tasks);
+    }
+    else
+    {
+        push_tasks();
+    }
+    while (completed.load(std::memory_order_relaxed) < number_of_pool_tasks)
+    {
+        std::this_thread::yield();
+    }
+    return static_cast<double>(number_of_allocations.load() - allocations_before) / number_of_pool_tasks;
+}
+
+int main()
+{
+    // 16 bytes of captures: fits into the small buffer of std::function as well
+    const auto small_task = [](std::uint64_t &sum, std::size_t task_no) {
+        return [&sum, task_no] { sum += task_no; };
+    };
+    benchmarkTasks<std::function<void()>>("std::function, 16 byte captures", small_task);
+    benchmarkTasks<InplaceFunction<void()>>("InplaceFunction, 16 byte captures", small_task);
+
+    // 40 bytes of captures, such as a callback with its arguments: std::function allocates
+    const auto large_task = [](std::uint64_t &sum, std::size_t task_no) {
+        return [&sum, a = task_no, b = task_no + 1, c = task_no + 2, d = task_no + 3] { sum += a + b + c + d; };
+    };
+    benchmarkTasks<std::function<void()>>("std::function, 40 byte captures", large_task);
+    benchmarkTasks<InplaceFunction<void()>>("InplaceFunction, 40 byte captures", large_task);
+
+    // A shared_ptr capture is not trivially copyable, so it is moved through the table of operations
+    const auto shared_task = [](std::uint64_t &sum, std::size_t task_no) {
+        return [&sum, counter = std::make_shared<std::size_t>(task_no)] { sum += *counter; };
+    };
+    benchmarkTasks<std::function<void()>>("std::function, shared_ptr capture", shared_task);
+    benchmarkTasks<InplaceFunction<void()>>("InplaceFunction, shared_ptr capture", shared_task);
+
+    // The first round grows the task pool and the queues of the pool to their peak, the second one is steady state
+    WorkStealingThreadPool pool;
+    for (const bool from_worker : {false, true})
+    {
+        const char *name = from_worker ? "from a worker" : "from outside";
+        std::cout << "WorkStealingThreadPool::pushTask " << name << ", allocations per task: first round "
+                  << poolAllocationsPerTask(pool, from_worker) << ", second round "
+                  << poolAllocationsPerTask(pool, from_worker) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>     // std::byte, std::max_align_t, std::nullptr_t
+#include <cstdint>     // std::size_t
+#include <cstring>     // std::memcpy
+#include <functional>  // std::invoke
+#include <new>         // std::launder, ::new
+#include <type_traits> // std::decay_t, std::enable_if_t, std::is_invocable_r_v, std::is_trivially_copyable_v
+#include <utility>     // std::forward, std::move
+
+/// @brief Inline buffer size of an InplaceFunction by default, which makes the whole object one cache line.
+inline constexpr std::size_t inplace_function_default_capacity = 48;
+
+template <typename Signature, std::size_t Capacity = inplace_function_default_capacity> class InplaceFunction;
+
+/// @brief InplaceFunction is a move-only replacement for std::function that always keeps the callable in an inline
+/// buffer of Capacity bytes, so creating, moving and destroying it never allocates. A callable that does not fit into
+/// the buffer is a compile-time error instead of a silent heap allocation. The callable is type-erased through plain
+/// function pointers rather than virtual functions and typeid, so it works without RTTI. Trivially copyable callables,
+/// such as lambdas that capture pointers and numbers, are moved with one memcpy of the buffer and need no destructor
+/// call; other callables are moved and destroyed through a table of operations that is shared by all instances.
+/// Like std::function, operator() is const but calls the stored callable as a non-const object.
+/// @tparam R Return type
+/// @tparam Args Argument types
+/// @tparam Capacity Size of the inline buffer in bytes
+template <typename R, typename... Args, std::size_t Capacity> class InplaceFunction<R(Args...), Capacity> final
+{
+    /// @brief Operations of a callable that is not trivially copyable. Moving must not throw, because tasks are moved
+    /// around in queues.
+    struct Operations
+    {
+        void (*relocate)(void *destination, void *source) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <typename Callable>
+    static constexpr Operations operations_of = {
+        [](void *destination, void *source) noexcept {
+            auto *callable = std::launder(static_cast<Callable *>(source));
+            ::new (destination) Callable(std::move(*callable));
+            callable->~Callable();
+        },
+        [](void *storage) noexcept { std::launder(static_cast<Callable *>(storage))->~Callable(); }};
+
+    template <typename F>
+    using RequireCallable = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction> &&
+                                             std::is_invocable_r_v<R, std::decay_t<F> &, Args...>>;
+
+  public:
+    /// @brief Inline buffer size in bytes.
+    static constexpr std::size_t capacity = Capacity;
+
+    InplaceFunction() noexcept = default;
+
+    InplaceFunction(std::nullptr_t) noexcept
+    {
+    }
+
+    /// @brief Constructor of the InplaceFunction class, stores a copy of the callable in the inline buffer.
+    template <typename F, typename = RequireCallable<F>> InplaceFunction(F &&function)
+    {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= Capacity,
+                      "Callable does not fit into the inline buffer of the InplaceFunction, increase its Capacity");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over-aligned for InplaceFunction");
+        static_assert(std::is_nothrow_move_constructible_v<Callable>,
+                      "InplaceFunction requires a callable that is nothrow move constructible");
+
+        ::new (static_cast<void *>(storage_)) Callable(std::forward<F>(function));
+        invoke_ = &invokeCallable<Callable>;
+        if constexpr (!std::is_trivially_copyable_v<Callable>)
+        {
+            operations_ = &operations_of<Callable>;
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    InplaceFunction &operator=(InplaceFunction &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction &) = delete;
+    InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    /// @brief Returns whether a callable is stored.
+    explicit operator bool() const noexcept
+    {
+        return invoke_ != nullptr;
+    }
+
+    /// @brief Calls the stored callable, which must exist.
+    R operator()(Args... args) const
+    {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+  private:
+    template <typename Callable> static R invokeCallable(void *storage, Args &&...args)
+    {
+        return std::invoke(*std::launder(static_cast<Callable *>(storage)), std::forward<Args>(args)...);
+    }
+
+    /// @brief Takes over the callable of the other InplaceFunction and leaves it empty.
+    void moveFrom(InplaceFunction &other) noexcept
+    {
+        if (other.operations_ == nullptr)
+        {
+            // Trivially relocatable: copying the whole buffer has a constant size that the compiler can inline
+            std::memcpy(storage_, other.storage_, Capacity);
+        }
+        else
+        {
+            other.operations_->relocate(storage_, other.storage_);
+        }
+        invoke_ = other.invoke_;
+        operations_ = other.operations_;
+        other.invoke_ = nullptr;
+        other.operations_ = nullptr;
+    }
+
+    /// @brief Destroys the stored callable, if any.
+    void reset() noexcept
+    {
+        if (operations_ != nullptr)
+        {
+            operations_->destroy(storage_);
+        }
+        invoke_ = nullptr;
+        operations_ = nullptr;
+    }
+
+    alignas(std::max_align_t) mutable std::byte storage_[Capacity];
+    R (*invoke_)(void *, Args &&...) = nullptr;
+    const Operations *operations_ = nullptr;
+};
@@ -0,0 +1,95 @@
+#include "instrumented_resource.hpp"
+
+#include <algorithm>       // std::max
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <iostream>        // std::cout
+#include <memory_resource> // std::pmr::new_delete_resource
+#include <string>          // std::pmr::string
+#include <thread>          // std::thread
+#include <unordered_map>   // std::pmr::unordered_map
+#include <vector>          // std::pmr::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_rounds = 2'000;
+constexpr std::size_t number_of_items = 256;
+
+/// @brief Grows a vector element by element, which allocates a new buffer on every doubling.
+__attribute__((noinline)) std::size_t buildSequence(std::pmr::memory_resource *resource)
+{
+    std::pmr::vector<std::size_t> sequence(resource);
+    for (std::size_t i = 0; i < number_of_items; ++i)
+    {
+        sequence.push_back(i);
+    }
+    return sequence.size();
+}
+
+/// @brief Builds a hash map of strings, which allocates one node per entry plus the long strings and the buckets.
+__attribute__((noinline)) std::size_t buildIndex(std::pmr::memory_resource *resource)
+{
+    std::pmr::unordered_map<std::size_t, std::pmr::string> index(resource);
+    for (std::size_t i = 0; i < number_of_items; ++i)
+    {
+        index.emplace(i, std::pmr::string("a string that is too long for the small string buffer", resource));
+    }
+    return index.size();
+}
+
+/// @brief Runs the workload on every thread against the same resource.
+double runWorkload(std::pmr::memory_resource *resource, const std::size_t number_of_threads)
+{
+    std::vector<std::thread> threads;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        threads.emplace_back([resource] {
+            std::size_t checksum = 0;
+            for (std::size_t round = 0; round < number_of_rounds; ++round)
+            {
+                checksum += buildSequence(resource);
+                checksum += buildIndex(resource);
+            }
+            doNotOptimize(checksum);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    const std::size_t number_of_threads = std::max(2U, std::thread::hardware_concurrency());
+
+    std::cout << "Elapsed time (new_delete_resource, " << number_of_threads
+              << " threads): " << runWorkload(std::pmr::new_delete_resource(), number_of_threads) << std::endl;
+
+    InstrumentedResource counting_resource(std::pmr::new_delete_resource());
+    std::cout << "Elapsed time (InstrumentedResource, " << number_of_threads
+              << " threads): " << runWorkload(&counting_resource, number_of_threads) << std::endl;
+
+    constexpr std::uint64_t sampling_interval = 1'000;
+    InstrumentedResource sampling_resource(std::pmr::new_delete_resource(), sampling_interval);
+    std::cout << "Elapsed time (InstrumentedResource sampling every " << sampling_interval << "th allocation, "
+              << number_of_threads << " threads): " << runWorkload(&sampling_resource, number_of_threads)
+              << std::endl;
+
+    // Keep some memory alive, so that the snapshot shows live bytes
+    std::pmr::vector<char> live_buffer(100'000, 'x', &sampling_resource);
+
+    const AllocationSnapshot snapshot = sampling_resource.snapshot(3);
+    snapshot.writeJson(std::cout);
+    snapshot.writeCsv(std::cout);
+
+    return EXIT_SUCCESS;
+}
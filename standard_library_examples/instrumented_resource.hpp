@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>       // std::max, std::min, std::sort
+#include <array>           // std::array
+#include <atomic>          // std::atomic, std::memory_order_relaxed
+#include <cstdint>         // std::size_t, std::uint64_t, std::int64_t
+#include <cstdlib>         // std::free
+#include <map>             // std::map
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::get_default_resource
+#include <mutex>           // std::mutex, std::lock_guard
+#include <ostream>         // std::ostream
+#include <string>          // std::string
+#include <vector>          // std::vector
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h> // backtrace, backtrace_symbols
+#define INSTRUMENTED_RESOURCE_HAS_BACKTRACE 1
+#else
+#define INSTRUMENTED_RESOURCE_HAS_BACKTRACE 0
+#endif
+
+/// @brief Point-in-time statistics of an InstrumentedResource.
+struct AllocationSnapshot
+{
+    /// @brief Number of power of two size buckets. Bucket i counts requests of (2^(i-1), 2^i] bytes, the last
+    /// bucket also counts everything larger.
+    static constexpr std::size_t number_of_buckets = 32;
+
+    /// @brief Sampled call stack with the number of samples and the bytes requested by the sampled allocations.
+    struct CallSite
+    {
+        std::vector<std::string> frames;
+        std::uint64_t samples = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t allocated_bytes = 0;
+    std::uint64_t deallocated_bytes = 0;
+    std::int64_t live_bytes = 0;
+    std::int64_t peak_live_bytes = 0;
+    std::array<std::uint64_t, number_of_buckets> size_histogram{};
+    std::vector<CallSite> hot_call_sites;
+
+    /// @brief Returns the largest request size, in bytes, that falls into the bucket.
+    static constexpr std::uint64_t bucketLimit(std::size_t bucket) noexcept
+    {
+        return std::uint64_t{1} << bucket;
+    }
+
+    /// @brief Writes the snapshot as one JSON object.
+    void writeJson(std::ostream &out) const
+    {
+        out << "{\n";
+        out << "  \"allocations\": " << allocations << ",\n";
+        out << "  \"deallocations\": " << deallocations << ",\n";
+        out << "  \"allocated_bytes\": " << allocated_bytes << ",\n";
+        out << "  \"deallocated_bytes\": " << deallocated_bytes << ",\n";
+        out << "  \"live_bytes\": " << live_bytes << ",\n";
+        out << "  \"peak_live_bytes\": " << peak_live_bytes << ",\n";
+        out << "  \"size_histogram\": [";
+        for (std::size_t bucket = 0; bucket < number_of_buckets; ++bucket)
+        {
+            out << (bucket == 0 ? "" : ", ") << "{\"max_bytes\": " << bucketLimit(bucket)
+                << ", \"count\": " << size_histogram[bucket] << "}";
+        }
+        out << "],\n";
+        out << "  \"hot_call_sites\": [";
+        for (std::size_t site = 0; site < hot_call_sites.size(); ++site)
+        {
+            const CallSite &call_site = hot_call_sites[site];
+            out << (site == 0 ? "\n" : ",\n") << "    {\"samples\": " << call_site.samples
+                << ", \"bytes\": " << call_site.bytes << ", \"frames\": [";
+            for (std::size_t frame = 0; frame < call_site.frames.size(); ++frame)
+            {
+                out << (frame == 0 ? "\"" : ", \"") << escapeJson(call_site.frames[frame]) << "\"";
+            }
+            out << "]}";
+        }
+        out << (hot_call_sites.empty() ? "]\n" : "\n  ]\n");
+        out << "}\n";
+    }
+
+    /// @brief Writes the snapshot as CSV with the columns section, key and value. Call sites are keyed by their
+    /// frames, innermost first and separated by " <- ".
+    void writeCsv(std::ostream &out) const
+    {
+        out << "section,key,value\n";
+        out << "counters,allocations," << allocations << "\n";
+        out << "counters,deallocations," << deallocations << "\n";
+        out << "counters,allocated_bytes," << allocated_bytes << "\n";
+        out << "counters,deallocated_bytes," << deallocated_bytes << "\n";
+        out << "counters,live_bytes," << live_bytes << "\n";
+        out << "counters,peak_live_bytes," << peak_live_bytes << "\n";
+        for (std::size_t bucket = 0; bucket < number_of_buckets; ++bucket)
+        {
+            out << "size_histogram," << bucketLimit(bucket) << "," << size_histogram[bucket] << "\n";
+        }
+        for (const auto &call_site : hot_call_sites)
+        {
+            std::string frames;
+            for (const auto &frame : call_site.frames)
+            {
+                frames += (frames.empty() ? "" : " <- ") + frame;
+            }
+            out << "call_site_samples,\"" << escapeCsv(frames) << "\"," << call_site.samples << "\n";
+            out << "call_site_bytes,\"" << escapeCsv(frames) << "\"," << call_site.bytes << "\n";
+        }
+    }
+
+  private:
+    static std::string escapeJson(const std::string &text)
+    {
+        std::string escaped;
+        for (const char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += character;
+        }
+        return escaped;
+    }
+
+    static std::string escapeCsv(const std::string &text)
+    {
+        std::string escaped;
+        for (const char character : text)
+        {
+            escaped += character;
+            if (character == '"')
+            {
+                escaped += '"';
+            }
+        }
+        return escaped;
+    }
+};
+
+/// @brief InstrumentedResource forwards all requests to an upstream resource and records how many calls and bytes
+/// went through it, the live and peak live bytes and a histogram of the request sizes. To stay cheap under load from
+/// many threads, the counters are spread over cache line sized shards, and every thread only updates the shard of its
+/// own thread index with relaxed atomic increments; snapshot() sums the shards. Live bytes are accumulated per shard
+/// and only published to the shared total every live_bytes_flush_threshold bytes, so the peak is exact to within
+/// that threshold per shard. Optionally every Nth allocation of a shard also records its call stack, which
+/// snapshot() aggregates into the hottest call sites.
+class InstrumentedResource final : public std::pmr::memory_resource
+{
+  public:
+    /// @brief Number of counter shards. Threads beyond this number share shards, which stays correct but contended.
+    static constexpr std::size_t number_of_shards = 64;
+
+    /// @brief Number of bytes a shard may allocate or free before it publishes its live bytes to the shared total.
+    static constexpr std::int64_t live_bytes_flush_threshold = 16 * 1024;
+
+    /// @brief Maximum number of frames recorded per sampled call stack.
+    static constexpr int max_stack_depth = 16;
+
+    /// @brief Constructor of the InstrumentedResource class.
+    /// @param upstream Resource that all requests are forwarded to.
+    /// @param sampling_interval Record the call stack of every sampling_interval-th allocation per shard, 0 disables
+    /// sampling.
+    explicit InstrumentedResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource(),
+                                  std::uint64_t sampling_interval = 0)
+        : upstream_(upstream), sampling_interval_(sampling_interval)
+    {
+    }
+
+    InstrumentedResource(const InstrumentedResource &) = delete;
+    InstrumentedResource &operator=(const InstrumentedResource &) = delete;
+
+    /// @brief Returns the statistics collected so far. Counters are read while other threads keep allocating, so they
+    /// are individually exact but not a consistent cut across counters.
+    /// @param max_call_sites Maximum number of call sites to return, hottest first.
+    AllocationSnapshot snapshot(std::size_t max_call_sites = 10) const
+    {
+        AllocationSnapshot snapshot;
+        std::int64_t unflushed_live_bytes = 0;
+        for (const Shard &shard : shards_)
+        {
+            snapshot.allocations += shard.allocations.load(std::memory_order_relaxed);
+            snapshot.deallocations += shard.deallocations.load(std::memory_order_relaxed);
+            snapshot.allocated_bytes += shard.allocated_bytes.load(std::memory_order_relaxed);
+            snapshot.deallocated_bytes += shard.deallocated_bytes.load(std::memory_order_relaxed);
+            unflushed_live_bytes += shard.unflushed_live_bytes.load(std::memory_order_relaxed);
+            for (std::size_t bucket = 0; bucket < AllocationSnapshot::number_of_buckets; ++bucket)
+            {
+                snapshot.size_histogram[bucket] += shard.size_histogram[bucket].load(std::memory_order_relaxed);
+            }
+        }
+        snapshot.live_bytes = live_bytes_.load(std::memory_order_relaxed) + unflushed_live_bytes;
+        snapshot.peak_live_bytes = std::max(peak_live_bytes_.load(std::memory_order_relaxed), snapshot.live_bytes);
+        snapshot.hot_call_sites = hotCallSites(max_call_sites);
+        return snapshot;
+    }
+
+    /// @brief Returns the upstream resource that all requests are forwarded to.
+    std::pmr::memory_resource *upstream_resource() const noexcept
+    {
+        return upstream_;
+    }
+
+  private:
+    /// @brief Counters updated by the threads whose thread index maps to the shard.
+    struct alignas(64) Shard
+    {
+        Shard()
+        {
+            for (auto &count : size_histogram)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> deallocations{0};
+        std::atomic<std::uint64_t> allocated_bytes{0};
+        std::atomic<std::uint64_t> deallocated_bytes{0};
+        std::atomic<std::int64_t> unflushed_live_bytes{0};
+        std::array<std::atomic<std::uint64_t>, AllocationSnapshot::number_of_buckets> size_histogram;
+    };
+
+    /// @brief Call stack of sampled allocations together with how often and how many bytes it was sampled.
+    struct SampledStack
+    {
+        std::uint64_t samples = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void *pointer = upstream_->allocate(bytes, alignment);
+
+        Shard &shard = shards_[threadIndex() % number_of_shards];
+        const std::uint64_t allocation_no = shard.allocations.fetch_add(1, std::memory_order_relaxed);
+        shard.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        shard.size_histogram[sizeBucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+        addLiveBytes(shard, static_cast<std::int64_t>(bytes));
+
+        if (sampling_interval_ != 0 && allocation_no % sampling_interval_ == 0)
+        {
+            sampleCallStack(bytes);
+        }
+        return pointer;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        Shard &shard = shards_[threadIndex() % number_of_shards];
+        shard.deallocations.fetch_add(1, std::memory_order_relaxed);
+        shard.deallocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        addLiveBytes(shard, -static_cast<std::int64_t>(bytes));
+
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    /// @brief Returns a small index that is unique per thread, assigned on the first call of the thread.
+    static std::size_t threadIndex() noexcept
+    {
+        static std::atomic<std::size_t> next_thread_index{0};
+        thread_local const std::size_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+        return thread_index;
+    }
+
+    /// @brief Returns the histogram bucket of a request size.
+    static std::size_t sizeBucket(std::size_t bytes) noexcept
+    {
+        const std::size_t bucket = (bytes <= 1) ? 0 : 64 - static_cast<std::size_t>(__builtin_clzll(bytes - 1));
+        return std::min(bucket, AllocationSnapshot::number_of_buckets - 1);
+    }
+
+    /// @brief Accumulates live bytes in the shard and publishes them to the shared total once they exceed the flush
+    /// threshold, which is also the only time the peak is updated.
+    void addLiveBytes(Shard &shard, std::int64_t bytes) noexcept
+    {
+        const std::int64_t unflushed = shard.unflushed_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (unflushed < live_bytes_flush_threshold && unflushed > -live_bytes_flush_threshold)
+        {
+            return;
+        }
+
+        const std::int64_t flushed = shard.unflushed_live_bytes.exchange(0, std::memory_order_relaxed);
+        const std::int64_t live = live_bytes_.fetch_add(flushed, std::memory_order_relaxed) + flushed;
+        std::int64_t peak = peak_live_bytes_.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /// @brief Records the call stack of the current allocation.
+    void sampleCallStack(std::size_t bytes)
+    {
+#if INSTRUMENTED_RESOURCE_HAS_BACKTRACE
+        void *frames[max_stack_depth];
+        const int depth = backtrace(frames, max_stack_depth);
+        // The innermost frames are this function and do_allocate
+        constexpr int skipped_frames = 2;
+        std::vector<void *> stack(frames + std::min(depth, skipped_frames), frames + depth);
+
+        std::lock_guard<std::mutex> lock(samples_mutex_);
+        SampledStack &sampled_stack = sampled_stacks_[std::move(stack)];
+        ++sampled_stack.samples;
+        sampled_stack.bytes += bytes;
+#else
+        static_cast<void>(bytes);
+#endif
+    }
+
+    /// @brief Returns the most frequently sampled call stacks with symbolized frames.
+    std::vector<AllocationSnapshot::CallSite> hotCallSites(std::size_t max_call_sites) const
+    {
+        std::vector<std::pair<std::vector<void *>, SampledStack>> stacks;
+        {
+            std::lock_guard<std::mutex> lock(samples_mutex_);
+            stacks.assign(sampled_stacks_.begin(), sampled_stacks_.end());
+        }
+        std::sort(stacks.begin(), stacks.end(),
+                  [](const auto &lhs, const auto &rhs) { return lhs.second.samples > rhs.second.samples; });
+        stacks.resize(std::min(stacks.size(), max_call_sites));
+
+        std::vector<AllocationSnapshot::CallSite> call_sites;
+        for (const auto &[stack, sampled_stack] : stacks)
+        {
+            AllocationSnapshot::CallSite call_site;
+            call_site.samples = sampled_stack.samples;
+            call_site.bytes = sampled_stack.bytes;
+#if INSTRUMENTED_RESOURCE_HAS_BACKTRACE
+            char **symbols = backtrace_symbols(stack.data(), static_cast<int>(stack.size()));
+            for (std::size_t frame = 0; frame < stack.size(); ++frame)
+            {
+                call_site.frames.emplace_back(symbols != nullptr ? symbols[frame] : "?");
+            }
+            std::free(symbols);
+#endif
+            call_sites.push_back(std::move(call_site));
+        }
+        return call_sites;
+    }
+
+    std::pmr::memory_resource *upstream_;
+    const std::uint64_t sampling_interval_;
+    std::array<Shard, number_of_shards> shards_;
+    alignas(64) std::atomic<std::int64_t> live_bytes_{0};
+    alignas(64) std::atomic<std::int64_t> peak_live_bytes_{0};
+    mutable std::mutex samples_mutex_;
+    std::map<std::vector<void *>, SampledStack> sampled_stacks_;
+};
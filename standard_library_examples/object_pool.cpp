@@ -0,0 +1,190 @@
+#include "object_pool.hpp"
+
+#include <algorithm> // std::max
+#include <chrono>    // std::chrono::high_resolution_clock
+#include <cstdint>   // std::size_t
+#include <future>    // std::packaged_task
+#include <iostream>  // std::cout
+#include <memory>    // std::make_shared, std::allocate_shared
+#include <string>    // std::string
+#include <thread>    // std::thread
+#include <vector>    // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_rounds = 200;
+constexpr std::size_t max_depth = 7;
+
+/// @brief Node of a region quad tree, as in algorithm_examples/quad_tree.cpp.
+struct TreeNode
+{
+    TreeNode(std::size_t depth, double x, double y, double width, double height)
+        : depth(depth), x(x), y(y), width(width), height(height)
+    {
+    }
+
+    std::size_t depth;
+    double x, y, width, height;
+    TreeNode *children[4] = {};
+};
+
+/// @brief Creates and destroys tree nodes with new and delete.
+struct HeapNodes
+{
+    template <typename... Args> TreeNode *create(Args &&...args)
+    {
+        return new TreeNode(std::forward<Args>(args)...);
+    }
+
+    void destroy(TreeNode *node) noexcept
+    {
+        delete node;
+    }
+};
+
+/// @brief Splits the node into four children recursively until max_depth, like QuadTree::split.
+template <typename Nodes> void split(Nodes &nodes, TreeNode *node)
+{
+    if (node->depth == max_depth)
+    {
+        return;
+    }
+    const double child_width = node->width / 2.0;
+    const double child_height = node->height / 2.0;
+    const std::size_t depth = node->depth + 1;
+    node->children[0] = nodes.create(depth, node->x, node->y, child_width, child_height);
+    node->children[1] = nodes.create(depth, node->x + child_width, node->y, child_width, child_height);
+    node->children[2] = nodes.create(depth, node->x, node->y + child_height, child_width, child_height);
+    node->children[3] = nodes.create(depth, node->x + child_width, node->y + child_height, child_width, child_height);
+    for (TreeNode *child : node->children)
+    {
+        split(nodes, child);
+    }
+}
+
+/// @brief Destroys the children of the node recursively, like QuadTree::clear.
+template <typename Nodes> void clear(Nodes &nodes, TreeNode *node)
+{
+    for (TreeNode *&child : node->children)
+    {
+        if (child != nullptr)
+        {
+            clear(nodes, child);
+            nodes.destroy(child);
+            child = nullptr;
+        }
+    }
+}
+
+/// @brief Builds and tears down a full quad tree number_of_rounds times, about 22'000 nodes per round.
+template <typename Nodes> double benchmarkTreeChurn(Nodes &nodes)
+{
+    TreeNode root(0, 0.0, 0.0, 100.0, 100.0);
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t round = 0; round < number_of_rounds; ++round)
+    {
+        split(nodes, &root);
+        doNotOptimize(root);
+        clear(nodes, &root);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+constexpr std::size_t number_of_tasks = 200'000;
+constexpr std::size_t tasks_in_flight = 64;
+
+/// @brief Creates shared packaged tasks like the work stealing thread pool example, on every thread, keeping a few
+/// of them alive at a time.
+template <typename MakeTask> double benchmarkTaskChurn(MakeTask make_task, const std::size_t number_of_threads)
+{
+    std::vector<std::thread> threads;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        threads.emplace_back([make_task] {
+            std::vector<std::shared_ptr<std::packaged_task<std::uint64_t()>>> in_flight(tasks_in_flight);
+            std::uint64_t checksum = 0;
+            for (std::size_t task_no = 0; task_no < number_of_tasks; ++task_no)
+            {
+                auto &task = in_flight[task_no % tasks_in_flight];
+                task = make_task(task_no);
+                (*task)();
+                checksum += task->get_future().get();
+            }
+            doNotOptimize(checksum);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    {
+        ObjectPool<std::string, PoolSynchronization::Unsynchronized> pool;
+        PooledPtr<std::string, PoolSynchronization::Unsynchronized> greeting = pool.make_pooled("Hello from the pool");
+        std::cout << *greeting << ", chunks: " << pool.numberOfChunks() << std::endl;
+
+        // Objects of the process-wide pool can be handed to and freed by any thread
+        PooledPtr<std::vector<int>> numbers = make_pooled<std::vector<int>>(std::initializer_list<int>{1, 2, 3});
+        std::thread([numbers = std::move(numbers)] { std::cout << "Size: " << numbers->size() << std::endl; }).join();
+
+        // The object and its reference counts share one pooled slot
+        const auto shared = std::allocate_shared<std::string>(PoolAllocator<std::string>(), "Shared from the pool");
+        std::cout << *shared << std::endl;
+    }
+
+    HeapNodes heap_nodes;
+    std::cout << "Elapsed time (tree churn, new/delete): " << benchmarkTreeChurn(heap_nodes) << std::endl;
+    ObjectPool<TreeNode, PoolSynchronization::Unsynchronized> unsynchronized_pool;
+    std::cout << "Elapsed time (tree churn, unsynchronized ObjectPool): " << benchmarkTreeChurn(unsynchronized_pool)
+              << std::endl;
+    ObjectPool<TreeNode, PoolSynchronization::Synchronized> synchronized_pool;
+    std::cout << "Elapsed time (tree churn, synchronized ObjectPool): " << benchmarkTreeChurn(synchronized_pool)
+              << std::endl;
+    ObjectPool<TreeNode> thread_cached_pool;
+    std::cout << "Elapsed time (tree churn, thread cached ObjectPool): " << benchmarkTreeChurn(thread_cached_pool)
+              << std::endl;
+
+    const std::size_t number_of_threads = std::max(2U, std::thread::hardware_concurrency());
+    const auto factorial = [](std::size_t n) {
+        std::uint64_t result = 1;
+        for (std::size_t i = 2; i <= n % 20; ++i)
+        {
+            result *= i;
+        }
+        return result;
+    };
+    std::cout << "Elapsed time (task churn, make_shared, " << number_of_threads << " threads): "
+              << benchmarkTaskChurn(
+                     [factorial](std::size_t n) {
+                         return std::make_shared<std::packaged_task<std::uint64_t()>>([factorial, n] {
+                             return factorial(n);
+                         });
+                     },
+                     number_of_threads)
+              << std::endl;
+    std::cout << "Elapsed time (task churn, allocate_shared with PoolAllocator, " << number_of_threads << " threads): "
+              << benchmarkTaskChurn(
+                     [factorial](std::size_t n) {
+                         return std::allocate_shared<std::packaged_task<std::uint64_t()>>(
+                             PoolAllocator<std::packaged_task<std::uint64_t()>>(), [factorial, n] {
+                                 return factorial(n);
+                             });
+                     },
+                     number_of_threads)
+              << std::endl;
+
+    return EXIT_SUCCESS;
+}
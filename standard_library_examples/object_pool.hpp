@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>     // std::max, std::min
+#include <atomic>        // std::atomic
+#include <cstddef>       // std::byte
+#include <cstdint>       // std::size_t, std::uint64_t
+#include <memory>        // std::allocator, std::unique_ptr
+#include <mutex>         // std::mutex, std::lock_guard, std::unique_lock
+#include <new>           // ::new
+#include <unordered_map> // std::unordered_map
+#include <utility>       // std::forward, std::pair
+#include <vector>        // std::vector
+
+/// @brief How an ObjectPool is shared between threads.
+enum class PoolSynchronization
+{
+    /// @brief The pool is used by one thread only and does not lock at all.
+    Unsynchronized,
+    /// @brief Every allocation and deallocation locks the free list of the pool.
+    Synchronized,
+    /// @brief Every thread allocates from and frees to its own cache of slots without locking, and exchanges batches
+    /// of slots with the shared free list of the pool only when the cache runs empty or overflows.
+    ThreadCached,
+};
+
+template <typename T, PoolSynchronization Synchronization> class ObjectPool;
+
+/// @brief Deleter that destroys an object and returns its slot to the pool it was created from.
+template <typename T, PoolSynchronization Synchronization> struct PoolDeleter
+{
+    ObjectPool<T, Synchronization> *pool = nullptr;
+
+    void operator()(T *object) const noexcept
+    {
+        pool->destroy(object);
+    }
+};
+
+/// @brief Owning handle to an object created from an ObjectPool, which returns the slot to the pool on destruction.
+template <typename T, PoolSynchronization Synchronization = PoolSynchronization::ThreadCached>
+using PooledPtr = std::unique_ptr<T, PoolDeleter<T, Synchronization>>;
+
+/// @brief ObjectPool hands out fixed-size slots for objects of type T. Free slots form an intrusive singly linked
+/// list threaded through the slots themselves, so allocating and freeing is a pointer pop or push without any size
+/// lookup or header. The pool grows by chunks that double in size up to max_chunk_bytes, and slots are carved from
+/// the newest chunk only when the free list is empty, so memory is touched as it is used. Chunks are only returned
+/// when the pool is destroyed, which must happen after all of its objects have been destroyed.
+///
+/// A thread cached pool gives every thread one cache per type T, which belongs to the pool the thread last
+/// allocated from. A thread that alternates between several thread cached pools of the same type hands its cache
+/// back and forth, so it should use synchronized pools instead.
+/// @tparam T Type of the pooled objects
+/// @tparam Synchronization How the pool is shared between threads
+template <typename T, PoolSynchronization Synchronization = PoolSynchronization::ThreadCached>
+class ObjectPool final
+{
+    /// @brief Storage of one object, or the link to the next free slot while the slot is free.
+    union Slot
+    {
+        Slot *next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    /// @brief Free slots of one pool, owned by one thread. It is trivially destructible, so that the fast path
+    /// accesses it without the initialization check of thread_local objects with a destructor.
+    struct ThreadCache
+    {
+        std::uint64_t owner;
+        Slot *head;
+        std::size_t count;
+    };
+
+    /// @brief Returns the slots of the thread cache to their pool, if it still exists, when the thread exits.
+    struct ThreadExit
+    {
+        ~ThreadExit()
+        {
+            returnToOwner(thread_cache_);
+        }
+    };
+
+    /// @brief Thread cached pools of T that exist, by id, so that a cache is never returned to a destroyed pool.
+    /// It is never destroyed, because threads may exit after static destruction.
+    struct Registry
+    {
+        std::mutex mutex;
+        std::uint64_t next_id = 1;
+        std::unordered_map<std::uint64_t, ObjectPool *> pools;
+    };
+
+  public:
+    /// @brief Number of slots in the first chunk.
+    static constexpr std::size_t min_chunk_slots = 32;
+
+    /// @brief Size, in bytes, that chunks stop doubling at.
+    static constexpr std::size_t max_chunk_bytes = 64 * 1024;
+
+    /// @brief Number of free slots a thread cache holds before it returns half of them to the shared free list.
+    static constexpr std::size_t cache_capacity = 64;
+
+    /// @brief Constructor of the ObjectPool class.
+    ObjectPool()
+    {
+        if constexpr (Synchronization == PoolSynchronization::ThreadCached)
+        {
+            Registry &pools = registry();
+            std::lock_guard<std::mutex> lock(pools.mutex);
+            id_ = pools.next_id++;
+            pools.pools.emplace(id_, this);
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /// @brief Destructor of the ObjectPool class, returns all chunks to the heap.
+    ~ObjectPool()
+    {
+        if constexpr (Synchronization == PoolSynchronization::ThreadCached)
+        {
+            Registry &pools = registry();
+            std::lock_guard<std::mutex> lock(pools.mutex);
+            pools.pools.erase(id_);
+        }
+        for (const auto &[chunk, number_of_slots] : chunks_)
+        {
+            std::allocator<Slot>().deallocate(chunk, number_of_slots);
+        }
+    }
+
+    /// @brief Returns uninitialized storage for one T.
+    void *allocate()
+    {
+        if constexpr (Synchronization == PoolSynchronization::ThreadCached)
+        {
+            ThreadCache &cache = thread_cache_;
+            if (cache.owner == id_ && cache.head != nullptr)
+            {
+                Slot *slot = cache.head;
+                cache.head = slot->next;
+                --cache.count;
+                return slot;
+            }
+            return allocateSlow();
+        }
+        else
+        {
+            const auto lock = lockShared();
+            return takeShared();
+        }
+    }
+
+    /// @brief Returns storage obtained from allocate() to the pool, on any thread.
+    void deallocate(void *pointer) noexcept
+    {
+        Slot *slot = static_cast<Slot *>(pointer);
+        if constexpr (Synchronization == PoolSynchronization::ThreadCached)
+        {
+            ThreadCache &cache = thread_cache_;
+            if (cache.owner == id_)
+            {
+                slot->next = cache.head;
+                cache.head = slot;
+                if (++cache.count > cache_capacity)
+                {
+                    drain(cache);
+                }
+                return;
+            }
+        }
+        const auto lock = lockShared();
+        slot->next = free_;
+        free_ = slot;
+    }
+
+    /// @brief Creates an object in a slot of the pool.
+    /// @param args Arguments forwarded to the constructor of T.
+    template <typename... Args> T *create(Args &&...args)
+    {
+        void *slot = allocate();
+        try
+        {
+            return ::new (slot) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            deallocate(slot);
+            throw;
+        }
+    }
+
+    /// @brief Destroys an object created by create() and returns its slot to the pool. Does nothing for nullptr.
+    void destroy(T *object) noexcept
+    {
+        if (object != nullptr)
+        {
+            object->~T();
+            deallocate(object);
+        }
+    }
+
+    /// @brief Creates an object in a slot of the pool and returns an owning handle to it.
+    /// @param args Arguments forwarded to the constructor of T.
+    template <typename... Args> PooledPtr<T, Synchronization> make_pooled(Args &&...args)
+    {
+        return PooledPtr<T, Synchronization>(create(std::forward<Args>(args)...),
+                                             PoolDeleter<T, Synchronization>{this});
+    }
+
+    /// @brief Returns the number of chunks the pool has allocated from the heap.
+    std::size_t numberOfChunks() const
+    {
+        const auto lock = lockShared();
+        return chunks_.size();
+    }
+
+    /// @brief Returns the process-wide pool of T, which is never destroyed so that objects may outlive static
+    /// destruction.
+    static ObjectPool &shared()
+    {
+        static auto *const pool = new ObjectPool();
+        return *pool;
+    }
+
+  private:
+    /// @brief Takes over the thread cache if it belongs to another pool, refills it from the shared free list and
+    /// allocates from it.
+    __attribute__((noinline)) void *allocateSlow()
+    {
+        static_cast<void>(&thread_exit_);
+        ThreadCache &cache = thread_cache_;
+        if (cache.owner != id_)
+        {
+            returnToOwner(cache);
+            cache.owner = id_;
+        }
+        refill(cache);
+        Slot *slot = cache.head;
+        cache.head = slot->next;
+        --cache.count;
+        return slot;
+    }
+
+    /// @brief Locks the shared free list, unless the pool is unsynchronized.
+    std::unique_lock<std::mutex> lockShared() const
+    {
+        if constexpr (Synchronization == PoolSynchronization::Unsynchronized)
+        {
+            return std::unique_lock<std::mutex>();
+        }
+        else
+        {
+            return std::unique_lock<std::mutex>(mutex_);
+        }
+    }
+
+    /// @brief Pops a slot from the shared free list, or carves one from the newest chunk if the list is empty. The
+    /// caller holds the lock of the shared free list.
+    Slot *takeShared()
+    {
+        if (free_ != nullptr)
+        {
+            Slot *slot = free_;
+            free_ = slot->next;
+            return slot;
+        }
+        if (carve_ == carve_end_)
+        {
+            grow();
+        }
+        return carve_++;
+    }
+
+    /// @brief Allocates the next chunk, twice as large as the previous one up to max_chunk_bytes.
+    void grow()
+    {
+        constexpr std::size_t max_chunk_slots = std::max(min_chunk_slots, max_chunk_bytes / sizeof(Slot));
+        const std::size_t number_of_slots =
+            chunks_.empty() ? min_chunk_slots : std::min(2 * chunks_.back().second, max_chunk_slots);
+        chunks_.reserve(chunks_.size() + 1);
+        Slot *chunk = std::allocator<Slot>().allocate(number_of_slots);
+        chunks_.emplace_back(chunk, number_of_slots);
+        carve_ = chunk;
+        carve_end_ = chunk + number_of_slots;
+    }
+
+    /// @brief Moves half a cache worth of slots from the shared free list into the empty cache. The slots keep their
+    /// order, so that freshly carved slots are handed out at ascending addresses.
+    void refill(ThreadCache &cache)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot **tail = &cache.head;
+        for (std::size_t i = 0; i < cache_capacity / 2; ++i)
+        {
+            Slot *slot = takeShared();
+            slot->next = nullptr;
+            *tail = slot;
+            tail = &slot->next;
+            ++cache.count;
+        }
+    }
+
+    /// @brief Moves half of the slots of the overflowing cache to the shared free list. Slots that one thread
+    /// allocates and another thread frees travel back this way.
+    __attribute__((noinline)) void drain(ThreadCache &cache) noexcept
+    {
+        Slot *first = cache.head;
+        Slot *last = first;
+        for (std::size_t i = 1; i < cache_capacity / 2; ++i)
+        {
+            last = last->next;
+        }
+        cache.head = last->next;
+        cache.count -= cache_capacity / 2;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        last->next = free_;
+        free_ = first;
+    }
+
+    /// @brief Moves all slots of the cache to the shared free list of the pool that owns it. The slots are dropped
+    /// if that pool has been destroyed, together with its chunks.
+    static void returnToOwner(ThreadCache &cache) noexcept
+    {
+        if (cache.head == nullptr)
+        {
+            return;
+        }
+        Registry &pools = registry();
+        std::lock_guard<std::mutex> registry_lock(pools.mutex);
+        const auto owner = pools.pools.find(cache.owner);
+        if (owner != pools.pools.end())
+        {
+            Slot *last = cache.head;
+            while (last->next != nullptr)
+            {
+                last = last->next;
+            }
+            std::lock_guard<std::mutex> lock(owner->second->mutex_);
+            last->next = owner->second->free_;
+            owner->second->free_ = cache.head;
+        }
+        cache.head = nullptr;
+        cache.count = 0;
+    }
+
+    static Registry &registry()
+    {
+        static auto *const pools = new Registry();
+        return *pools;
+    }
+
+    static inline thread_local ThreadCache thread_cache_ = {};
+    static inline thread_local ThreadExit thread_exit_;
+
+    mutable std::mutex mutex_;
+    std::uint64_t id_ = 0;
+    Slot *free_ = nullptr;
+    Slot *carve_ = nullptr;
+    Slot *carve_end_ = nullptr;
+    std::vector<std::pair<Slot *, std::size_t>> chunks_;
+};
+
+/// @brief Creates an object in the process-wide pool of T and returns an owning handle to it.
+/// @param args Arguments forwarded to the constructor of T.
+template <typename T, typename... Args> PooledPtr<T> make_pooled(Args &&...args)
+{
+    return ObjectPool<T>::shared().make_pooled(std::forward<Args>(args)...);
+}
+
+/// @brief Standard allocator that takes single objects from the process-wide ObjectPool of their type and forwards
+/// arrays to std::allocator. Passed to std::allocate_shared, the object and its reference counts share one pooled
+/// slot. All PoolAllocators share the pools, so they always compare equal and memory can be freed through any of
+/// them, on any thread.
+/// @tparam T Type of the allocated objects
+template <typename T> struct PoolAllocator
+{
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <typename U> PoolAllocator(const PoolAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<T *>(ObjectPool<T>::shared().allocate());
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        if (n == 1)
+        {
+            ObjectPool<T>::shared().deallocate(p);
+            return;
+        }
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+
+template <typename T, typename U> bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U> bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return false;
+}
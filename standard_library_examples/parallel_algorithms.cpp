@@ -0,0 +1,117 @@
+#include "parallel_algorithms.hpp"
+
+#include <algorithm>  // std::for_each
+#include <chrono>     // std::chrono::high_resolution_clock
+#include <cmath>      // std::sqrt
+#include <cstdint>    // std::size_t, std::uint64_t
+#include <execution>  // std::execution::seq, std::execution::par
+#include <functional> // std::plus
+#include <iostream>   // std::cout
+#include <numeric>    // std::accumulate, std::inclusive_scan, std::iota, std::reduce
+#include <vector>     // std::vector
+
+#include <tbb/blocked_range.h>   // tbb::blocked_range
+#include <tbb/parallel_for.h>    // tbb::parallel_for
+#include <tbb/parallel_reduce.h> // tbb::parallel_reduce
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_elements = 10'000'000;
+constexpr std::size_t number_of_irregular_elements = 100'000;
+
+/// @brief Cheap work per element, where the overhead of splitting the loop dominates.
+void cheapWork(double &element)
+{
+    element = std::sqrt(element) + 1.0;
+}
+
+/// @brief Work whose cost grows with the value of the element, from nothing up to some microseconds, so that equally
+/// sized ranges take very different times.
+void irregularWork(std::uint64_t &element)
+{
+    std::uint64_t seed = element;
+    for (std::uint64_t i = 0; i < element % 4096; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        doNotOptimize(seed);
+    }
+    element = seed;
+}
+
+/// @brief Runs the function once and prints its elapsed time.
+template <typename F> void measure(const char *name, F &&function)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    function();
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (" << name << "): " << (stop_time - start_time).count() / 1e9 << std::endl;
+}
+
+int main()
+{
+    WorkStealingThreadPool &pool = defaultThreadPool();
+    std::cout << "Workers: " << pool.numberOfThreads() << std::endl;
+
+    std::vector<double> values(number_of_elements);
+    std::iota(values.begin(), values.end(), 0.0);
+    measure("for_each, std::execution::seq", [&] { std::for_each(values.begin(), values.end(), cheapWork); });
+    measure("for_each, std::execution::par",
+            [&] { std::for_each(std::execution::par, values.begin(), values.end(), cheapWork); });
+    measure("for_each, tbb::parallel_for", [&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, values.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              std::for_each(values.begin() + range.begin(), values.begin() + range.end(), cheapWork);
+                          });
+    });
+    measure("for_each, parallelForEach", [&] { parallelForEach(pool, values.begin(), values.end(), cheapWork); });
+
+    std::vector<std::uint64_t> irregular(number_of_irregular_elements);
+    std::iota(irregular.begin(), irregular.end(), 0);
+    measure("irregular for_each, std::execution::seq",
+            [&] { std::for_each(irregular.begin(), irregular.end(), irregularWork); });
+    measure("irregular for_each, std::execution::par",
+            [&] { std::for_each(std::execution::par, irregular.begin(), irregular.end(), irregularWork); });
+    measure("irregular for_each, tbb::parallel_for", [&] {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, irregular.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range) {
+                              std::for_each(irregular.begin() + range.begin(), irregular.begin() + range.end(),
+                                            irregularWork);
+                          });
+    });
+    measure("irregular for_each, parallelForEach",
+            [&] { parallelForEach(pool, irregular.begin(), irregular.end(), irregularWork); });
+
+    std::iota(values.begin(), values.end(), 0.0);
+    double sum = 0.0;
+    measure("reduce, std::execution::seq", [&] { sum += std::reduce(values.begin(), values.end(), 0.0); });
+    measure("reduce, std::execution::par",
+            [&] { sum += std::reduce(std::execution::par, values.begin(), values.end(), 0.0); });
+    measure("reduce, tbb::parallel_reduce", [&] {
+        sum += tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, values.size()), 0.0,
+            [&](const tbb::blocked_range<std::size_t> &range, double partial) {
+                return std::accumulate(values.begin() + range.begin(), values.begin() + range.end(), partial);
+            },
+            std::plus<double>());
+    });
+    measure("reduce, parallelReduce",
+            [&] { sum += parallelReduce(pool, values.begin(), values.end(), 0.0, std::plus<double>()); });
+    std::cout << "Checksum: " << sum << std::endl;
+
+    std::vector<double> prefix_sums(number_of_elements);
+    measure("inclusive_scan, std::execution::seq",
+            [&] { std::inclusive_scan(values.begin(), values.end(), prefix_sums.begin()); });
+    measure("inclusive_scan, std::execution::par", [&] {
+        std::inclusive_scan(std::execution::par, values.begin(), values.end(), prefix_sums.begin());
+    });
+    measure("inclusive_scan, parallelScan", [&] {
+        parallelScan(pool, values.begin(), values.end(), prefix_sums.begin(), std::plus<double>());
+    });
+    std::cout << "Checksum: " << prefix_sums.back() << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "work_stealing_thread_pool.hpp"
+
+#include <algorithm> // std::for_each, std::min, std::max
+#include <atomic>    // std::atomic
+#include <cstdint>   // std::size_t
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <iterator>  // std::iterator_traits
+#include <numeric>   // std::accumulate, std::inclusive_scan
+#include <optional>  // std::optional
+#include <thread>    // std::this_thread::yield
+#include <utility>   // std::move
+#include <vector>    // std::vector
+
+/// @brief Largest number of subranges that one task of a parallel loop splits off, enough to halve any range down to
+/// single iterations.
+inline constexpr std::size_t parallel_max_splits_per_task = 64;
+
+/// @brief Number of chunks per worker that the iterations between two checks for splitting are limited to, so that
+/// the end of a loop still balances.
+inline constexpr std::size_t parallel_chunks_per_worker = 8;
+
+/// @brief Smallest block of a parallel scan, below which the second pass over the data costs more than it saves.
+inline constexpr std::size_t parallel_scan_min_block = 16 * 1024;
+
+/// @brief Returns the process-wide pool that parallel loops run on by default. It is created on first use with one
+/// worker per hardware thread and lives until the process exits, so loops do not pay for starting threads.
+inline WorkStealingThreadPool &defaultThreadPool()
+{
+    static WorkStealingThreadPool *pool = new WorkStealingThreadPool();
+    return *pool;
+}
+
+/// @brief LazySplittingLoop runs a loop over the index range [0, size) on a WorkStealingThreadPool with lazy binary
+/// splitting (Tzannes et al., "Lazy Binary-Splitting", PPoPP 2010). A task runs its range in chunks, and before every
+/// chunk it checks whether its own deque is empty, which means that nobody could steal work from it. Only then it
+/// pushes the upper half of its remaining range as a new task. Loops therefore split as much as idle workers demand
+/// rather than by a fixed grain size, and the chunks grow from one iteration up to a limit, so cheap iterations do
+/// not pay for a check each. Every task folds its iterations into an optional partial result with the leaf function,
+/// then waits for the tasks it split off, running pending tasks meanwhile, and combines their partials in index
+/// order, so the reduction only needs to be associative. The first exception of a leaf is rethrown by run() after
+/// all tasks of the loop have finished.
+/// @tparam T Type of the partial results
+/// @tparam Leaf Callable as void(std::size_t begin, std::size_t end, std::optional<T> &partial)
+/// @tparam Reduce Callable as T(T lhs, T rhs)
+template <typename T, typename Leaf, typename Reduce> class LazySplittingLoop final
+{
+    /// @brief Result of a split-off subrange, on the stack of the task that waits for it.
+    struct Child
+    {
+        std::optional<T> partial;
+        std::exception_ptr exception;
+        std::atomic<bool> done{false};
+    };
+
+  public:
+    LazySplittingLoop(WorkStealingThreadPool &pool, Leaf &leaf, Reduce &reduce, std::size_t size) noexcept
+        : pool_(pool), leaf_(leaf), reduce_(reduce),
+          max_chunk_(std::max<std::size_t>(1, size / (parallel_chunks_per_worker * (pool.numberOfThreads() + 1))))
+    {
+    }
+
+    /// @brief Runs the loop over [begin, end) and returns the reduction of the partial results, if any.
+    std::optional<T> run(std::size_t begin, std::size_t end)
+    {
+        Child children[parallel_max_splits_per_task];
+        std::size_t number_of_children = 0;
+        std::optional<T> partial;
+        std::exception_ptr exception;
+        std::size_t chunk = 1;
+        try
+        {
+            while (begin != end)
+            {
+                const std::size_t remaining = end - begin;
+                if (remaining > 2 * chunk && number_of_children < parallel_max_splits_per_task &&
+                    pool_.localQueueEmpty())
+                {
+                    const std::size_t middle = begin + remaining / 2;
+                    Child &child = children[number_of_children];
+                    pool_.pushTask([this, &child, middle, end] { runChild(child, middle, end); });
+                    ++number_of_children;
+                    end = middle;
+                    continue;
+                }
+                const std::size_t chunk_end = begin + std::min(chunk, remaining);
+                runChunk(begin, chunk_end, partial);
+                begin = chunk_end;
+                chunk = std::min(2 * chunk, max_chunk_);
+            }
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        // The child split off last covers the range right after this task's own, so combine from the last one
+        for (std::size_t child_no = number_of_children; child_no-- > 0;)
+        {
+            Child &child = children[child_no];
+            waitFor(child.done);
+            if (child.exception && !exception)
+            {
+                exception = child.exception;
+            }
+            if (!exception)
+            {
+                combine(partial, std::move(child.partial));
+            }
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return partial;
+    }
+
+  private:
+    /// @brief Runs the leaf function over one chunk. Kept out of line, so that the leaf keeps its accumulator in a
+    /// register rather than in the partial, which lives across the calls of the splitting loop.
+    __attribute__((noinline)) void runChunk(std::size_t begin, std::size_t end, std::optional<T> &partial)
+    {
+        leaf_(begin, end, partial);
+    }
+
+    void runChild(Child &child, std::size_t begin, std::size_t end) noexcept
+    {
+        try
+        {
+            child.partial = run(begin, end);
+        }
+        catch (...)
+        {
+            child.exception = std::current_exception();
+        }
+        child.done.store(true, std::memory_order_release);
+    }
+
+    void combine(std::optional<T> &lhs, std::optional<T> &&rhs)
+    {
+        if (!rhs)
+        {
+            return;
+        }
+        if (!lhs)
+        {
+            lhs = std::move(rhs);
+            return;
+        }
+        lhs = reduce_(std::move(*lhs), std::move(*rhs));
+    }
+
+    /// @brief Waits until the flag is set, running pending tasks of the pool meanwhile and yielding if there are none.
+    void waitFor(const std::atomic<bool> &done)
+    {
+        while (!done.load(std::memory_order_acquire))
+        {
+            if (!pool_.tryRunPendingTask())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    WorkStealingThreadPool &pool_;
+    Leaf &leaf_;
+    Reduce &reduce_;
+    const std::size_t max_chunk_;
+};
+
+/// @brief Runs the loop over [0, size) with lazy binary splitting and returns the reduction of the partial results.
+template <typename T, typename Leaf, typename Reduce>
+std::optional<T> runLazySplittingLoop(WorkStealingThreadPool &pool, std::size_t size, Leaf leaf, Reduce reduce)
+{
+    LazySplittingLoop<T, Leaf, Reduce> loop(pool, leaf, reduce, size);
+    return loop.run(0, size);
+}
+
+/// @brief Calls func with every index of [0, size) on the pool and returns once all calls have finished.
+/// @throws The first exception thrown by func, after all other calls have finished.
+template <typename Func> void parallelFor(WorkStealingThreadPool &pool, std::size_t size, Func func)
+{
+    runLazySplittingLoop<bool>(
+        pool, size,
+        [&func](std::size_t begin, std::size_t end, std::optional<bool> &) {
+            for (std::size_t index = begin; index < end; ++index)
+            {
+                func(index);
+            }
+        },
+        [](bool lhs, bool) { return lhs; });
+}
+
+/// @brief Calls func for every element of [first, last) on the pool and returns once all calls have finished.
+/// @throws The first exception thrown by func, after all other calls have finished.
+template <typename RandomIt, typename Func>
+void parallelForEach(WorkStealingThreadPool &pool, RandomIt first, RandomIt last, Func func)
+{
+    const auto size = static_cast<std::size_t>(last - first);
+    runLazySplittingLoop<bool>(
+        pool, size,
+        [first, &func](std::size_t begin, std::size_t end, std::optional<bool> &) {
+            std::for_each(first + begin, first + end, func);
+        },
+        [](bool lhs, bool) { return lhs; });
+}
+
+/// @brief Calls func for every element of [first, last), on the default pool if parallel is set.
+template <typename RandomIt, typename Func>
+void parallelForEach(RandomIt first, RandomIt last, Func func, bool parallel = true)
+{
+    if (parallel)
+    {
+        parallelForEach(defaultThreadPool(), first, last, std::move(func));
+    }
+    else
+    {
+        std::for_each(first, last, func);
+    }
+}
+
+/// @brief Reduces [first, last) with the associative operation on the pool, like std::reduce, and returns
+/// reduce(init, result).
+template <typename RandomIt, typename T, typename Reduce>
+T parallelReduce(WorkStealingThreadPool &pool, RandomIt first, RandomIt last, T init, Reduce reduce)
+{
+    const auto size = static_cast<std::size_t>(last - first);
+    std::optional<T> result = runLazySplittingLoop<T>(
+        pool, size,
+        [first, &reduce](std::size_t begin, std::size_t end, std::optional<T> &partial) {
+            T value = partial ? std::move(*partial) : T(first[begin++]);
+            value = std::accumulate(first + begin, first + end, std::move(value), reduce);
+            partial = std::move(value);
+        },
+        reduce);
+    return result ? reduce(std::move(init), std::move(*result)) : init;
+}
+
+/// @brief Writes the inclusive prefix sums of [first, last) under the associative operation to d_first on the pool,
+/// like std::inclusive_scan. The range is cut into blocks: a parallel pass reduces every block, a short sequential
+/// pass turns the block sums into the offsets of the blocks, and a second parallel pass scans every block from its
+/// offset. With a single worker the range is scanned sequentially, because the first pass would only add work.
+/// @return End of the output range.
+template <typename RandomIt, typename OutputIt, typename Scan>
+OutputIt parallelScan(WorkStealingThreadPool &pool, RandomIt first, RandomIt last, OutputIt d_first, Scan scan)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    const auto size = static_cast<std::size_t>(last - first);
+    const std::size_t number_of_workers = pool.numberOfThreads();
+    if (number_of_workers <= 1 || size < 2 * parallel_scan_min_block)
+    {
+        return std::inclusive_scan(first, last, d_first, scan);
+    }
+
+    const std::size_t block_size =
+        std::max(parallel_scan_min_block, (size + parallel_chunks_per_worker * number_of_workers - 1) /
+                                              (parallel_chunks_per_worker * number_of_workers));
+    const std::size_t number_of_blocks = (size + block_size - 1) / block_size;
+    std::vector<std::optional<T>> offsets(number_of_blocks);
+    const auto block_end = [size, block_size](std::size_t block_no) {
+        return std::min(size, (block_no + 1) * block_size);
+    };
+
+    // Reduces every block but the last one, whose sum no other block needs
+    parallelFor(pool, number_of_blocks - 1, [&](std::size_t block_no) {
+        T sum = first[block_no * block_size];
+        for (std::size_t index = block_no * block_size + 1; index < block_end(block_no); ++index)
+        {
+            sum = scan(std::move(sum), first[index]);
+        }
+        offsets[block_no + 1] = std::move(sum);
+    });
+    for (std::size_t block_no = 2; block_no < number_of_blocks; ++block_no)
+    {
+        offsets[block_no] = scan(*offsets[block_no - 1], std::move(*offsets[block_no]));
+    }
+
+    parallelFor(pool, number_of_blocks, [&](std::size_t block_no) {
+        const std::size_t begin = block_no * block_size;
+        if (!offsets[block_no])
+        {
+            std::inclusive_scan(first + begin, first + block_end(block_no), d_first + begin, scan);
+        }
+        else
+        {
+            std::inclusive_scan(first + begin, first + block_end(block_no), d_first + begin, scan,
+                                std::move(*offsets[block_no]));
+        }
+    });
+    return d_first + size;
+}
@@ -0,0 +1,206 @@
+#include "remote_free_resource.hpp"
+
+#include <algorithm>       // std::max
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <deque>           // std::deque
+#include <iostream>        // std::cout
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::synchronized_pool_resource
+#include <mutex>           // std::mutex, std::lock_guard
+#include <string>          // std::string
+#include <thread>          // std::thread, std::this_thread::yield
+#include <utility>         // std::move
+#include <vector>          // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t message_size = 64;
+constexpr std::size_t batch_size = 64;
+constexpr std::size_t max_batches_in_flight = 16;
+constexpr std::size_t number_of_batches = 100'000;
+
+/// @brief Bounded queue of message batches from one thread to another. Messages travel in batches, so that the lock of
+/// the queue is taken once per batch and the benchmark measures the memory resource rather than the queue.
+class BatchChannel
+{
+  public:
+    /// @brief Moves the batch into the queue unless it is full. Returns whether the batch was moved.
+    bool tryPush(std::vector<void *> &batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (batches_.size() == max_batches_in_flight)
+        {
+            return false;
+        }
+        batches_.push_back(std::move(batch));
+        batch.clear();
+        return true;
+    }
+
+    /// @brief Moves the oldest batch out of the queue unless it is empty. Returns whether a batch was moved.
+    bool tryPop(std::vector<void *> &batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (batches_.empty())
+        {
+            return false;
+        }
+        batch = std::move(batches_.front());
+        batches_.pop_front();
+        return true;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::deque<std::vector<void *>> batches_;
+};
+
+/// @brief Allocates a batch of messages from the resource and writes their sequence numbers into them.
+void fillBatch(std::pmr::memory_resource *resource, std::vector<void *> &batch, std::size_t &sequence_no)
+{
+    batch.reserve(batch_size);
+    for (std::size_t i = 0; i < batch_size; ++i)
+    {
+        void *message = resource->allocate(message_size);
+        *static_cast<std::size_t *>(message) = sequence_no++;
+        batch.push_back(message);
+    }
+}
+
+/// @brief Reads the messages of the batch and returns them to the resource.
+void consumeBatch(std::pmr::memory_resource *resource, std::vector<void *> &batch, std::size_t &checksum)
+{
+    for (void *message : batch)
+    {
+        checksum += *static_cast<const std::size_t *>(message);
+        resource->deallocate(message, message_size);
+    }
+    batch.clear();
+}
+
+/// @brief One producer allocates every message and one consumer frees every message, so every free is remote.
+double benchmarkProducerConsumer(std::pmr::memory_resource *resource)
+{
+    BatchChannel channel;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    std::thread producer([resource, &channel] {
+        std::size_t sequence_no = 0;
+        std::vector<void *> batch;
+        for (std::size_t batch_no = 0; batch_no < number_of_batches; ++batch_no)
+        {
+            fillBatch(resource, batch, sequence_no);
+            while (!channel.tryPush(batch))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([resource, &channel] {
+        std::size_t checksum = 0;
+        std::vector<void *> batch;
+        for (std::size_t batch_no = 0; batch_no < number_of_batches; ++batch_no)
+        {
+            while (!channel.tryPop(batch))
+            {
+                std::this_thread::yield();
+            }
+            consumeBatch(resource, batch, checksum);
+        }
+        doNotOptimize(checksum);
+    });
+    producer.join();
+    consumer.join();
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Every thread allocates messages for the next thread in a ring and frees the messages of the previous one,
+/// so every thread is producer and consumer at once and every free is remote.
+double benchmarkRing(std::pmr::memory_resource *resource, const std::size_t number_of_threads)
+{
+    std::vector<BatchChannel> channels(number_of_threads);
+    std::vector<std::thread> threads;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        BatchChannel &outgoing = channels[thread_no];
+        BatchChannel &incoming = channels[(thread_no + number_of_threads - 1) % number_of_threads];
+        threads.emplace_back([resource, &outgoing, &incoming, number_of_threads] {
+            const std::size_t batches_per_thread = number_of_batches / number_of_threads;
+            std::size_t sequence_no = 0;
+            std::size_t checksum = 0;
+            std::size_t sent = 0;
+            std::size_t received = 0;
+            std::vector<void *> outgoing_batch;
+            std::vector<void *> incoming_batch;
+            while (sent < batches_per_thread || received < batches_per_thread)
+            {
+                bool progress = false;
+                if (sent < batches_per_thread)
+                {
+                    if (outgoing_batch.empty())
+                    {
+                        fillBatch(resource, outgoing_batch, sequence_no);
+                    }
+                    if (outgoing.tryPush(outgoing_batch))
+                    {
+                        ++sent;
+                        progress = true;
+                    }
+                }
+                if (received < batches_per_thread && incoming.tryPop(incoming_batch))
+                {
+                    consumeBatch(resource, incoming_batch, checksum);
+                    ++received;
+                    progress = true;
+                }
+                if (!progress)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            doNotOptimize(checksum);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Runs both handoff benchmarks against the resource.
+void compareResource(const std::string &name, std::pmr::memory_resource *resource, const std::size_t number_of_threads)
+{
+    std::cout << "Elapsed time (producer/consumer, " << name << "): " << benchmarkProducerConsumer(resource)
+              << std::endl;
+    std::cout << "Elapsed time (ring of " << number_of_threads << " threads, " << name
+              << "): " << benchmarkRing(resource, number_of_threads) << std::endl;
+}
+
+int main()
+{
+    const std::size_t number_of_threads = std::max(4U, std::thread::hardware_concurrency());
+
+    compareResource("new_delete_resource", std::pmr::new_delete_resource(), number_of_threads);
+
+    std::pmr::synchronized_pool_resource pool_resource;
+    compareResource("synchronized_pool_resource", &pool_resource, number_of_threads);
+
+    SlabResource slab_resource;
+    compareResource("SlabResource", &slab_resource, number_of_threads);
+
+    RemoteFreeResource remote_free_resource;
+    compareResource("RemoteFreeResource", &remote_free_resource, number_of_threads);
+    std::cout << "Pages: " << RemoteFreeHeap::numberOfPages()
+              << ", abandoned by exited threads: " << RemoteFreeHeap::numberOfAbandonedPages() << std::endl;
+
+    return EXIT_SUCCESS;
+}
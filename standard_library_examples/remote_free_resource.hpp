@@ -0,0 +1,348 @@
+#pragma once
+
+#include "slab_allocator.hpp"
+
+#include <algorithm>       // std::max, std::min
+#include <array>           // std::array
+#include <atomic>          // std::atomic
+#include <cstddef>         // std::byte
+#include <cstdint>         // std::size_t, std::uintptr_t
+#include <memory_resource> // std::pmr::memory_resource
+#include <mutex>           // std::mutex, std::lock_guard
+#include <new>             // std::align_val_t
+
+/// @brief Size of a RemoteFreeHeap page. Pages are aligned to their size, so the page of a block is found by masking
+/// the block's address.
+inline constexpr std::size_t remote_free_page_size = 64 * 1024;
+
+/// @brief RemoteFreeHeap is a process-wide small object heap for memory that is allocated on one thread and freed on
+/// another, such as messages passed from producers to consumers. It uses the size classes of the SlabHeap, but every
+/// 64 KiB page of blocks is owned by one thread. The owner allocates from and frees to the page's local free list
+/// without locks or atomics. Any other thread pushes the block onto the page's remote free list with a single
+/// compare-and-swap, and the owner takes the whole remote list with one exchange once its local list is empty. Blocks
+/// thus go home in batches, and neither side ever takes a lock on the hot path.
+///
+/// When a thread exits, its pages are abandoned: blocks that are still in use can be freed remotely as before, and
+/// the first thread that runs out of pages of a class adopts an abandoned page of that class. Pages are never
+/// returned to the operating system. Larger or more strictly aligned requests are forwarded to ::operator new.
+class RemoteFreeHeap final
+{
+  public:
+    /// @brief Number of size classes.
+    static constexpr std::size_t number_of_size_classes = SlabHeap::number_of_size_classes;
+
+    /// @brief Allocates memory for bytes bytes with the given alignment.
+    /// @param bytes Size of the requested memory in bytes.
+    /// @param alignment Alignment of the requested memory, a power of two.
+    /// @return Pointer to the allocated memory.
+    /// @throws std::bad_alloc if the memory cannot be allocated.
+    static void *allocate(std::size_t bytes, std::size_t alignment = slab_min_alignment)
+    {
+        const std::size_t size_class = SlabHeap::sizeClass(bytes, alignment);
+        if (size_class == number_of_size_classes)
+        {
+            return ::operator new(bytes, std::align_val_t{alignment});
+        }
+
+        ThreadHeap *heap = thread_heap_;
+        if (heap != nullptr)
+        {
+            Page *page = heap->current[size_class];
+            if (page != nullptr && page->local_free != nullptr)
+            {
+                Block *block = page->local_free;
+                page->local_free = block->next;
+                return block;
+            }
+        }
+        return allocateSlow(heap, size_class);
+    }
+
+    /// @brief Returns memory obtained from allocate with the same bytes and alignment, from any thread.
+    /// @param pointer Pointer to the memory to free.
+    /// @param bytes Size of the memory in bytes, as passed to allocate.
+    /// @param alignment Alignment of the memory, as passed to allocate.
+    static void deallocate(void *pointer, std::size_t bytes, std::size_t alignment = slab_min_alignment) noexcept
+    {
+        if (SlabHeap::sizeClass(bytes, alignment) == number_of_size_classes)
+        {
+            ::operator delete(pointer, std::align_val_t{alignment});
+            return;
+        }
+
+        Block *block = static_cast<Block *>(pointer);
+        Page *page = pageOf(block);
+        ThreadHeap *heap = thread_heap_;
+        if (heap != nullptr && page->owner.load(std::memory_order_relaxed) == heap)
+        {
+            block->next = page->local_free;
+            page->local_free = block;
+            return;
+        }
+
+        // Only the owner takes blocks off the remote list, and it takes all of them at once, so pushing cannot
+        // suffer from ABA
+        Block *head = page->remote_free.load(std::memory_order_relaxed);
+        do
+        {
+            block->next = head;
+        } while (!page->remote_free.compare_exchange_weak(head, block, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+    }
+
+    /// @brief Returns the number of pages that have been allocated so far.
+    static std::size_t numberOfPages()
+    {
+        Central &heap = central();
+        std::lock_guard<std::mutex> lock(heap.mutex);
+        return heap.number_of_pages;
+    }
+
+    /// @brief Returns the number of pages whose owner has exited and that no thread has adopted yet.
+    static std::size_t numberOfAbandonedPages()
+    {
+        Central &heap = central();
+        std::lock_guard<std::mutex> lock(heap.mutex);
+        std::size_t count = 0;
+        for (const Page *list : heap.abandoned)
+        {
+            for (const Page *page = list; page != nullptr; page = page->next)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+  private:
+    struct ThreadHeap;
+
+    /// @brief Free block, which stores the link to the next free block in its own memory.
+    struct Block
+    {
+        Block *next;
+    };
+
+    /// @brief Header at the start of every page. The remote free list sits on its own cache line, so that remote
+    /// frees do not invalidate the line that the owner allocates from.
+    struct alignas(64) Page
+    {
+        Block *local_free;
+        Page *next;
+        std::size_t size_class;
+        std::atomic<ThreadHeap *> owner;
+        alignas(64) std::atomic<Block *> remote_free;
+    };
+
+    /// @brief Pages of one thread, by size class. When the thread exits, they are abandoned to the central lists.
+    struct ThreadHeap
+    {
+        ~ThreadHeap()
+        {
+            thread_heap_ = nullptr;
+            thread_heap_destroyed_ = true;
+            Central &heap = central();
+            std::lock_guard<std::mutex> lock(heap.mutex);
+            for (std::size_t size_class = 0; size_class < number_of_size_classes; ++size_class)
+            {
+                while (Page *page = pages[size_class])
+                {
+                    pages[size_class] = page->next;
+                    page->owner.store(nullptr, std::memory_order_relaxed);
+                    page->next = heap.abandoned[size_class];
+                    heap.abandoned[size_class] = page;
+                }
+            }
+        }
+
+        std::array<Page *, number_of_size_classes> current = {};
+        std::array<Page *, number_of_size_classes> pages = {};
+    };
+
+    /// @brief Shared state of the heap: the abandoned pages, whose free lists are protected by the mutex.
+    struct Central
+    {
+        std::mutex mutex;
+        std::array<Page *, number_of_size_classes> abandoned = {};
+        std::size_t number_of_pages = 0;
+    };
+
+    /// @brief Finds a page with free blocks when the current page of the class has none. The current page's remote
+    /// frees are collected first, then those of the thread's other pages of the class, then an abandoned page is
+    /// adopted, and only then a new page is allocated.
+    __attribute__((noinline)) static void *allocateSlow(ThreadHeap *heap, std::size_t size_class)
+    {
+        if (heap == nullptr)
+        {
+            heap = threadHeap();
+            if (heap == nullptr)
+            {
+                return allocateWithoutHeap(size_class);
+            }
+        }
+
+        Page *page = heap->current[size_class];
+        if (page == nullptr || !collectRemoteFrees(page))
+        {
+            page = nullptr;
+            for (Page *candidate = heap->pages[size_class]; candidate != nullptr; candidate = candidate->next)
+            {
+                if (candidate->local_free != nullptr || collectRemoteFrees(candidate))
+                {
+                    page = candidate;
+                    break;
+                }
+            }
+        }
+        if (page == nullptr)
+        {
+            page = adoptAbandonedPage(heap, size_class);
+        }
+        if (page == nullptr)
+        {
+            page = newPage(size_class);
+            {
+                Central &central_heap = central();
+                std::lock_guard<std::mutex> lock(central_heap.mutex);
+                ++central_heap.number_of_pages;
+            }
+            page->owner.store(heap, std::memory_order_relaxed);
+            page->next = heap->pages[size_class];
+            heap->pages[size_class] = page;
+        }
+        heap->current[size_class] = page;
+
+        Block *block = page->local_free;
+        page->local_free = block->next;
+        return block;
+    }
+
+    /// @brief Moves the remote free list of the page to its local free list, which must be empty. Returns whether
+    /// any block was freed remotely.
+    static bool collectRemoteFrees(Page *page) noexcept
+    {
+        if (page->remote_free.load(std::memory_order_relaxed) == nullptr)
+        {
+            return false;
+        }
+        page->local_free = page->remote_free.exchange(nullptr, std::memory_order_acquire);
+        return true;
+    }
+
+    /// @brief Takes over an abandoned page of the class that has free blocks.
+    static Page *adoptAbandonedPage(ThreadHeap *heap, std::size_t size_class)
+    {
+        Central &central_heap = central();
+        std::lock_guard<std::mutex> lock(central_heap.mutex);
+        for (Page **link = &central_heap.abandoned[size_class]; *link != nullptr; link = &(*link)->next)
+        {
+            Page *page = *link;
+            if (page->local_free != nullptr || collectRemoteFrees(page))
+            {
+                *link = page->next;
+                page->owner.store(heap, std::memory_order_relaxed);
+                page->next = heap->pages[size_class];
+                heap->pages[size_class] = page;
+                return page;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Allocates a block while the thread is exiting and its heap is gone, from an abandoned page under the
+    /// central lock. A new page is abandoned right away.
+    static void *allocateWithoutHeap(std::size_t size_class)
+    {
+        Central &central_heap = central();
+        std::lock_guard<std::mutex> lock(central_heap.mutex);
+        Page *page = central_heap.abandoned[size_class];
+        while (page != nullptr && page->local_free == nullptr && !collectRemoteFrees(page))
+        {
+            page = page->next;
+        }
+        if (page == nullptr)
+        {
+            page = newPage(size_class);
+            ++central_heap.number_of_pages;
+            page->next = central_heap.abandoned[size_class];
+            central_heap.abandoned[size_class] = page;
+        }
+        Block *block = page->local_free;
+        page->local_free = block->next;
+        return block;
+    }
+
+    /// @brief Allocates a page and links all of its blocks into the local free list, starting at the first offset
+    /// after the header that keeps every block as aligned as its size class guarantees. The caller counts the page.
+    static Page *newPage(std::size_t size_class)
+    {
+        void *memory = ::operator new(remote_free_page_size, std::align_val_t{remote_free_page_size});
+        Page *page = ::new (memory) Page{nullptr, nullptr, size_class, {nullptr}, {nullptr}};
+
+        const std::size_t block_size = SlabHeap::blockSize(size_class);
+        const std::size_t block_alignment = std::min(block_size & (~block_size + 1), slab_alignment);
+        const std::size_t first = (sizeof(Page) + block_alignment - 1) & ~(block_alignment - 1);
+        const std::size_t count = (remote_free_page_size - first) / block_size;
+        auto *bytes = static_cast<std::byte *>(memory) + first;
+        for (std::size_t i = 0; i + 1 < count; ++i)
+        {
+            reinterpret_cast<Block *>(bytes + i * block_size)->next =
+                reinterpret_cast<Block *>(bytes + (i + 1) * block_size);
+        }
+        reinterpret_cast<Block *>(bytes + (count - 1) * block_size)->next = nullptr;
+        page->local_free = reinterpret_cast<Block *>(bytes);
+        return page;
+    }
+
+    static Page *pageOf(const Block *block) noexcept
+    {
+        return reinterpret_cast<Page *>(reinterpret_cast<std::uintptr_t>(block) & ~(remote_free_page_size - 1));
+    }
+
+    /// @brief Returns the shared state. It is intentionally never destroyed, so that threads exiting during static
+    /// destruction can still abandon their pages.
+    static Central &central()
+    {
+        static Central *heap = new Central();
+        return *heap;
+    }
+
+    /// @brief Creates the heap of the calling thread on first use and returns it, or nullptr if the thread is exiting
+    /// and it was destroyed.
+    static ThreadHeap *threadHeap() noexcept
+    {
+        if (thread_heap_destroyed_)
+        {
+            return nullptr;
+        }
+        thread_local ThreadHeap heap;
+        thread_heap_ = &heap;
+        return &heap;
+    }
+
+    /// @brief Heap of the calling thread once it was created. A plain pointer, so that the hot paths read it without
+    /// the initialization check of thread_local objects with a destructor.
+    static inline thread_local ThreadHeap *thread_heap_ = nullptr;
+    static inline thread_local bool thread_heap_destroyed_ = false;
+};
+
+/// @brief Polymorphic memory resource that allocates from the RemoteFreeHeap. Memory may be freed through any
+/// RemoteFreeResource, on any thread, and is returned to the allocating thread without locks.
+class RemoteFreeResource final : public std::pmr::memory_resource
+{
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return RemoteFreeHeap::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        RemoteFreeHeap::deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return dynamic_cast<const RemoteFreeResource *>(&other) != nullptr;
+    }
+};
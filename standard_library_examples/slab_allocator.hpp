@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>       // std::max, std::min
+#include <array>           // std::array
+#include <cstddef>         // std::max_align_t
+#include <cstdint>         // std::size_t, std::uint8_t
+#include <limits>          // std::numeric_limits
+#include <memory_resource> // std::pmr::memory_resource
+#include <mutex>           // std::mutex, std::lock_guard
+#include <new>             // std::align_val_t, std::bad_array_new_length
+#include <vector>          // std::vector
+
+/// @brief Alignment of every SlabHeap block, and the spacing of the smallest size classes.
+inline constexpr std::size_t slab_min_alignment = alignof(std::max_align_t);
+
+/// @brief Largest request, in bytes, that the SlabHeap serves from a size class.
+inline constexpr std::size_t slab_max_block_size = 4096;
+
+/// @brief Size of the slabs that SlabHeap blocks are carved from.
+inline constexpr std::size_t slab_size = 64 * 1024;
+
+/// @brief Alignment of the slabs, which bounds the alignment that a size class can guarantee.
+inline constexpr std::size_t slab_alignment = 4096;
+
+/// @brief Returns the block sizes of the SlabHeap size classes: multiples of 16 bytes up to 128 bytes, followed by
+/// four evenly spaced classes per doubling, which keeps the padding below 25 %. A request that is padded to a
+/// multiple of its alignment always lands in a class whose block size is a multiple of that alignment too.
+constexpr std::array<std::size_t, 28> makeSlabBlockSizes()
+{
+    std::array<std::size_t, 28> block_sizes{};
+    std::size_t index = 0;
+    for (std::size_t size = slab_min_alignment; size <= 128; size += slab_min_alignment)
+    {
+        block_sizes[index++] = size;
+    }
+    for (std::size_t power = 128; power < slab_max_block_size; power *= 2)
+    {
+        for (std::size_t step = 1; step <= 4; ++step)
+        {
+            block_sizes[index++] = power + step * (power / 4);
+        }
+    }
+    return block_sizes;
+}
+
+inline constexpr std::array<std::size_t, 28> slab_block_sizes = makeSlabBlockSizes();
+
+/// @brief Maps a padded request size, in units of slab_min_alignment, to the smallest size class that holds it.
+constexpr std::array<std::uint8_t, slab_max_block_size / slab_min_alignment + 1> makeSlabSizeClassLookup()
+{
+    std::array<std::uint8_t, slab_max_block_size / slab_min_alignment + 1> lookup{};
+    std::size_t size_class = 0;
+    for (std::size_t units = 0; units < lookup.size(); ++units)
+    {
+        while (slab_block_sizes[size_class] < units * slab_min_alignment)
+        {
+            ++size_class;
+        }
+        lookup[units] = static_cast<std::uint8_t>(size_class);
+    }
+    return lookup;
+}
+
+inline constexpr auto slab_size_class_lookup = makeSlabSizeClassLookup();
+
+/// @brief SlabHeap is a process-wide small object heap built from size classes. Requests of up to
+/// slab_max_block_size bytes are rounded up to one of 28 size classes, and every thread keeps an intrusive free list
+/// of blocks per class, so allocating and freeing is a thread-local pointer pop or push without locks or atomics.
+/// Blocks are carved from 64 KiB slabs. A thread that frees more blocks of a class than it needs, e.g. because
+/// another thread allocated them, hands a batch of them to the central depot of the class, and a thread that runs
+/// out of blocks takes a batch from the depot before it carves a new slab. Slabs are never returned to the operating
+/// system. Larger or more strictly aligned requests are forwarded to ::operator new.
+class SlabHeap final
+{
+  public:
+    /// @brief Number of size classes.
+    static constexpr std::size_t number_of_size_classes = slab_block_sizes.size();
+
+    /// @brief Allocates memory for bytes bytes with the given alignment.
+    /// @param bytes Size of the requested memory in bytes.
+    /// @param alignment Alignment of the requested memory, a power of two.
+    /// @return Pointer to the allocated memory.
+    /// @throws std::bad_alloc if the memory cannot be allocated.
+    static void *allocate(std::size_t bytes, std::size_t alignment = slab_min_alignment)
+    {
+        const std::size_t size_class = sizeClass(bytes, alignment);
+        if (size_class == number_of_size_classes)
+        {
+            return ::operator new(bytes, std::align_val_t{alignment});
+        }
+
+        ThreadCache *cache = threadCache();
+        if (cache == nullptr)
+        {
+            // The thread is exiting and its cache is gone, so a single block goes through the depot
+            Batch batch = central().takeBatch(size_class);
+            Block *block = batch.head;
+            central().giveBatch(size_class, {block->next, batch.count - 1});
+            return block;
+        }
+
+        FreeList &list = cache->lists[size_class];
+        if (list.head == nullptr)
+        {
+            const Batch batch = central().takeBatch(size_class);
+            list.head = batch.head;
+            list.count = batch.count;
+        }
+        Block *block = list.head;
+        list.head = block->next;
+        --list.count;
+        return block;
+    }
+
+    /// @brief Returns memory obtained from allocate with the same bytes and alignment, from any thread.
+    /// @param pointer Pointer to the memory to free.
+    /// @param bytes Size of the memory in bytes, as passed to allocate.
+    /// @param alignment Alignment of the memory, as passed to allocate.
+    static void deallocate(void *pointer, std::size_t bytes, std::size_t alignment = slab_min_alignment) noexcept
+    {
+        const std::size_t size_class = sizeClass(bytes, alignment);
+        if (size_class == number_of_size_classes)
+        {
+            ::operator delete(pointer, std::align_val_t{alignment});
+            return;
+        }
+
+        Block *block = static_cast<Block *>(pointer);
+        ThreadCache *cache = threadCache();
+        if (cache == nullptr)
+        {
+            block->next = nullptr;
+            central().giveBatch(size_class, {block, 1});
+            return;
+        }
+
+        FreeList &list = cache->lists[size_class];
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+
+        // Keep one batch for future allocations and hand the surplus to the threads that allocate from the depot
+        const std::size_t batch_size = batchSize(size_class);
+        if (list.count > 2 * batch_size)
+        {
+            Block *first = list.head;
+            Block *last = first;
+            for (std::size_t i = 1; i < batch_size; ++i)
+            {
+                last = last->next;
+            }
+            list.head = last->next;
+            list.count -= batch_size;
+            last->next = nullptr;
+            central().giveBatch(size_class, {first, batch_size});
+        }
+    }
+
+    /// @brief Returns the size class that serves the request, or number_of_size_classes if it is forwarded to
+    /// ::operator new. The request is padded to a multiple of its alignment, which makes it land in a class whose
+    /// block size, and thus every block offset inside the slab, is a multiple of the alignment.
+    static constexpr std::size_t sizeClass(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        alignment = std::max(alignment, slab_min_alignment);
+        if (alignment > slab_alignment || bytes > slab_max_block_size)
+        {
+            return number_of_size_classes;
+        }
+        bytes = (std::max<std::size_t>(bytes, 1) + alignment - 1) & ~(alignment - 1);
+        if (bytes > slab_max_block_size)
+        {
+            return number_of_size_classes;
+        }
+        return slab_size_class_lookup[bytes / slab_min_alignment];
+    }
+
+    /// @brief Returns the block size of the size class in bytes.
+    static constexpr std::size_t blockSize(std::size_t size_class) noexcept
+    {
+        return slab_block_sizes[size_class];
+    }
+
+    /// @brief Returns the number of slabs that have been carved so far.
+    static std::size_t numberOfSlabs()
+    {
+        Central &heap = central();
+        std::lock_guard<std::mutex> lock(heap.slabs_mutex);
+        return heap.slabs.size();
+    }
+
+  private:
+    /// @brief Free block, which stores the link to the next free block in its own memory.
+    struct Block
+    {
+        Block *next;
+    };
+
+    /// @brief Chain of free blocks owned by one thread.
+    struct FreeList
+    {
+        Block *head = nullptr;
+        std::size_t count = 0;
+    };
+
+    /// @brief Null-terminated chain of free blocks that moves between a thread and the depot as a whole.
+    struct Batch
+    {
+        Block *head;
+        std::size_t count;
+    };
+
+    /// @brief Free blocks of one size class that are not owned by any thread.
+    struct Depot
+    {
+        std::mutex mutex;
+        std::vector<Batch> batches;
+    };
+
+    /// @brief Shared state of the heap: the depots and the slabs that all blocks are carved from.
+    struct Central
+    {
+        /// @brief Takes a batch of free blocks from the depot, or carves a new slab into one if the depot is empty.
+        Batch takeBatch(std::size_t size_class)
+        {
+            Depot &depot = depots[size_class];
+            {
+                std::lock_guard<std::mutex> lock(depot.mutex);
+                if (!depot.batches.empty())
+                {
+                    const Batch batch = depot.batches.back();
+                    depot.batches.pop_back();
+                    return batch;
+                }
+            }
+            return carveSlab(size_class);
+        }
+
+        /// @brief Hands a batch of free blocks to the depot.
+        void giveBatch(std::size_t size_class, Batch batch) noexcept
+        {
+            if (batch.count == 0)
+            {
+                return;
+            }
+            Depot &depot = depots[size_class];
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            try
+            {
+                depot.batches.push_back(batch);
+            }
+            catch (...)
+            {
+                // Without room to record the batch its blocks are leaked rather than reused
+            }
+        }
+
+        /// @brief Allocates a slab and links all of its blocks into one batch.
+        Batch carveSlab(std::size_t size_class)
+        {
+            void *slab = ::operator new(slab_size, std::align_val_t{slab_alignment});
+            {
+                std::lock_guard<std::mutex> lock(slabs_mutex);
+                try
+                {
+                    slabs.push_back(slab);
+                }
+                catch (...)
+                {
+                    ::operator delete(slab, std::align_val_t{slab_alignment});
+                    throw;
+                }
+            }
+
+            const std::size_t block_size = blockSize(size_class);
+            const std::size_t count = slab_size / block_size;
+            auto *bytes = static_cast<unsigned char *>(slab);
+            for (std::size_t i = 0; i + 1 < count; ++i)
+            {
+                reinterpret_cast<Block *>(bytes + i * block_size)->next =
+                    reinterpret_cast<Block *>(bytes + (i + 1) * block_size);
+            }
+            reinterpret_cast<Block *>(bytes + (count - 1) * block_size)->next = nullptr;
+            return {reinterpret_cast<Block *>(bytes), count};
+        }
+
+        std::array<Depot, number_of_size_classes> depots;
+        std::mutex slabs_mutex;
+        std::vector<void *> slabs;
+    };
+
+    /// @brief Free lists of one thread. When the thread exits, its free blocks are handed to the depots.
+    struct ThreadCache
+    {
+        ~ThreadCache()
+        {
+            thread_cache_destroyed_ = true;
+            for (std::size_t size_class = 0; size_class < number_of_size_classes; ++size_class)
+            {
+                central().giveBatch(size_class, {lists[size_class].head, lists[size_class].count});
+            }
+        }
+
+        std::array<FreeList, number_of_size_classes> lists;
+    };
+
+    /// @brief Returns the number of blocks that move between a thread and the depot at once, about 8 KiB worth.
+    static constexpr std::size_t batchSize(std::size_t size_class) noexcept
+    {
+        return std::min<std::size_t>(64, std::max<std::size_t>(4, 8192 / blockSize(size_class)));
+    }
+
+    /// @brief Returns the shared state. It is intentionally never destroyed, so that containers with static storage
+    /// duration can still free their memory while the program exits.
+    static Central &central()
+    {
+        static Central *heap = new Central();
+        return *heap;
+    }
+
+    /// @brief Returns the cache of the calling thread, or nullptr if the thread is exiting and it was destroyed.
+    static ThreadCache *threadCache() noexcept
+    {
+        if (thread_cache_destroyed_)
+        {
+            return nullptr;
+        }
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    static inline thread_local bool thread_cache_destroyed_ = false;
+};
+
+/// @brief Standard allocator that allocates from the SlabHeap. All SlabAllocators share the heap, so they always
+/// compare equal and memory can be freed through any of them, on any thread.
+/// @tparam T Type of the allocated objects
+template <typename T> struct SlabAllocator
+{
+    using value_type = T;
+
+    SlabAllocator() = default;
+
+    template <typename U> SlabAllocator(const SlabAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T *>(SlabHeap::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        SlabHeap::deallocate(p, n * sizeof(T), alignof(T));
+    }
+};
+
+template <typename T, typename U> bool operator==(const SlabAllocator<T> &, const SlabAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U> bool operator!=(const SlabAllocator<T> &, const SlabAllocator<U> &)
+{
+    return false;
+}
+
+/// @brief Polymorphic memory resource that allocates from the SlabHeap. Unlike std::pmr::synchronized_pool_resource,
+/// it does not lock on the fast path, and memory may be freed through any SlabResource, on any thread.
+class SlabResource final : public std::pmr::memory_resource
+{
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return SlabHeap::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        SlabHeap::deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return dynamic_cast<const SlabResource *>(&other) != nullptr;
+    }
+};
@@ -0,0 +1,110 @@
+#include "small_vector.hpp"
+
+#include <chrono>   // std::chrono::high_resolution_clock
+#include <cstdint>  // std::size_t
+#include <iostream> // std::cout
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+/// @brief Allocator that counts the heap allocations made through it.
+template <typename T> struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U> CountingAllocator(const CountingAllocator<U> &)
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        ++allocations;
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        ::operator delete(p);
+    }
+
+    static inline std::size_t allocations = 0;
+};
+
+template <typename T, typename U> bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U> bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return false;
+}
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief Builds and sums a short-lived vector of the given size many times.
+template <typename Vector> double benchmarkPushBack(const std::size_t number_of_elements)
+{
+    constexpr std::size_t number_of_pushed_elements = 10'000'000;
+    const std::size_t number_of_iterations = number_of_pushed_elements / number_of_elements;
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        Vector vector;
+        for (std::size_t i = 0; i < number_of_elements; ++i)
+        {
+            vector.push_back(static_cast<int>(i));
+        }
+        doNotOptimize(vector);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    using CountedSmallVector = SmallVector<std::string, 4, CountingAllocator<std::string>>;
+
+    // Up to 4 elements live inline and do not touch the allocator
+    CountedSmallVector words = {"one", "two", "three"};
+    words.push_back("four");
+    std::cout << "Inline: " << words.is_inline() << ", capacity: " << words.capacity()
+              << ", allocations: " << CountingAllocator<std::string>::allocations << std::endl;
+
+    // The fifth element spills to the heap instead of throwing
+    words.push_back("five");
+    words.insert(words.begin(), "zero");
+    std::cout << "Inline: " << words.is_inline() << ", capacity: " << words.capacity()
+              << ", allocations: " << CountingAllocator<std::string>::allocations << std::endl;
+
+    for (const auto &word : words)
+    {
+        std::cout << word << " ";
+    }
+    std::cout << std::endl;
+
+    // Erasing and shrinking moves the elements back into the inline buffer
+    words.erase(words.begin(), words.begin() + 3);
+    words.shrink_to_fit();
+    std::cout << "Inline: " << words.is_inline() << ", size: " << words.size() << ", front: " << words.front()
+              << ", back: " << words.back() << std::endl;
+
+    constexpr std::size_t inline_capacity = 16;
+    for (const std::size_t number_of_elements : {4UL, 16UL, 64UL, 1024UL})
+    {
+        std::cout << "Elapsed time (std::vector, " << number_of_elements
+                  << " elements): " << benchmarkPushBack<std::vector<int>>(number_of_elements) << std::endl;
+        std::cout << "Elapsed time (SmallVector<" << inline_capacity << ">, " << number_of_elements
+                  << " elements): " << benchmarkPushBack<SmallVector<int, inline_capacity>>(number_of_elements)
+                  << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,666 @@
+#pragma once
+
+#include <algorithm>        // std::move_backward, std::max
+#include <cstddef>          // std::ptrdiff_t, std::byte
+#include <cstdint>          // std::size_t
+#include <cstring>          // std::memcpy, std::memmove
+#include <initializer_list> // std::initializer_list
+#include <iterator>         // std::reverse_iterator, std::distance
+#include <memory>           // std::allocator, std::allocator_traits, std::uninitialized_move, std::destroy
+#include <new>              // placement new, std::launder
+#include <stdexcept>        // std::out_of_range, std::underflow_error
+#include <type_traits>      // std::is_trivially_copyable_v
+#include <utility>          // std::move, std::swap
+
+/// @brief SmallVector is a resizable vector with small buffer optimization. Up to N elements are stored inline like
+/// in StackVector; once the inline buffer is exhausted the elements are transparently moved to heap storage obtained
+/// from the allocator, which then grows geometrically. Unlike StackVector, no mutator throws on reaching N.
+/// @tparam T Type of the values
+/// @tparam N Number of elements stored inline
+/// @tparam Allocator Allocator used for the heap storage once the inline buffer is exhausted
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>> class SmallVector final
+{
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+  public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(std::is_same_v<typename allocator_traits::pointer, pointer>,
+                  "SmallVector requires an allocator with raw pointers");
+
+    /// @brief Default constructor of the SmallVector class.
+    /// @param allocator Allocator used once the inline buffer is exhausted.
+    explicit SmallVector(const Allocator &allocator = Allocator())
+        : allocator_(allocator), data_(inlineData()), size_(0), capacity_(N)
+    {
+    }
+
+    /// @brief Destructor of the SmallVector class, destroys all elements and releases heap storage.
+    ~SmallVector()
+    {
+        clear();
+        releaseHeap();
+    }
+
+    /// @brief Constructor of the SmallVector class from the initializer list.
+    /// @param initializer_list initializer list to copy data from to the SmallVector's data.
+    /// @param allocator Allocator used once the inline buffer is exhausted.
+    SmallVector(std::initializer_list<T> initializer_list, const Allocator &allocator = Allocator())
+        : SmallVector(allocator)
+    {
+        reserve(initializer_list.size());
+        std::uninitialized_copy(initializer_list.begin(), initializer_list.end(), data_);
+        size_ = initializer_list.size();
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The object to copy data from.
+    SmallVector(const SmallVector &other)
+        : SmallVector(allocator_traits::select_on_container_copy_construction(other.allocator_))
+    {
+        reserve(other.size_);
+        copyElements(other.data_, other.size_, data_);
+        size_ = other.size_;
+    }
+
+    /// @brief Copy assignment operator.
+    /// @param other The object to copy data from.
+    /// @return This SmallVector holding copies of the other SmallVector's elements.
+    SmallVector &operator=(const SmallVector &other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        if constexpr (allocator_traits::propagate_on_container_copy_assignment::value)
+        {
+            if (allocator_ != other.allocator_)
+            {
+                releaseHeap();
+            }
+            allocator_ = other.allocator_;
+        }
+        reserve(other.size_);
+        copyElements(other.data_, other.size_, data_);
+        size_ = other.size_;
+
+        return *this;
+    }
+
+    /// @brief Move constructor. Heap storage is stolen, inline elements are moved one by one.
+    /// @param other Other SmallVector to move data from.
+    SmallVector(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallVector(other.allocator_)
+    {
+        takeElements(other);
+    }
+
+    /// @brief Move operator.
+    /// @param other Other SmallVector to move data from.
+    /// @return This SmallVector holding the other SmallVector's elements.
+    SmallVector &operator=(SmallVector &&other) noexcept(
+        std::is_nothrow_move_constructible_v<T> &&
+        (allocator_traits::propagate_on_container_move_assignment::value || allocator_traits::is_always_equal::value))
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+        {
+            releaseHeap();
+            allocator_ = std::move(other.allocator_);
+        }
+        takeElements(other);
+
+        return *this;
+    }
+
+    /// @brief Swap data between two SmallVector objects.
+    /// @param other Other SmallVector to exchange data with.
+    void swap(SmallVector &other)
+    {
+        SmallVector temporary(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temporary);
+    }
+
+    /// @brief Returns the allocator used for heap storage.
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_;
+    }
+
+    /// @brief Returns whether the SmallVector is empty.
+    /// @return True if empty, else False
+    bool empty() const noexcept
+    {
+        return (size_ == 0UL);
+    }
+
+    /// @brief Gets the number of elements in the SmallVector.
+    /// @return Current data size.
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /// @brief Gets the number of elements the SmallVector can hold before it has to grow.
+    /// @return Current capacity, at least N.
+    size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    /// @brief Gets the number of elements stored inline before spilling to the heap.
+    /// @return Inline capacity N.
+    static constexpr size_type inline_capacity() noexcept
+    {
+        return N;
+    }
+
+    /// @brief Returns whether the elements currently live in the inline buffer.
+    /// @return True if no heap storage is in use, else False
+    bool is_inline() const noexcept
+    {
+        return data_ == inlineData();
+    }
+
+    /// @brief Get the maximum number of elements the allocator can provide.
+    /// @return Maximum number of elements that SmallVector can hold
+    size_type max_size() const noexcept
+    {
+        return std::max<size_type>(N, allocator_traits::max_size(allocator_));
+    }
+
+    /// @brief Destroys all elements and resizes SmallVector to 0, keeping the current storage.
+    void clear() noexcept
+    {
+        std::destroy(begin(), end());
+        size_ = 0UL;
+    }
+
+    /// @brief Makes sure the SmallVector can hold at least the given number of elements without growing.
+    /// @param new_capacity Requested capacity.
+    void reserve(size_type new_capacity)
+    {
+        if (new_capacity > capacity_)
+        {
+            reallocate(new_capacity);
+        }
+    }
+
+    /// @brief Releases unused heap capacity, moving the elements back inline if they fit.
+    void shrink_to_fit()
+    {
+        if (is_inline() || size_ == capacity_)
+        {
+            return;
+        }
+
+        pointer old_data = data_;
+        size_type old_capacity = capacity_;
+        if (size_ <= N)
+        {
+            data_ = inlineData();
+            capacity_ = N;
+        }
+        else
+        {
+            data_ = allocator_traits::allocate(allocator_, size_);
+            capacity_ = size_;
+        }
+        relocateElements(old_data, size_, data_);
+        allocator_traits::deallocate(allocator_, old_data, old_capacity);
+    }
+
+    /// @brief Add a value to the end of SmallVector
+    /// @param value Value to be copied
+    void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    /// @brief Move a value to the end of the SmallVector.
+    /// @param value Value to be moved.
+    void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    /// @brief Construct a value in place at the end of the SmallVector, growing the storage if it is full.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the constructed element.
+    template <typename... Args> reference emplace_back(Args &&...args)
+    {
+        if (size_ < capacity_)
+        {
+            pointer element = ::new (static_cast<void *>(data_ + size_)) T(std::forward<Args>(args)...);
+            ++size_;
+            return *element;
+        }
+        return emplaceBackGrow(std::forward<Args>(args)...);
+    }
+
+    /// @brief Construct and insert element at the specified position of the SmallVector.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param pos Random access iterator position that points to the insertion position in the SmallVector.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Iterator pointing to the inserted element; storage may have moved.
+    /// @throws std::out_of_range if the invalid iterator position was provided.
+    template <typename... Args> iterator emplace(const_iterator pos, Args &&...args)
+    {
+        if (pos < begin() || pos > end())
+        {
+            throw std::out_of_range("Invalid iterator position");
+        }
+
+        const size_type index = static_cast<size_type>(pos - cbegin());
+        if (index == size_)
+        {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        // Construct first: the arguments may refer to elements that are about to be shifted or reallocated
+        T value(std::forward<Args>(args)...);
+        if (size_ == capacity_)
+        {
+            reallocate(grownCapacity(size_ + 1));
+        }
+        return insertShifted(begin() + index, std::move(value));
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the SmallVector where the new element is inserted provided as a random access iterator.
+    /// @param value Value to be copied to the inserted element.
+    /// @return Iterator pointing to the inserted element; storage may have moved.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    iterator insert(const_iterator pos, const T &value)
+    {
+        return emplace(pos, value);
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the SmallVector where the new element is inserted provided as a random access iterator.
+    /// @param value Value to be moved to the inserted element.
+    /// @return Iterator pointing to the inserted element; storage may have moved.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    iterator insert(const_iterator pos, T &&value)
+    {
+        return emplace(pos, std::move(value));
+    }
+
+    /// @brief Remove one element from the end of the SmallVector.
+    /// @throws std::underflow_error if the SmallVector is empty.
+    void pop_back()
+    {
+        if (empty())
+        {
+            throw std::underflow_error("SmallVector is empty");
+        }
+        --size_;
+        std::destroy_at(data_ + size_);
+    }
+
+    /// @brief Removes from the SmallVector a single element.
+    /// @param pos Random access iterator position corresponding to the element to be removed.
+    /// @return Iterator following the removed element.
+    /// @throws std::out_of_range if invalid position is provided.
+    iterator erase(const_iterator pos)
+    {
+        if (pos < begin() || pos >= end())
+        {
+            throw std::out_of_range("Invalid iterator position");
+        }
+        return erase(pos, pos + 1);
+    }
+
+    /// @brief Removes from the SmallVector a range of elements [first, last).
+    /// @param first Random access iterator type to the first element to be removed.
+    /// @param last Random access iterator type to last non-inclusive element.
+    /// @return Iterator following the removed elements.
+    /// @throws std::out_of_range if invalid position is provided.
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        if (first < begin() || first > last || last > end())
+        {
+            throw std::out_of_range("Invalid iterator range");
+        }
+
+        iterator mutable_first = begin() + (first - cbegin());
+        iterator mutable_last = begin() + (last - cbegin());
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memmove(static_cast<void *>(mutable_first), static_cast<const void *>(mutable_last),
+                         static_cast<size_type>(end() - mutable_last) * sizeof(T));
+        }
+        else
+        {
+            iterator new_end = std::move(mutable_last, end(), mutable_first);
+            std::destroy(new_end, end());
+        }
+        size_ -= std::distance(first, last);
+
+        return mutable_first;
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Non-const reference to the element in the data.
+    reference operator[](size_type index) noexcept
+    {
+        return data_[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Const reference to the element in the data.
+    const_reference operator[](size_type index) const noexcept
+    {
+        return data_[index];
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Non-const reference to the element in the data.
+    /// @throws std::out_of_range If the index is out of range.
+    reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+        return data_[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the SmallVector.
+    /// @return Const reference to the element in the data.
+    /// @throws std::out_of_range If the index is out of range.
+    const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+        return data_[index];
+    }
+
+    /// @brief Direct access to the underlying element storage, inline or heap.
+    /// @return Non-const pointer to the first element.
+    pointer data() noexcept
+    {
+        return data_;
+    }
+
+    /// @brief Direct access to the underlying element storage, inline or heap.
+    /// @return Const pointer to the first element.
+    const_pointer data() const noexcept
+    {
+        return data_;
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the SmallVector.
+    iterator begin() noexcept
+    {
+        return data_;
+    }
+
+    /// @brief Returns a const iterator pointing to the first element in the SmallVector.
+    const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+
+    /// @brief Returns a const iterator pointing to the first element in the SmallVector.
+    const_iterator cbegin() const noexcept
+    {
+        return data_;
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the SmallVector.
+    iterator end() noexcept
+    {
+        return data_ + size_;
+    }
+
+    /// @brief Returns a const iterator referring to the element one past the end position of the SmallVector.
+    const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    /// @brief Returns a const iterator referring to the element one past the end position of the SmallVector.
+    const_iterator cend() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    /// @brief Returns a reverse iterator pointing to the last element in the SmallVector.
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the last element in the SmallVector.
+    const_reverse_iterator crbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    /// @brief Returns a reverse iterator pointing to the before the start element in the SmallVector.
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the before the start element in the SmallVector.
+    const_reverse_iterator crend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    /// @brief Returns the non-const reference to the first element in the SmallVector.
+    /// @throws std::out_of_range if the SmallVector is empty.
+    reference front()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("SmallVector is empty");
+        }
+        return data_[0];
+    }
+
+    /// @brief Returns the const reference to the first element in the SmallVector.
+    /// @throws std::out_of_range if the SmallVector is empty.
+    const_reference front() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("SmallVector is empty");
+        }
+        return data_[0];
+    }
+
+    /// @brief Returns the non-const reference to the last element in the SmallVector.
+    /// @throws std::out_of_range if the SmallVector is empty.
+    reference back()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("SmallVector is empty");
+        }
+        return data_[size_ - 1];
+    }
+
+    /// @brief Returns the const reference to the last element in the SmallVector.
+    /// @throws std::out_of_range if the SmallVector is empty.
+    const_reference back() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("SmallVector is empty");
+        }
+        return data_[size_ - 1];
+    }
+
+  private:
+    pointer inlineData() noexcept
+    {
+        return std::launder(reinterpret_cast<pointer>(inline_storage_));
+    }
+
+    const_pointer inlineData() const noexcept
+    {
+        return std::launder(reinterpret_cast<const_pointer>(inline_storage_));
+    }
+
+    /// @brief Returns the capacity to grow to so that at least the required number of elements fit.
+    size_type grownCapacity(size_type required) const noexcept
+    {
+        return std::max(required, capacity_ + capacity_ / 2 + 1);
+    }
+
+    /// @brief Copy constructs count elements from source into uninitialized destination.
+    static void copyElements(const_pointer source, size_type count, pointer destination)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memcpy(static_cast<void *>(destination), static_cast<const void *>(source), count * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_copy(source, source + count, destination);
+        }
+    }
+
+    /// @brief Moves count elements from source into uninitialized destination and destroys the sources.
+    static void relocateElements(pointer source, size_type count, pointer destination)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memcpy(static_cast<void *>(destination), static_cast<const void *>(source), count * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_move(source, source + count, destination);
+            std::destroy(source, source + count);
+        }
+    }
+
+    /// @brief Deallocates the heap storage, if any, and points the SmallVector back to its inline buffer. The
+    /// SmallVector must be empty.
+    void releaseHeap() noexcept
+    {
+        if (!is_inline())
+        {
+            allocator_traits::deallocate(allocator_, data_, capacity_);
+            data_ = inlineData();
+            capacity_ = N;
+        }
+    }
+
+    /// @brief Moves the elements into heap storage of the given capacity.
+    void reallocate(size_type new_capacity)
+    {
+        pointer new_data = allocator_traits::allocate(allocator_, new_capacity);
+        relocateElements(data_, size_, new_data);
+        if (!is_inline())
+        {
+            allocator_traits::deallocate(allocator_, data_, capacity_);
+        }
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    /// @brief Slow path of emplace_back: grows the storage geometrically and constructs the new element.
+    template <typename... Args> reference emplaceBackGrow(Args &&...args)
+    {
+        const size_type new_capacity = grownCapacity(size_ + 1);
+        pointer new_data = allocator_traits::allocate(allocator_, new_capacity);
+
+        // Construct the new element before relocating: the arguments may refer to existing elements
+        pointer element = new_data + size_;
+        try
+        {
+            ::new (static_cast<void *>(element)) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            allocator_traits::deallocate(allocator_, new_data, new_capacity);
+            throw;
+        }
+
+        relocateElements(data_, size_, new_data);
+        if (!is_inline())
+        {
+            allocator_traits::deallocate(allocator_, data_, capacity_);
+        }
+        data_ = new_data;
+        capacity_ = new_capacity;
+        ++size_;
+        return *element;
+    }
+
+    /// @brief Opens a gap at a position before end() and moves the value into it. Capacity must be available.
+    iterator insertShifted(iterator pos, T &&value)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memmove(static_cast<void *>(pos + 1), static_cast<const void *>(pos),
+                         static_cast<size_type>(end() - pos) * sizeof(T));
+            ::new (static_cast<void *>(pos)) T(std::move(value));
+        }
+        else
+        {
+            ::new (static_cast<void *>(end())) T(std::move(*(end() - 1)));
+            std::move_backward(pos, end() - 1, end());
+            *pos = std::move(value);
+        }
+        ++size_;
+        return pos;
+    }
+
+    /// @brief Takes over the elements of the other SmallVector, which is left empty. This SmallVector must be empty.
+    void takeElements(SmallVector &other)
+    {
+        if (!other.is_inline() && allocator_ == other.allocator_)
+        {
+            releaseHeap();
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            other.data_ = other.inlineData();
+            other.capacity_ = N;
+            other.size_ = 0;
+            return;
+        }
+
+        reserve(other.size_);
+        relocateElements(other.data_, other.size_, data_);
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    Allocator allocator_;
+    pointer data_;
+    size_type size_;
+    size_type capacity_;
+    alignas(T) std::byte inline_storage_[sizeof(T) * (N > 0 ? N : 1)];
+};
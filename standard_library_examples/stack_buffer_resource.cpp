@@ -0,0 +1,174 @@
+#include "stack_buffer_resource.hpp"
+
+#include <algorithm>       // std::max, std::sort
+#include <chrono>          // std::chrono::high_resolution_clock
+#include <cstdint>         // std::size_t
+#include <iostream>        // std::cout
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::get_default_resource, std::pmr::new_delete_resource
+#include <string>          // std::pmr::string, std::to_string
+#include <vector>          // std::pmr::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_iterations = 1'000'000;
+
+/// @brief Formats a log line from several parts into a temporary string, as done for every message of a logger.
+std::size_t formatLogLine(std::pmr::memory_resource *resource, const std::size_t line_no)
+{
+    std::pmr::string line(resource);
+    line += "[worker ";
+    line += std::to_string(line_no % 16);
+    line += "] request ";
+    line += std::to_string(line_no);
+    line += " finished after ";
+    line += std::to_string(line_no % 1000);
+    line += " microseconds";
+    return line.size();
+}
+
+/// @brief Collects a handful of values into a temporary vector that grows element by element, sorts it and returns
+/// the median.
+int collectMedian(std::pmr::memory_resource *resource, const std::size_t seed)
+{
+    std::pmr::vector<int> values(resource);
+    const std::size_t count = 4 + seed % 13;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        values.push_back(static_cast<int>((seed * 7919 + i * 104729) % 1000));
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/// @brief Upstream resource that counts the blocks it hands out and takes back.
+class CountingResource final : public std::pmr::memory_resource
+{
+  public:
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/// @brief Check: a zero-byte request on an exactly full buffer goes upstream, and so does its free, instead of getting
+/// the end address of the buffer, whose free would wrongly go upstream.
+bool testZeroByteAllocationWhenFull()
+{
+    CountingResource upstream;
+    StackBufferResource<64> buffer(&upstream);
+    void *full = buffer.allocate(64, 1);
+    void *empty = buffer.allocate(0, 1);
+    buffer.deallocate(empty, 0, 1);
+    buffer.deallocate(full, 64, 1);
+    return upstream.allocations == upstream.deallocations;
+}
+
+/// @brief Runs the workload with the temporaries allocating from the default resource.
+template <typename Workload> double benchmarkDefaultResource(Workload workload)
+{
+    std::size_t checksum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < number_of_iterations; ++i)
+    {
+        checksum += workload(std::pmr::get_default_resource(), i);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(checksum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Runs the workload with the temporaries allocating from a StackBufferResource on the stack of every call.
+template <std::size_t Bytes, typename Workload>
+double benchmarkStackBuffer(Workload workload, StackBufferStatistics &totals)
+{
+    std::size_t checksum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < number_of_iterations; ++i)
+    {
+        StackBufferResource<Bytes> buffer;
+        checksum += workload(&buffer, i);
+        totals.overflow_allocations += buffer.statistics().overflow_allocations;
+        totals.reclaimed_frees += buffer.statistics().reclaimed_frees;
+        totals.peak_buffer_bytes = std::max(totals.peak_buffer_bytes, buffer.statistics().peak_buffer_bytes);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(checksum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Prints the totals of the overflow statistics.
+void printStatistics(const StackBufferStatistics &totals)
+{
+    std::cout << "Overflow allocations: " << totals.overflow_allocations
+              << ", reclaimed frees: " << totals.reclaimed_frees << ", peak buffer bytes: " << totals.peak_buffer_bytes
+              << std::endl;
+}
+
+int main()
+{
+    if (!testZeroByteAllocationWhenFull())
+    {
+        std::cout << "StackBufferResource freed a buffer block upstream" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    {
+        StackBufferResource<256> buffer;
+        std::pmr::vector<int> numbers({1, 2, 3, 4}, &buffer);
+        std::pmr::string name("a string that is too long for the small string buffer", &buffer);
+        for (int i = 5; i <= 100; ++i)
+        {
+            // The vector soon outgrows the rest of the buffer and continues on the heap
+            numbers.push_back(i);
+        }
+        const StackBufferStatistics &statistics = buffer.statistics();
+        std::cout << "Buffer allocations: " << statistics.buffer_allocations
+                  << ", overflow allocations: " << statistics.overflow_allocations
+                  << ", overflow bytes: " << statistics.overflow_bytes << std::endl;
+    }
+
+    const auto format_log_line = [](std::pmr::memory_resource *resource, std::size_t i) {
+        return formatLogLine(resource, i);
+    };
+    const auto collect_median = [](std::pmr::memory_resource *resource, std::size_t i) {
+        return static_cast<std::size_t>(collectMedian(resource, i));
+    };
+
+    std::cout << "Elapsed time (string building, default resource): " << benchmarkDefaultResource(format_log_line)
+              << std::endl;
+    StackBufferStatistics string_totals;
+    std::cout << "Elapsed time (string building, StackBufferResource<512>): "
+              << benchmarkStackBuffer<512>(format_log_line, string_totals) << std::endl;
+    printStatistics(string_totals);
+
+    std::cout << "Elapsed time (small vectors, default resource): " << benchmarkDefaultResource(collect_median)
+              << std::endl;
+    StackBufferStatistics vector_totals;
+    std::cout << "Elapsed time (small vectors, StackBufferResource<256>): "
+              << benchmarkStackBuffer<256>(collect_median, vector_totals) << std::endl;
+    printStatistics(vector_totals);
+
+    return EXIT_SUCCESS;
+}
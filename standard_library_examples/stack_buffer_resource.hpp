@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>       // std::max
+#include <cstddef>         // std::byte, std::max_align_t
+#include <cstdint>         // std::size_t, std::uintptr_t
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::get_default_resource
+
+/// @brief Counters of a StackBufferResource.
+struct StackBufferStatistics
+{
+    /// @brief Allocations served from the inline buffer.
+    std::size_t buffer_allocations = 0;
+    /// @brief Frees of the most recent buffer allocation, whose memory was reused in place.
+    std::size_t reclaimed_frees = 0;
+    /// @brief Highest number of bytes of the inline buffer in use at once, including alignment padding.
+    std::size_t peak_buffer_bytes = 0;
+    /// @brief Allocations that did not fit into the inline buffer and went to the upstream resource.
+    std::size_t overflow_allocations = 0;
+    /// @brief Bytes allocated from the upstream resource.
+    std::size_t overflow_bytes = 0;
+};
+
+/// @brief StackBufferResource is a memory resource with an inline buffer of Bytes bytes, so that pmr containers
+/// declared next to it as local variables live on the stack. Allocations bump a cursor through the buffer. Freeing
+/// the most recent allocation moves the cursor back, so containers that are created and destroyed in LIFO order keep
+/// reusing the same bytes; other frees inside the buffer are only reclaimed when the resource is destroyed. Requests
+/// that do not fit into the rest of the buffer are forwarded to the upstream resource, and freed there, one by one.
+/// Unlike StackArena, memory is not held until a reset, so the resource suits long-lived containers that outgrow the
+/// buffer, and statistics() tells how often the buffer was too small.
+/// @tparam Bytes Size of the inline buffer
+template <std::size_t Bytes> class StackBufferResource final : public std::pmr::memory_resource
+{
+  public:
+    /// @brief Constructor of the StackBufferResource class.
+    /// @param upstream Resource that serves the requests that do not fit into the inline buffer.
+    explicit StackBufferResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept
+        : upstream_(upstream)
+    {
+    }
+
+    StackBufferResource(const StackBufferResource &) = delete;
+    StackBufferResource &operator=(const StackBufferResource &) = delete;
+
+    /// @brief Returns the counters of the resource.
+    const StackBufferStatistics &statistics() const noexcept
+    {
+        return statistics_;
+    }
+
+    /// @brief Returns the number of bytes of the inline buffer up to the cursor.
+    std::size_t bufferBytesInUse() const noexcept
+    {
+        return static_cast<std::size_t>(cursor_ - buffer_);
+    }
+
+    /// @brief Returns the upstream resource that the overflowing requests are forwarded to.
+    std::pmr::memory_resource *upstream_resource() const noexcept
+    {
+        return upstream_;
+    }
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        const auto cursor = reinterpret_cast<std::uintptr_t>(cursor_);
+        const auto aligned = (cursor + alignment - 1) & ~(alignment - 1);
+        const auto end = reinterpret_cast<std::uintptr_t>(buffer_ + Bytes);
+        // Strict, so that not even a zero-byte request gets the end address, which inBuffer() does not recognize
+        if (aligned < end && bytes <= end - aligned)
+        {
+            cursor_ = reinterpret_cast<std::byte *>(aligned + bytes);
+            ++statistics_.buffer_allocations;
+            statistics_.peak_buffer_bytes = std::max(statistics_.peak_buffer_bytes, bufferBytesInUse());
+            return reinterpret_cast<std::byte *>(aligned);
+        }
+
+        void *pointer = upstream_->allocate(bytes, alignment);
+        ++statistics_.overflow_allocations;
+        statistics_.overflow_bytes += bytes;
+        return pointer;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        auto *pointer = static_cast<std::byte *>(p);
+        if (!inBuffer(pointer))
+        {
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+        if (pointer + bytes == cursor_)
+        {
+            cursor_ = pointer;
+            ++statistics_.reclaimed_frees;
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    /// @brief Returns whether the pointer points into the inline buffer, comparing addresses as integers because
+    /// pointers into different objects are not ordered.
+    bool inBuffer(const std::byte *pointer) const noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+        const auto begin = reinterpret_cast<std::uintptr_t>(buffer_);
+        return address >= begin && address < begin + Bytes;
+    }
+
+    alignas(std::max_align_t) std::byte buffer_[Bytes];
+    std::byte *cursor_ = buffer_;
+    std::pmr::memory_resource *upstream_;
+    StackBufferStatistics statistics_;
+};
@@ -0,0 +1,182 @@
+#include "stack_flat_map.hpp"
+
+#include <algorithm>     // std::shuffle
+#include <chrono>        // std::chrono::high_resolution_clock
+#include <cstdint>       // std::size_t
+#include <iostream>      // std::cout
+#include <map>           // std::map
+#include <numeric>       // std::iota
+#include <random>        // std::mt19937, std::uniform_int_distribution
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Compile-time checks: both search strategies find the same positions
+template <std::size_t N> constexpr bool testLookups()
+{
+    StackFlatSet<int, N> set = {7, 3, 9, 3, 1};
+    set.erase(9);
+    set.insert(5);
+    // 1 3 5 7
+    return set.size() == 4 && set.contains(5) && !set.contains(9) && *set.lower_bound(4) == 5 &&
+           set.lower_bound(8) == set.end() && set.find(1) == set.begin();
+}
+
+static_assert(testLookups<stack_flat_linear_search_capacity>());
+static_assert(testLookups<stack_flat_linear_search_capacity + 1>());
+
+std::mt19937 generator(42);
+
+/// @brief Returns count distinct keys from [0, 2 * count) in random order.
+std::vector<int> makeKeys(const std::size_t count)
+{
+    std::vector<int> keys(2 * count);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    keys.resize(count);
+    return keys;
+}
+
+/// @brief Returns random keys from [0, 2 * count), about half of which are present in a map built from makeKeys.
+std::vector<int> makeQueries(const std::size_t count)
+{
+    constexpr std::size_t number_of_queries = 4096;
+
+    std::uniform_int_distribution<int> distribution(0, static_cast<int>(2 * count) - 1);
+    std::vector<int> queries(number_of_queries);
+    for (auto &query : queries)
+    {
+        query = distribution(generator);
+    }
+    return queries;
+}
+
+/// @brief Builds a short-lived map from the keys many times.
+template <typename Map> double benchmarkBuild(const std::vector<int> &keys)
+{
+    constexpr std::size_t number_of_inserted_keys = 10'000'000;
+    const std::size_t number_of_iterations = number_of_inserted_keys / keys.size();
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        Map map;
+        for (const auto key : keys)
+        {
+            map.insert({key, key});
+        }
+        doNotOptimize(map);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Looks up the queries in a map built from the keys, summing the values of the keys that are present.
+template <typename Map> double benchmarkLookup(const std::vector<int> &keys, const std::vector<int> &queries)
+{
+    constexpr std::size_t number_of_iterations = 2'000;
+
+    Map map;
+    for (const auto key : keys)
+    {
+        map.insert({key, key});
+    }
+
+    long long sum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(map);
+        for (const auto query : queries)
+        {
+            const auto it = map.find(query);
+            if (it != map.end())
+            {
+                sum += (*it).second;
+            }
+        }
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(sum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+template <std::size_t N> void compareMaps()
+{
+    const auto keys = makeKeys(N);
+    const auto queries = makeQueries(N);
+
+    std::cout << "Elapsed time (build std::map, " << N << " keys): " << benchmarkBuild<std::map<int, int>>(keys)
+              << std::endl;
+    std::cout << "Elapsed time (build std::unordered_map, " << N
+              << " keys): " << benchmarkBuild<std::unordered_map<int, int>>(keys) << std::endl;
+    std::cout << "Elapsed time (build StackFlatMap, " << N
+              << " keys): " << benchmarkBuild<StackFlatMap<int, int, N>>(keys) << std::endl;
+
+    std::cout << "Elapsed time (lookup std::map, " << N
+              << " keys): " << benchmarkLookup<std::map<int, int>>(keys, queries) << std::endl;
+    std::cout << "Elapsed time (lookup std::unordered_map, " << N
+              << " keys): " << benchmarkLookup<std::unordered_map<int, int>>(keys, queries) << std::endl;
+    std::cout << "Elapsed time (lookup StackFlatMap, " << N
+              << " keys): " << benchmarkLookup<StackFlatMap<int, int, N>>(keys, queries) << std::endl;
+}
+
+int main()
+{
+    StackFlatMap<std::string, int, 8> ages = {{"carol", 41}, {"alice", 30}};
+    ages.insert({"bob", 25});
+    ages["dave"] = 19;
+    ages.insert_or_assign("alice", 31);
+
+    // Inserting an already present key leaves the existing value untouched
+    const auto [it, inserted] = ages.try_emplace("bob", 99);
+    std::cout << "bob inserted: " << inserted << ", age: " << (*it).second << std::endl;
+
+    ages.erase("carol");
+    for (const auto [name, age] : ages)
+    {
+        std::cout << name << ": " << age << std::endl;
+    }
+
+    try
+    {
+        ages.at("carol");
+    }
+    catch (const std::out_of_range &error)
+    {
+        std::cout << "Error: " << error.what() << std::endl;
+    }
+
+    StackFlatSet<int, 4> set = {4, 2, 8, 2};
+    set.insert(6);
+    try
+    {
+        set.insert(10);
+    }
+    catch (const std::overflow_error &error)
+    {
+        std::cout << "Error: " << error.what() << std::endl;
+    }
+    for (const auto value : set)
+    {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+
+    compareMaps<8>();
+    compareMaps<16>();
+    compareMaps<32>();
+    compareMaps<64>();
+    compareMaps<128>();
+    compareMaps<256>();
+
+    return EXIT_SUCCESS;
+}
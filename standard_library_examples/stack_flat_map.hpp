@@ -0,0 +1,704 @@
+#pragma once
+
+#include "stack_vector.hpp"
+
+#include <cstddef>          // std::ptrdiff_t
+#include <cstdint>          // std::size_t
+#include <functional>       // std::less
+#include <initializer_list> // std::initializer_list
+#include <iterator>         // std::random_access_iterator_tag
+#include <span>             // std::span
+#include <stdexcept>        // std::overflow_error, std::out_of_range
+#include <type_traits>      // std::conditional_t, std::enable_if_t
+#include <utility>          // std::pair, std::forward, std::move
+
+/// @brief Sorted key arrays with at most this many slots are searched with a linear scan instead of a binary search.
+inline constexpr std::size_t stack_flat_linear_search_capacity = 16;
+
+/// @brief Returns the index of the first of count sorted keys that does not compare less than key. Small capacities
+/// count the keys that are less than key, which touches every key but has no data dependent branch and vectorizes
+/// for arithmetic keys. Larger capacities use a binary search that always halves the range, so the number of steps
+/// only depends on count and the choice between the halves compiles to a conditional move.
+/// @tparam N Capacity of the key array, which selects the search strategy at compile time.
+template <std::size_t N, typename Key, typename Compare>
+constexpr std::size_t flatLowerBound(const Key *keys, std::size_t count, const Key &key, const Compare &compare)
+{
+    if constexpr (N <= stack_flat_linear_search_capacity)
+    {
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            index += static_cast<std::size_t>(compare(keys[i], key));
+        }
+        return index;
+    }
+    else
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        const Key *base = keys;
+        while (count > 1)
+        {
+            const std::size_t half = count / 2;
+            base = compare(base[half], key) ? base + half : base;
+            count -= half;
+        }
+        return static_cast<std::size_t>(base - keys) + static_cast<std::size_t>(compare(*base, key));
+    }
+}
+
+/// @brief StackFlatSet is a stack allocated set with a fixed capacity. The keys are kept sorted in a StackVector, so
+/// they share its uninitialized inline storage and a lookup scans or bisects one contiguous array without any heap
+/// traffic or pointer chasing. Insertion and erasure shift the keys behind the position and are O(size()).
+/// @tparam Key Type of the keys
+/// @tparam N Number of keys
+/// @tparam Compare Strict weak ordering of the keys
+template <typename Key, std::size_t N, typename Compare = std::less<Key>> class StackFlatSet final
+{
+    using Keys = StackVector<Key, N>;
+
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using reference = const value_type &;
+    using const_reference = const value_type &;
+    using iterator = typename Keys::const_iterator;
+    using const_iterator = typename Keys::const_iterator;
+
+    /// @brief Default constructor of the StackFlatSet class.
+    constexpr StackFlatSet() = default;
+
+    /// @brief Constructor of the StackFlatSet class from the initializer list. Duplicate keys are inserted once.
+    /// @param initializer_list initializer list of the keys to insert.
+    /// @throws std::overflow_error if the initializer list holds more than N distinct keys.
+    constexpr StackFlatSet(std::initializer_list<Key> initializer_list)
+    {
+        for (const auto &key : initializer_list)
+        {
+            insert(key);
+        }
+    }
+
+    /// @brief Returns whether the StackFlatSet is empty.
+    /// @return True if empty, else False
+    constexpr bool empty() const noexcept
+    {
+        return keys_.empty();
+    }
+
+    /// @brief Gets the number of keys in the StackFlatSet.
+    /// @return Current data size.
+    constexpr size_type size() const noexcept
+    {
+        return keys_.size();
+    }
+
+    /// @brief Get the capacity of StackFlatSet
+    /// @return Maximum number of keys that StackFlatSet can hold
+    constexpr size_type max_size() const noexcept
+    {
+        return N;
+    }
+
+    /// @brief Destroys all keys and resizes StackFlatSet to 0
+    constexpr void clear() noexcept
+    {
+        keys_.clear();
+    }
+
+    /// @brief Insert a copy of the key, unless an equivalent key is already present.
+    /// @param key Key to be copied.
+    /// @return Iterator to the inserted or already present key and whether the key was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatSet is full.
+    constexpr std::pair<iterator, bool> insert(const Key &key)
+    {
+        return insertKey(key);
+    }
+
+    /// @brief Move the key into the StackFlatSet, unless an equivalent key is already present.
+    /// @param key Key to be moved.
+    /// @return Iterator to the inserted or already present key and whether the key was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatSet is full.
+    constexpr std::pair<iterator, bool> insert(Key &&key)
+    {
+        return insertKey(std::move(key));
+    }
+
+    /// @brief Removes the key equivalent to key, if any.
+    /// @param key Key to remove.
+    /// @return Number of removed keys, 0 or 1.
+    constexpr size_type erase(const Key &key)
+    {
+        const size_type index = lowerBound(key);
+        if (!matches(index, key))
+        {
+            return 0;
+        }
+        keys_.erase(keys_.begin() + index);
+        return 1;
+    }
+
+    /// @brief Removes the key at the given position.
+    /// @param pos Iterator to the key to remove.
+    /// @return Iterator following the removed key.
+    /// @throws std::out_of_range if invalid position is provided.
+    constexpr iterator erase(const_iterator pos)
+    {
+        return keys_.erase(keys_.begin() + (pos - keys_.cbegin()));
+    }
+
+    /// @brief Finds the key equivalent to key.
+    /// @param key Key to search for.
+    /// @return Iterator to the key, or end() if it is not present.
+    constexpr const_iterator find(const Key &key) const
+    {
+        const size_type index = lowerBound(key);
+        return matches(index, key) ? keys_.cbegin() + index : keys_.cend();
+    }
+
+    /// @brief Returns whether a key equivalent to key is present.
+    constexpr bool contains(const Key &key) const
+    {
+        return matches(lowerBound(key), key);
+    }
+
+    /// @brief Returns the number of keys equivalent to key, 0 or 1.
+    constexpr size_type count(const Key &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    /// @brief Returns an iterator to the first key that does not compare less than key.
+    constexpr const_iterator lower_bound(const Key &key) const
+    {
+        return keys_.cbegin() + lowerBound(key);
+    }
+
+    /// @brief Returns an iterator pointing to the smallest key in the StackFlatSet.
+    constexpr const_iterator begin() const noexcept
+    {
+        return keys_.cbegin();
+    }
+
+    /// @brief Returns an iterator pointing to the smallest key in the StackFlatSet.
+    constexpr const_iterator cbegin() const noexcept
+    {
+        return keys_.cbegin();
+    }
+
+    /// @brief Returns an iterator referring to the position one past the largest key in the StackFlatSet.
+    constexpr const_iterator end() const noexcept
+    {
+        return keys_.cend();
+    }
+
+    /// @brief Returns an iterator referring to the position one past the largest key in the StackFlatSet.
+    constexpr const_iterator cend() const noexcept
+    {
+        return keys_.cend();
+    }
+
+  private:
+    /// @brief Returns the index of the first key that does not compare less than key.
+    constexpr size_type lowerBound(const Key &key) const
+    {
+        return flatLowerBound<N>(keys_.data(), keys_.size(), key, compare_);
+    }
+
+    /// @brief Returns whether the lower bound at index holds a key equivalent to key.
+    constexpr bool matches(size_type index, const Key &key) const
+    {
+        return index < keys_.size() && !compare_(key, keys_[index]);
+    }
+
+    /// @brief Inserts the key at its sorted position, unless an equivalent key is already present.
+    template <typename KeyArg> constexpr std::pair<iterator, bool> insertKey(KeyArg &&key)
+    {
+        const size_type index = lowerBound(key);
+        if (matches(index, key))
+        {
+            return {keys_.cbegin() + index, false};
+        }
+        if (keys_.size() >= N)
+        {
+            throw std::overflow_error("StackFlatSet is full");
+        }
+        keys_.insert(keys_.begin() + index, std::forward<KeyArg>(key));
+        return {keys_.cbegin() + index, true};
+    }
+
+    Keys keys_;
+    [[no_unique_address]] Compare compare_;
+};
+
+/// @brief StackFlatMap is a stack allocated map with a fixed capacity. The keys and the values are kept in two
+/// StackVectors in key order, so they share its uninitialized inline storage and a lookup only scans or bisects the
+/// densely packed keys without touching the values. Insertion and erasure shift the entries behind the position and
+/// are O(size()). Iterators dereference to pairs of references, so entries can be unpacked with structured bindings.
+/// @tparam Key Type of the keys
+/// @tparam Value Type of the mapped values
+/// @tparam N Number of entries
+/// @tparam Compare Strict weak ordering of the keys
+template <typename Key, typename Value, std::size_t N, typename Compare = std::less<Key>> class StackFlatMap final
+{
+    /// @brief Random access iterator over the entries that dereferences to a pair of references to key and value.
+    template <bool Const> class EntryIterator
+    {
+        using container_type = std::conditional_t<Const, const StackFlatMap, StackFlatMap>;
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference =
+            std::conditional_t<Const, std::pair<const Key &, const Value &>, std::pair<const Key &, Value &>>;
+        using pointer = void;
+
+        constexpr EntryIterator() = default;
+
+        constexpr EntryIterator(container_type *container, std::size_t index) : container_(container), index_(index)
+        {
+        }
+
+        template <bool C = Const, typename = std::enable_if_t<!C>> constexpr operator EntryIterator<true>() const
+        {
+            return EntryIterator<true>(container_, index_);
+        }
+
+        constexpr reference operator*() const
+        {
+            return reference(container_->keys_[index_], container_->values_[index_]);
+        }
+
+        constexpr reference operator[](difference_type offset) const
+        {
+            return *(*this + offset);
+        }
+
+        constexpr EntryIterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        constexpr EntryIterator operator++(int)
+        {
+            EntryIterator previous = *this;
+            ++index_;
+            return previous;
+        }
+
+        constexpr EntryIterator &operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        constexpr EntryIterator operator--(int)
+        {
+            EntryIterator previous = *this;
+            --index_;
+            return previous;
+        }
+
+        constexpr EntryIterator &operator+=(difference_type offset)
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        constexpr EntryIterator &operator-=(difference_type offset)
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend constexpr EntryIterator operator+(EntryIterator iterator, difference_type offset)
+        {
+            return iterator += offset;
+        }
+
+        friend constexpr EntryIterator operator-(EntryIterator iterator, difference_type offset)
+        {
+            return iterator -= offset;
+        }
+
+        friend constexpr difference_type operator-(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend constexpr bool operator==(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend constexpr bool operator!=(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend constexpr bool operator<(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend constexpr bool operator>(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ > rhs.index_;
+        }
+
+        friend constexpr bool operator<=(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ <= rhs.index_;
+        }
+
+        friend constexpr bool operator>=(const EntryIterator &lhs, const EntryIterator &rhs)
+        {
+            return lhs.index_ >= rhs.index_;
+        }
+
+        /// @brief Index of the entry the iterator points to.
+        constexpr std::size_t index() const noexcept
+        {
+            return index_;
+        }
+
+      private:
+        container_type *container_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using key_compare = Compare;
+    using reference = std::pair<const Key &, Value &>;
+    using const_reference = std::pair<const Key &, const Value &>;
+    using iterator = EntryIterator<false>;
+    using const_iterator = EntryIterator<true>;
+
+    /// @brief Default constructor of the StackFlatMap class.
+    constexpr StackFlatMap() = default;
+
+    /// @brief Constructor of the StackFlatMap class from the initializer list. For duplicate keys the first entry
+    /// wins.
+    /// @param initializer_list initializer list of the entries to insert.
+    /// @throws std::overflow_error if the initializer list holds more than N distinct keys.
+    constexpr StackFlatMap(std::initializer_list<value_type> initializer_list)
+    {
+        for (const auto &entry : initializer_list)
+        {
+            insert(entry);
+        }
+    }
+
+    /// @brief Returns whether the StackFlatMap is empty.
+    /// @return True if empty, else False
+    constexpr bool empty() const noexcept
+    {
+        return keys_.empty();
+    }
+
+    /// @brief Gets the number of entries in the StackFlatMap.
+    /// @return Current data size.
+    constexpr size_type size() const noexcept
+    {
+        return keys_.size();
+    }
+
+    /// @brief Get the capacity of StackFlatMap
+    /// @return Maximum number of entries that StackFlatMap can hold
+    constexpr size_type max_size() const noexcept
+    {
+        return N;
+    }
+
+    /// @brief Destroys all entries and resizes StackFlatMap to 0
+    constexpr void clear() noexcept
+    {
+        keys_.clear();
+        values_.clear();
+    }
+
+    /// @brief Insert a copy of the entry, unless an equivalent key is already present.
+    /// @param entry Key and value to be copied.
+    /// @return Iterator to the inserted or already present entry and whether the entry was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    constexpr std::pair<iterator, bool> insert(const value_type &entry)
+    {
+        return emplaceKey(entry.first, entry.second);
+    }
+
+    /// @brief Move the entry into the StackFlatMap, unless an equivalent key is already present.
+    /// @param entry Key and value to be moved.
+    /// @return Iterator to the inserted or already present entry and whether the entry was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    constexpr std::pair<iterator, bool> insert(value_type &&entry)
+    {
+        return emplaceKey(std::move(entry.first), std::move(entry.second));
+    }
+
+    /// @brief Insert the value for the key, or assign it to the value of an already present equivalent key.
+    /// @param key Key of the entry.
+    /// @param value Value to be forwarded to the entry.
+    /// @return Iterator to the entry and whether the entry was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    template <typename ValueArg> constexpr std::pair<iterator, bool> insert_or_assign(const Key &key, ValueArg &&value)
+    {
+        const size_type index = lowerBound(key);
+        if (matches(index, key))
+        {
+            values_[index] = std::forward<ValueArg>(value);
+            return {iterator(this, index), false};
+        }
+        return emplaceAt(index, key, std::forward<ValueArg>(value));
+    }
+
+    /// @brief Construct a value in place for the key, unless an equivalent key is already present. The arguments
+    /// are left untouched when the key is present.
+    /// @tparam ...Args Argument types forwarded to construct the new value.
+    /// @param key Key of the entry.
+    /// @param ...args Argument values forwarded to construct the new value.
+    /// @return Iterator to the inserted or already present entry and whether the entry was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    template <typename... Args> constexpr std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return emplaceKey(key, std::forward<Args>(args)...);
+    }
+
+    /// @brief Construct a value in place for the moved key, unless an equivalent key is already present.
+    /// @tparam ...Args Argument types forwarded to construct the new value.
+    /// @param key Key of the entry.
+    /// @param ...args Argument values forwarded to construct the new value.
+    /// @return Iterator to the inserted or already present entry and whether the entry was inserted.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    template <typename... Args> constexpr std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args)
+    {
+        return emplaceKey(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /// @brief Get a reference to the value of the key, inserting a value-initialized value if it is not present.
+    /// @param key Key of the entry.
+    /// @return Non-const reference to the value.
+    /// @throws std::overflow_error if the key is not present and the StackFlatMap is full.
+    constexpr Value &operator[](const Key &key)
+    {
+        return values_[emplaceKey(key).first.index()];
+    }
+
+    /// @brief Get a reference to the value of the key.
+    /// @param key Key of the entry.
+    /// @return Non-const reference to the value.
+    /// @throws std::out_of_range if the key is not present.
+    constexpr Value &at(const Key &key)
+    {
+        const size_type index = lowerBound(key);
+        if (!matches(index, key))
+        {
+            throw std::out_of_range("StackFlatMap key not found");
+        }
+        return values_[index];
+    }
+
+    /// @brief Get a constant reference to the value of the key.
+    /// @param key Key of the entry.
+    /// @return Const reference to the value.
+    /// @throws std::out_of_range if the key is not present.
+    constexpr const Value &at(const Key &key) const
+    {
+        const size_type index = lowerBound(key);
+        if (!matches(index, key))
+        {
+            throw std::out_of_range("StackFlatMap key not found");
+        }
+        return values_[index];
+    }
+
+    /// @brief Removes the entry with the key equivalent to key, if any.
+    /// @param key Key of the entry to remove.
+    /// @return Number of removed entries, 0 or 1.
+    constexpr size_type erase(const Key &key)
+    {
+        const size_type index = lowerBound(key);
+        if (!matches(index, key))
+        {
+            return 0;
+        }
+        eraseAt(index);
+        return 1;
+    }
+
+    /// @brief Removes the entry at the given position.
+    /// @param pos Iterator to the entry to remove.
+    /// @return Iterator following the removed entry.
+    /// @throws std::out_of_range if invalid position is provided.
+    constexpr iterator erase(const_iterator pos)
+    {
+        eraseAt(pos.index());
+        return iterator(this, pos.index());
+    }
+
+    /// @brief Finds the entry with the key equivalent to key.
+    /// @param key Key to search for.
+    /// @return Iterator to the entry, or end() if the key is not present.
+    constexpr iterator find(const Key &key)
+    {
+        const size_type index = lowerBound(key);
+        return matches(index, key) ? iterator(this, index) : end();
+    }
+
+    /// @brief Finds the entry with the key equivalent to key.
+    /// @param key Key to search for.
+    /// @return Const iterator to the entry, or end() if the key is not present.
+    constexpr const_iterator find(const Key &key) const
+    {
+        const size_type index = lowerBound(key);
+        return matches(index, key) ? const_iterator(this, index) : end();
+    }
+
+    /// @brief Returns whether an entry with a key equivalent to key is present.
+    constexpr bool contains(const Key &key) const
+    {
+        return matches(lowerBound(key), key);
+    }
+
+    /// @brief Returns the number of entries with a key equivalent to key, 0 or 1.
+    constexpr size_type count(const Key &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    /// @brief Returns an iterator to the first entry whose key does not compare less than key.
+    constexpr iterator lower_bound(const Key &key)
+    {
+        return iterator(this, lowerBound(key));
+    }
+
+    /// @brief Returns a const iterator to the first entry whose key does not compare less than key.
+    constexpr const_iterator lower_bound(const Key &key) const
+    {
+        return const_iterator(this, lowerBound(key));
+    }
+
+    /// @brief Read-only view of the sorted keys.
+    constexpr std::span<const Key> keys() const noexcept
+    {
+        return {keys_.data(), keys_.size()};
+    }
+
+    /// @brief View of the values, in the order of their keys.
+    constexpr std::span<Value> values() noexcept
+    {
+        return {values_.data(), values_.size()};
+    }
+
+    /// @brief Read-only view of the values, in the order of their keys.
+    constexpr std::span<const Value> values() const noexcept
+    {
+        return {values_.data(), values_.size()};
+    }
+
+    /// @brief Returns an iterator pointing to the entry with the smallest key.
+    constexpr iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+
+    /// @brief Returns a const iterator pointing to the entry with the smallest key.
+    constexpr const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns a const iterator pointing to the entry with the smallest key.
+    constexpr const_iterator cbegin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns an iterator referring to the position one past the entry with the largest key.
+    constexpr iterator end() noexcept
+    {
+        return iterator(this, keys_.size());
+    }
+
+    /// @brief Returns a const iterator referring to the position one past the entry with the largest key.
+    constexpr const_iterator end() const noexcept
+    {
+        return const_iterator(this, keys_.size());
+    }
+
+    /// @brief Returns a const iterator referring to the position one past the entry with the largest key.
+    constexpr const_iterator cend() const noexcept
+    {
+        return const_iterator(this, keys_.size());
+    }
+
+  private:
+    /// @brief Returns the index of the first key that does not compare less than key.
+    constexpr size_type lowerBound(const Key &key) const
+    {
+        return flatLowerBound<N>(keys_.data(), keys_.size(), key, compare_);
+    }
+
+    /// @brief Returns whether the lower bound at index holds a key equivalent to key.
+    constexpr bool matches(size_type index, const Key &key) const
+    {
+        return index < keys_.size() && !compare_(key, keys_[index]);
+    }
+
+    /// @brief Inserts an entry for the key at its sorted position, unless an equivalent key is already present.
+    template <typename KeyArg, typename... Args>
+    constexpr std::pair<iterator, bool> emplaceKey(KeyArg &&key, Args &&...args)
+    {
+        const size_type index = lowerBound(key);
+        if (matches(index, key))
+        {
+            return {iterator(this, index), false};
+        }
+        return emplaceAt(index, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+    }
+
+    /// @brief Inserts an entry at the given sorted position. If the key cannot be inserted, the value is removed
+    /// again, so the keys and the values always stay the same length.
+    template <typename KeyArg, typename... Args>
+    constexpr std::pair<iterator, bool> emplaceAt(size_type index, KeyArg &&key, Args &&...args)
+    {
+        if (keys_.size() >= N)
+        {
+            throw std::overflow_error("StackFlatMap is full");
+        }
+        values_.emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try
+        {
+            keys_.insert(keys_.begin() + index, std::forward<KeyArg>(key));
+        }
+        catch (...)
+        {
+            values_.erase(values_.begin() + index);
+            throw;
+        }
+        return {iterator(this, index), true};
+    }
+
+    /// @brief Removes the key and the value at the given index.
+    constexpr void eraseAt(size_type index)
+    {
+        keys_.erase(keys_.begin() + index);
+        values_.erase(values_.begin() + index);
+    }
+
+    StackVector<Key, N> keys_;
+    StackVector<Value, N> values_;
+    [[no_unique_address]] Compare compare_;
+};
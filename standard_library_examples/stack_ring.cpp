@@ -0,0 +1,109 @@
+#include "stack_ring.hpp"
+
+#include <chrono>   // std::chrono::high_resolution_clock
+#include <cstdint>  // std::size_t
+#include <deque>    // std::deque
+#include <iostream> // std::cout
+#include <string>   // std::string
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Compile-time check: the ring wraps around the end of its storage while keeping the logical order
+constexpr bool testWrapAround()
+{
+    StackRing<int, 4> ring = {1, 2, 3};
+    ring.pop_front();
+    ring.pop_front();
+    ring.push_back(4);
+    ring.push_back(5);
+    ring.push_front(0);
+    // 0 3 4 5, stored as 4 5 0 3
+    return ring.full() && ring.front() == 0 && ring[1] == 3 && ring.back() == 5 && *(ring.end() - 2) == 4;
+}
+
+static_assert(testWrapAround());
+
+/// @brief Streams values through a bounded FIFO that is kept half full, as a producer and a consumer on the same
+/// thread would. Every iteration creates a new queue, so the std::deque also pays for its block allocations.
+template <typename Queue> double benchmarkFifo(const std::size_t capacity)
+{
+    constexpr std::size_t number_of_pushed_elements = 10'000'000;
+    const std::size_t number_of_iterations = number_of_pushed_elements / (4 * capacity);
+
+    std::size_t sum = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        Queue queue;
+        for (std::size_t i = 0; i < capacity / 2; ++i)
+        {
+            queue.push_back(i);
+        }
+        for (std::size_t i = 0; i < 4 * capacity; ++i)
+        {
+            sum += queue.front();
+            queue.pop_front();
+            queue.push_back(i);
+        }
+        doNotOptimize(queue);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(sum);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+template <std::size_t Capacity> void compareFifo()
+{
+    std::cout << "Elapsed time (std::deque, capacity " << Capacity
+              << "): " << benchmarkFifo<std::deque<std::size_t>>(Capacity) << std::endl;
+    std::cout << "Elapsed time (StackRing, capacity " << Capacity
+              << "): " << benchmarkFifo<StackRing<std::size_t, Capacity>>(Capacity) << std::endl;
+}
+
+int main()
+{
+    StackRing<std::string, 4> ring;
+    ring.push_back("two");
+    ring.push_back("three");
+    ring.push_front("one");
+    ring.emplace_back("four");
+
+    // The ring is full, so the next push throws instead of overwriting
+    try
+    {
+        ring.push_back("five");
+    }
+    catch (const std::overflow_error &error)
+    {
+        std::cout << "Error: " << error.what() << std::endl;
+    }
+
+    // Popping from the front frees a slot, which the next push reuses by wrapping around
+    ring.pop_front();
+    ring.push_back("five");
+    for (const auto &word : ring)
+    {
+        std::cout << word << " ";
+    }
+    std::cout << std::endl;
+
+    for (auto it = ring.rbegin(); it != ring.rend(); ++it)
+    {
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+
+    compareFifo<8>();
+    compareFifo<16>();
+    compareFifo<32>();
+    compareFifo<64>();
+    compareFifo<128>();
+    compareFifo<256>();
+
+    return EXIT_SUCCESS;
+}
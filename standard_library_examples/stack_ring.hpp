@@ -0,0 +1,595 @@
+#pragma once
+
+#include <cstddef>          // std::ptrdiff_t
+#include <cstdint>          // std::size_t
+#include <initializer_list> // std::initializer_list
+#include <iterator>         // std::random_access_iterator_tag, std::reverse_iterator
+#include <memory>           // std::construct_at, std::destroy_at
+#include <stdexcept>        // std::overflow_error, std::underflow_error, std::out_of_range
+#include <type_traits>      // std::conditional_t, std::enable_if_t, std::is_trivially_destructible_v
+#include <utility>          // std::move, std::forward
+
+/// @brief StackRing is a stack allocated double-ended ring buffer with a fixed capacity. Like StackVector, the
+/// elements live in uninitialized inline storage and are only constructed when pushed, so a bounded FIFO or LIFO
+/// never touches the heap. Pushing and popping at either end is O(1) and logical indices wrap around the end of the
+/// storage, with the wrap done by a mask when N is a power of two.
+/// @tparam T Type of the values
+/// @tparam N Number of elements
+template <typename T, std::size_t N> class StackRing final
+{
+    static_assert(N > 0, "StackRing capacity must not be zero");
+
+    /// @brief Random access iterator over the elements in logical order, from front() to back().
+    template <bool Const> class RingIterator
+    {
+        using container_type = std::conditional_t<Const, const StackRing, StackRing>;
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const T &, T &>;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+
+        constexpr RingIterator() = default;
+
+        constexpr RingIterator(container_type *container, std::size_t index) : container_(container), index_(index)
+        {
+        }
+
+        template <bool C = Const, typename = std::enable_if_t<!C>> constexpr operator RingIterator<true>() const
+        {
+            return RingIterator<true>(container_, index_);
+        }
+
+        constexpr reference operator*() const
+        {
+            return (*container_)[index_];
+        }
+
+        constexpr pointer operator->() const
+        {
+            return &(*container_)[index_];
+        }
+
+        constexpr reference operator[](difference_type offset) const
+        {
+            return (*container_)[index_ + offset];
+        }
+
+        constexpr RingIterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        constexpr RingIterator operator++(int)
+        {
+            RingIterator previous = *this;
+            ++index_;
+            return previous;
+        }
+
+        constexpr RingIterator &operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        constexpr RingIterator operator--(int)
+        {
+            RingIterator previous = *this;
+            --index_;
+            return previous;
+        }
+
+        constexpr RingIterator &operator+=(difference_type offset)
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        constexpr RingIterator &operator-=(difference_type offset)
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend constexpr RingIterator operator+(RingIterator iterator, difference_type offset)
+        {
+            return iterator += offset;
+        }
+
+        friend constexpr RingIterator operator-(RingIterator iterator, difference_type offset)
+        {
+            return iterator -= offset;
+        }
+
+        friend constexpr difference_type operator-(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend constexpr bool operator==(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend constexpr bool operator!=(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend constexpr bool operator<(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend constexpr bool operator>(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ > rhs.index_;
+        }
+
+        friend constexpr bool operator<=(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ <= rhs.index_;
+        }
+
+        friend constexpr bool operator>=(const RingIterator &lhs, const RingIterator &rhs)
+        {
+            return lhs.index_ >= rhs.index_;
+        }
+
+      private:
+        container_type *container_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using iterator = RingIterator<false>;
+    using const_iterator = RingIterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /// @brief Default constructor of the StackRing class.
+    constexpr StackRing() = default;
+
+    /// @brief Destructor of the StackRing class, destroys all constructed elements.
+    constexpr ~StackRing()
+    {
+        clear();
+    }
+
+    /// @brief Constructor of the StackRing class from the initializer list.
+    /// @param initializer_list initializer list to copy data from, front to back.
+    /// @throws std::overflow_error if the initializer list holds more than N elements.
+    constexpr StackRing(std::initializer_list<T> initializer_list)
+    {
+        if (initializer_list.size() > N)
+        {
+            throw std::overflow_error("Initializer list too large for StackRing");
+        }
+        for (const auto &value : initializer_list)
+        {
+            emplace_back(value);
+        }
+    }
+
+    /// @brief Copy constructor. The copy starts at the beginning of its storage, whatever the head of the other ring.
+    /// @param other The object to copy data from.
+    constexpr StackRing(const StackRing &other)
+    {
+        copyFrom(other);
+    }
+
+    /// @brief Copy assignment operator.
+    /// @param other The object to copy data from.
+    /// @return This StackRing holding copies of the elements of the other StackRing.
+    constexpr StackRing &operator=(const StackRing &other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        copyFrom(other);
+
+        return *this;
+    }
+
+    /// @brief Move constructor.
+    /// @param other Other StackRing to move data from.
+    constexpr StackRing(StackRing &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        moveFrom(other);
+    }
+
+    /// @brief Move operator.
+    /// @param other Other StackRing to move data from.
+    /// @return Moved StackRing.
+    constexpr StackRing &operator=(StackRing &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        moveFrom(other);
+
+        return *this;
+    }
+
+    /// @brief Returns whether the StackRing is empty.
+    /// @return True if empty, else False
+    constexpr bool empty() const noexcept
+    {
+        return (size_ == 0UL);
+    }
+
+    /// @brief Returns whether the StackRing holds N elements.
+    /// @return True if full, else False
+    constexpr bool full() const noexcept
+    {
+        return (size_ == N);
+    }
+
+    /// @brief Gets the number of elements in the StackRing.
+    /// @return Current data size.
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /// @brief Get the capacity of StackRing
+    /// @return Maximum number of elements that StackRing can hold
+    constexpr size_type max_size() const noexcept
+    {
+        return N;
+    }
+
+    /// @brief Destroys all elements and resizes StackRing to 0
+    constexpr void clear() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for (size_type i = 0; i < size_; ++i)
+            {
+                std::destroy_at(slot(i));
+            }
+        }
+        head_ = 0UL;
+        size_ = 0UL;
+    }
+
+    /// @brief Add a value to the back of the StackRing
+    /// @param value Value to be copied
+    /// @throws std::overflow_error if the StackRing is full.
+    constexpr void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    /// @brief Move a value to the back of the StackRing.
+    /// @param value Value to be moved.
+    /// @throws std::overflow_error if the StackRing is full.
+    constexpr void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    /// @brief Add a value to the front of the StackRing
+    /// @param value Value to be copied
+    /// @throws std::overflow_error if the StackRing is full.
+    constexpr void push_front(const T &value)
+    {
+        emplace_front(value);
+    }
+
+    /// @brief Move a value to the front of the StackRing.
+    /// @param value Value to be moved.
+    /// @throws std::overflow_error if the StackRing is full.
+    constexpr void push_front(T &&value)
+    {
+        emplace_front(std::move(value));
+    }
+
+    /// @brief Construct a value in place at the back of the StackRing.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the constructed element.
+    /// @throws std::overflow_error if the StackRing is full.
+    template <typename... Args> constexpr reference emplace_back(Args &&...args)
+    {
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackRing is full");
+        }
+        T *element = std::construct_at(slot(size_), std::forward<Args>(args)...);
+        ++size_;
+        return *element;
+    }
+
+    /// @brief Construct a value in place at the front of the StackRing.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the constructed element.
+    /// @throws std::overflow_error if the StackRing is full.
+    template <typename... Args> constexpr reference emplace_front(Args &&...args)
+    {
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackRing is full");
+        }
+        const size_type new_head = wrap(head_ + N - 1);
+        T *element = std::construct_at(storage_.elements + new_head, std::forward<Args>(args)...);
+        head_ = new_head;
+        ++size_;
+        return *element;
+    }
+
+    /// @brief Remove one element from the back of the StackRing.
+    /// @throws std::underflow_error if the StackRing is empty.
+    constexpr void pop_back()
+    {
+        if (empty())
+        {
+            throw std::underflow_error("StackRing is empty");
+        }
+        --size_;
+        destroyAt(slot(size_));
+    }
+
+    /// @brief Remove one element from the front of the StackRing.
+    /// @throws std::underflow_error if the StackRing is empty.
+    constexpr void pop_front()
+    {
+        if (empty())
+        {
+            throw std::underflow_error("StackRing is empty");
+        }
+        destroyAt(storage_.elements + head_);
+        head_ = wrap(head_ + 1);
+        --size_;
+    }
+
+    /// @brief Get a reference to the element at the specified logical position, counted from the front.
+    /// @param index Index to the element stored in the StackRing.
+    /// @return Non-const reference to the element.
+    constexpr reference operator[](size_type index) noexcept
+    {
+        return *slot(index);
+    }
+
+    /// @brief Get a constant reference to the element at the specified logical position, counted from the front.
+    /// @param index Index to the element stored in the StackRing.
+    /// @return Const reference to the element.
+    constexpr const_reference operator[](size_type index) const noexcept
+    {
+        return *slot(index);
+    }
+
+    /// @brief Get a reference to the element at the specified logical position, counted from the front.
+    /// @param index Index to the element stored in the StackRing.
+    /// @return Non-const reference to the element.
+    /// @throws std::out_of_range If the index is out of range.
+    constexpr reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackRing index out of range");
+        }
+        return *slot(index);
+    }
+
+    /// @brief Get a constant reference to the element at the specified logical position, counted from the front.
+    /// @param index Index to the element stored in the StackRing.
+    /// @return Const reference to the element.
+    /// @throws std::out_of_range If the index is out of range.
+    constexpr const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackRing index out of range");
+        }
+        return *slot(index);
+    }
+
+    /// @brief Returns the non-const reference to the first element in the StackRing.
+    /// @throws std::out_of_range if the StackRing is empty.
+    constexpr reference front()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackRing is empty");
+        }
+        return *slot(0);
+    }
+
+    /// @brief Returns the const reference to the first element in the StackRing.
+    /// @throws std::out_of_range if the StackRing is empty.
+    constexpr const_reference front() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackRing is empty");
+        }
+        return *slot(0);
+    }
+
+    /// @brief Returns the non-const reference to the last element in the StackRing.
+    /// @throws std::out_of_range if the StackRing is empty.
+    constexpr reference back()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackRing is empty");
+        }
+        return *slot(size_ - 1);
+    }
+
+    /// @brief Returns the const reference to the last element in the StackRing.
+    /// @throws std::out_of_range if the StackRing is empty.
+    constexpr const_reference back() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackRing is empty");
+        }
+        return *slot(size_ - 1);
+    }
+
+    /// @brief Returns an iterator pointing to the front element in the StackRing.
+    constexpr iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+
+    /// @brief Returns a const iterator pointing to the front element in the StackRing.
+    constexpr const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns a const iterator pointing to the front element in the StackRing.
+    constexpr const_iterator cbegin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns an iterator referring to the position one past the back element of the StackRing.
+    constexpr iterator end() noexcept
+    {
+        return iterator(this, size_);
+    }
+
+    /// @brief Returns a const iterator referring to the position one past the back element of the StackRing.
+    constexpr const_iterator end() const noexcept
+    {
+        return const_iterator(this, size_);
+    }
+
+    /// @brief Returns a const iterator referring to the position one past the back element of the StackRing.
+    constexpr const_iterator cend() const noexcept
+    {
+        return const_iterator(this, size_);
+    }
+
+    /// @brief Returns a reverse iterator pointing to the back element in the StackRing.
+    constexpr reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the back element in the StackRing.
+    constexpr const_reverse_iterator crbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    /// @brief Returns a reverse iterator referring to the position before the front element of the StackRing.
+    constexpr reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    /// @brief Returns a const reverse iterator referring to the position before the front element of the StackRing.
+    constexpr const_reverse_iterator crend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+  private:
+    /// @brief Maps an index in [0, 2 * N) onto the storage. A power of two capacity wraps with a mask, any other
+    /// capacity with a compare and subtract, which compiles to a conditional move rather than a division.
+    static constexpr size_type wrap(size_type index) noexcept
+    {
+        if constexpr ((N & (N - 1)) == 0)
+        {
+            return index & (N - 1);
+        }
+        else
+        {
+            return (index >= N) ? index - N : index;
+        }
+    }
+
+    /// @brief Returns the storage slot of the element at the given logical index.
+    constexpr T *slot(size_type index) noexcept
+    {
+        return storage_.elements + wrap(head_ + index);
+    }
+
+    /// @brief Returns the storage slot of the element at the given logical index.
+    constexpr const T *slot(size_type index) const noexcept
+    {
+        return storage_.elements + wrap(head_ + index);
+    }
+
+    /// @brief Destroys the element at the given position. Trivially destructible elements are left alone.
+    static constexpr void destroyAt(T *element) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            std::destroy_at(element);
+        }
+    }
+
+    /// @brief Copy constructs the elements of the other StackRing into this empty StackRing, front first.
+    /// @param other The object to copy data from.
+    constexpr void copyFrom(const StackRing &other)
+    {
+        for (size_type i = 0; i < other.size_; ++i)
+        {
+            std::construct_at(storage_.elements + i, other[i]);
+            ++size_;
+        }
+    }
+
+    /// @brief Move constructs the elements of the other StackRing into this empty StackRing and empties the other
+    /// StackRing.
+    /// @param other The object to move data from.
+    constexpr void moveFrom(StackRing &other)
+    {
+        for (size_type i = 0; i < other.size_; ++i)
+        {
+            std::construct_at(storage_.elements + i, std::move(other[i]));
+            ++size_;
+        }
+        other.clear();
+    }
+
+    /// @brief Uninitialized element storage, see StackVector.
+    union Storage
+    {
+        constexpr Storage()
+        {
+            if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+            {
+                if (std::is_constant_evaluated())
+                {
+                    for (std::size_t i = 0; i < N; ++i)
+                    {
+                        std::construct_at(elements + i);
+                    }
+                }
+            }
+        }
+
+        constexpr ~Storage()
+        {
+        }
+
+        T elements[N];
+    };
+
+    Storage storage_;
+    size_type head_ = 0;
+    size_type size_ = 0;
+};
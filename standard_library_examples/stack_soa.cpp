@@ -0,0 +1,103 @@
+#include "stack_soa.hpp"
+#include "stack_vector.hpp"
+
+#include <chrono>   // std::chrono::high_resolution_clock
+#include <cstdint>  // std::size_t, std::uint8_t
+#include <iostream> // std::cout
+#include <numeric>  // std::accumulate
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Point
+{
+    float x;
+    float y;
+    float z;
+    float intensity;
+    std::uint8_t ring;
+};
+
+constexpr std::size_t number_of_points = 4096;
+constexpr std::size_t number_of_iterations = 100'000;
+constexpr float height_threshold = 50.0F;
+
+using PointsAoS = StackVector<Point, number_of_points>;
+using PointsSoA = StackSoA<number_of_points, float, float, float, float, std::uint8_t>;
+
+/// @brief Counts the points above a height threshold, stored as an array of structs, which strides over all fields.
+double benchmarkReductionAoS(const PointsAoS &points)
+{
+    std::size_t count = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(points);
+        for (const auto &point : points)
+        {
+            count += (point.z > height_threshold);
+        }
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(count);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Counts the points above a height threshold, stored as a struct of arrays, which streams only the z field.
+double benchmarkReductionSoA(const PointsSoA &points)
+{
+    std::size_t count = 0;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(points);
+        for (const auto z : points.field<2>())
+        {
+            count += (z > height_threshold);
+        }
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(count);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    StackSoA<8, float, float, int> soa;
+    soa.push_back(1.0F, 2.0F, 10);
+    soa.push_back(3.0F, 4.0F, 20);
+    soa.insert(soa.begin() + 1, 5.0F, 6.0F, 30);
+    soa.push_back(7.0F, 8.0F, 40);
+    soa.erase(soa.begin());
+
+    // Zipped iteration over all fields of a record
+    for (auto [x, y, label] : soa)
+    {
+        std::cout << "(" << x << ", " << y << ") -> " << label << std::endl;
+    }
+
+    // Single field access as a contiguous span
+    const auto labels = soa.field<2>();
+    std::cout << "Sum of labels: " << std::accumulate(labels.begin(), labels.end(), 0) << std::endl;
+
+    PointsAoS aos_points;
+    PointsSoA soa_points;
+    for (std::size_t i = 0; i < number_of_points; ++i)
+    {
+        const auto value = static_cast<float>(i % 100);
+        aos_points.push_back(Point{value, value, value, value, 0});
+        soa_points.push_back(value, value, value, value, std::uint8_t{0});
+    }
+
+    std::cout << "Elapsed time (AoS single-field reduction, " << number_of_points
+              << " points): " << benchmarkReductionAoS(aos_points) << std::endl;
+    std::cout << "Elapsed time (SoA single-field reduction, " << number_of_points
+              << " points): " << benchmarkReductionSoA(soa_points) << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>   // std::move_backward, std::move
+#include <array>       // std::array
+#include <cstddef>     // std::ptrdiff_t
+#include <cstdint>     // std::size_t
+#include <iterator>    // std::random_access_iterator_tag
+#include <span>        // std::span
+#include <stdexcept>   // std::overflow_error, std::underflow_error, std::out_of_range
+#include <tuple>       // std::tuple, std::get, std::tuple_element_t
+#include <type_traits> // std::conditional_t, std::enable_if_t
+#include <utility>     // std::index_sequence, std::forward
+
+/// @brief StackSoA is a stack allocated structure-of-arrays container with a fixed capacity. Each field of a record
+/// is stored in its own contiguous, cache line aligned std::array, so kernels that touch a single field only stream
+/// that field's memory. Records are inserted and removed with the same semantics as StackVector and can be iterated
+/// as zipped tuples of references.
+/// @tparam N Number of records
+/// @tparam ...Fields Types of the record fields
+template <std::size_t N, typename... Fields> class StackSoA final
+{
+    static_assert(sizeof...(Fields) > 0, "StackSoA requires at least one field");
+
+    static constexpr std::size_t column_alignment = 64;
+
+    template <typename Field> struct alignas(column_alignment) Column
+    {
+        std::array<Field, N> values;
+    };
+
+    using Indices = std::index_sequence_for<Fields...>;
+
+    /// @brief Random access iterator over records that dereferences to a tuple of references to the fields.
+    template <bool Const> class ZipIterator
+    {
+        using container_type = std::conditional_t<Const, const StackSoA, StackSoA>;
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, std::tuple<const Fields &...>, std::tuple<Fields &...>>;
+        using pointer = void;
+
+        ZipIterator() = default;
+
+        ZipIterator(container_type *container, std::size_t index) : container_(container), index_(index)
+        {
+        }
+
+        template <bool C = Const, typename = std::enable_if_t<!C>> operator ZipIterator<true>() const
+        {
+            return ZipIterator<true>(container_, index_);
+        }
+
+        reference operator*() const
+        {
+            return (*container_)[index_];
+        }
+
+        reference operator[](difference_type offset) const
+        {
+            return (*container_)[index_ + offset];
+        }
+
+        ZipIterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        ZipIterator operator++(int)
+        {
+            ZipIterator previous = *this;
+            ++index_;
+            return previous;
+        }
+
+        ZipIterator &operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        ZipIterator operator--(int)
+        {
+            ZipIterator previous = *this;
+            --index_;
+            return previous;
+        }
+
+        ZipIterator &operator+=(difference_type offset)
+        {
+            index_ += offset;
+            return *this;
+        }
+
+        ZipIterator &operator-=(difference_type offset)
+        {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend ZipIterator operator+(ZipIterator iterator, difference_type offset)
+        {
+            return iterator += offset;
+        }
+
+        friend ZipIterator operator-(ZipIterator iterator, difference_type offset)
+        {
+            return iterator -= offset;
+        }
+
+        friend difference_type operator-(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ > rhs.index_;
+        }
+
+        friend bool operator<=(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ <= rhs.index_;
+        }
+
+        friend bool operator>=(const ZipIterator &lhs, const ZipIterator &rhs)
+        {
+            return lhs.index_ >= rhs.index_;
+        }
+
+        /// @brief Index of the record the iterator points to.
+        std::size_t index() const noexcept
+        {
+            return index_;
+        }
+
+      private:
+        container_type *container_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+  public:
+    using value_type = std::tuple<Fields...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::tuple<Fields &...>;
+    using const_reference = std::tuple<const Fields &...>;
+    using iterator = ZipIterator<false>;
+    using const_iterator = ZipIterator<true>;
+
+    template <std::size_t I> using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    /// @brief Default constructor of the StackSoA class.
+    StackSoA() : size_(0)
+    {
+    }
+
+    /// @brief Returns whether the StackSoA is empty.
+    /// @return True if empty, else False
+    bool empty() const noexcept
+    {
+        return (size_ == 0UL);
+    }
+
+    /// @brief Gets the number of records in the StackSoA.
+    /// @return Current data size.
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /// @brief Get the capacity of StackSoA
+    /// @return Maximum number of records that StackSoA can hold
+    size_type max_size() const noexcept
+    {
+        return N;
+    }
+
+    /// @brief Resizes StackSoA to 0
+    void clear() noexcept
+    {
+        size_ = 0UL;
+    }
+
+    /// @brief Contiguous view of the live values of a single field.
+    /// @tparam I Index of the field.
+    /// @return Span over the first size() values of the field.
+    template <std::size_t I> std::span<field_type<I>> field() noexcept
+    {
+        return std::span<field_type<I>>(std::get<I>(columns_).values.data(), size_);
+    }
+
+    /// @brief Contiguous read-only view of the live values of a single field.
+    /// @tparam I Index of the field.
+    /// @return Span over the first size() values of the field.
+    template <std::size_t I> std::span<const field_type<I>> field() const noexcept
+    {
+        return std::span<const field_type<I>>(std::get<I>(columns_).values.data(), size_);
+    }
+
+    /// @brief Add a record to the end of StackSoA
+    /// @param ...values Values of the record fields.
+    /// @throws std::overflow_error if the StackSoA is full.
+    template <typename... Values> void push_back(Values &&...values)
+    {
+        static_assert(sizeof...(Values) == sizeof...(Fields), "push_back requires a value for every field");
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackSoA is full");
+        }
+        assignRecord(size_, Indices{}, std::forward<Values>(values)...);
+        ++size_;
+    }
+
+    /// @brief Remove one record from the end of the StackSoA.
+    /// @throws std::underflow_error if the StackSoA is empty.
+    void pop_back()
+    {
+        if (empty())
+        {
+            throw std::underflow_error("StackSoA is empty");
+        }
+        --size_;
+    }
+
+    /// @brief Insert a record at a specified position.
+    /// @param pos Position of the StackSoA where the new record is inserted.
+    /// @param ...values Values of the record fields.
+    /// @return Iterator that points to the inserted record.
+    /// @throws std::overflow_error if the StackSoA is full.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    template <typename... Values> iterator insert(const_iterator pos, Values &&...values)
+    {
+        static_assert(sizeof...(Values) == sizeof...(Fields), "insert requires a value for every field");
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackSoA is full");
+        }
+        if (pos < cbegin() || pos > cend())
+        {
+            throw std::out_of_range("Insert position out of range");
+        }
+
+        // Construct the record first: the values may refer to records that are about to be shifted
+        value_type record(std::forward<Values>(values)...);
+        const size_type index = pos.index();
+        shiftRight(index, Indices{});
+        moveRecord(index, Indices{}, record);
+        ++size_;
+
+        return iterator(this, index);
+    }
+
+    /// @brief Removes from the StackSoA a single record.
+    /// @param pos Position of the record to be removed.
+    /// @return Iterator following the removed record.
+    /// @throws std::out_of_range if invalid position is provided.
+    iterator erase(const_iterator pos)
+    {
+        if (pos < cbegin() || pos >= cend())
+        {
+            throw std::out_of_range("Invalid iterator position");
+        }
+        return erase(pos, pos + 1);
+    }
+
+    /// @brief Removes from the StackSoA a range of records [first, last).
+    /// @param first Position of the first record to be removed.
+    /// @param last Position of last non-inclusive record.
+    /// @return Iterator following the removed records.
+    /// @throws std::out_of_range if invalid position is provided.
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        if (first < cbegin() || first > last || last > cend())
+        {
+            throw std::out_of_range("Invalid iterator range");
+        }
+
+        shiftLeft(first.index(), last.index(), Indices{});
+        size_ -= static_cast<size_type>(last - first);
+
+        return iterator(this, first.index());
+    }
+
+    /// @brief Get references to the fields of the record stored at the specified position.
+    /// @param index Index to the record stored in the StackSoA.
+    /// @return Tuple of non-const references to the fields.
+    reference operator[](size_type index) noexcept
+    {
+        return recordAt(index, Indices{});
+    }
+
+    /// @brief Get constant references to the fields of the record stored at the specified position.
+    /// @param index Index to the record stored in the StackSoA.
+    /// @return Tuple of const references to the fields.
+    const_reference operator[](size_type index) const noexcept
+    {
+        return recordAt(index, Indices{});
+    }
+
+    /// @brief Get references to the fields of the record stored at the specified position.
+    /// @param index Index to the record stored in the StackSoA.
+    /// @return Tuple of non-const references to the fields.
+    /// @throws std::out_of_range If the index is out of range.
+    reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackSoA index out of range");
+        }
+        return recordAt(index, Indices{});
+    }
+
+    /// @brief Get constant references to the fields of the record stored at the specified position.
+    /// @param index Index to the record stored in the StackSoA.
+    /// @return Tuple of const references to the fields.
+    /// @throws std::out_of_range If the index is out of range.
+    const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackSoA index out of range");
+        }
+        return recordAt(index, Indices{});
+    }
+
+    /// @brief Returns a zipped iterator pointing to the first record in the StackSoA.
+    iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+
+    /// @brief Returns a zipped const iterator pointing to the first record in the StackSoA.
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns a zipped const iterator pointing to the first record in the StackSoA.
+    const_iterator cbegin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+
+    /// @brief Returns a zipped iterator referring to the record one past the end position of the StackSoA.
+    iterator end() noexcept
+    {
+        return iterator(this, size_);
+    }
+
+    /// @brief Returns a zipped const iterator referring to the record one past the end position of the StackSoA.
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, size_);
+    }
+
+    /// @brief Returns a zipped const iterator referring to the record one past the end position of the StackSoA.
+    const_iterator cend() const noexcept
+    {
+        return const_iterator(this, size_);
+    }
+
+    /// @brief Returns references to the fields of the first record in the StackSoA.
+    /// @throws std::out_of_range if the StackSoA is empty.
+    reference front()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackSoA is empty");
+        }
+        return recordAt(0, Indices{});
+    }
+
+    /// @brief Returns references to the fields of the last record in the StackSoA.
+    /// @throws std::out_of_range if the StackSoA is empty.
+    reference back()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackSoA is empty");
+        }
+        return recordAt(size_ - 1, Indices{});
+    }
+
+  private:
+    template <std::size_t... Is> reference recordAt(size_type index, std::index_sequence<Is...>) noexcept
+    {
+        return reference(std::get<Is>(columns_).values[index]...);
+    }
+
+    template <std::size_t... Is> const_reference recordAt(size_type index, std::index_sequence<Is...>) const noexcept
+    {
+        return const_reference(std::get<Is>(columns_).values[index]...);
+    }
+
+    template <std::size_t... Is, typename... Values>
+    void assignRecord(size_type index, std::index_sequence<Is...>, Values &&...values)
+    {
+        ((std::get<Is>(columns_).values[index] = std::forward<Values>(values)), ...);
+    }
+
+    template <std::size_t... Is> void moveRecord(size_type index, std::index_sequence<Is...>, value_type &record)
+    {
+        ((std::get<Is>(columns_).values[index] = std::move(std::get<Is>(record))), ...);
+    }
+
+    /// @brief Shifts the records [index, size()) of every field one position towards the end.
+    template <std::size_t... Is> void shiftRight(size_type index, std::index_sequence<Is...>)
+    {
+        (shiftColumnRight(std::get<Is>(columns_).values, index), ...);
+    }
+
+    template <typename Array> void shiftColumnRight(Array &values, size_type index)
+    {
+        std::move_backward(values.begin() + index, values.begin() + size_, values.begin() + size_ + 1);
+    }
+
+    /// @brief Moves the records [last, size()) of every field down onto first.
+    template <std::size_t... Is> void shiftLeft(size_type first, size_type last, std::index_sequence<Is...>)
+    {
+        (std::move(std::get<Is>(columns_).values.begin() + last, std::get<Is>(columns_).values.begin() + size_,
+                   std::get<Is>(columns_).values.begin() + first),
+         ...);
+    }
+
+    std::tuple<Column<Fields>...> columns_;
+    size_type size_;
+};
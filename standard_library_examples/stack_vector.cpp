@@ -1,434 +1,214 @@
-#include <algorithm>        // std::move_backward
-#include <array>            // std::array
-#include <cstddef>          // std::ptrdiff_t
-#include <cstdint>          // std::size_t
-#include <initializer_list> // std::initializer_list
-#include <iostream>         // std::cout
-#include <iterator>         // std::reverse_iterator, std::distance
-#include <stdexcept>        // std::overflow_error, std::underflow_error
-#include <string_view>      // std::swap
-#include <utility>          // std::move
-
-/// @brief StackVector is a wrapper class around std::array that implements stack allocated resizable vector
-/// @tparam T Type of the values
-/// @tparam N Number of elements
-template <typename T, std::size_t N> class StackVector final
-{
-  public:
-    using value_type = T;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
-    using reference = value_type &;
-    using const_reference = const value_type &;
-    using pointer = value_type *;
-    using const_pointer = const value_type *;
-    using iterator = pointer;
-    using const_iterator = const_pointer;
-    using reverse_iterator = std::reverse_iterator<iterator>;
-    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-
-    /// @brief Default constructor of the StackVector class.
-    StackVector() : size_(0)
-    {
-    }
+#include "stack_vector.hpp"
 
-    /// @brief Default destructor of the StackVector class.
-    ~StackVector()
-    {
-        size_ = 0;
-    }
+#include <cstdlib>   // EXIT_FAILURE
+#include <iostream>  // std::cout
+#include <iterator>  // std::istream_iterator
+#include <sstream>   // std::istringstream
+#include <stdexcept> // std::overflow_error, std::runtime_error
+#include <string>    // std::string
+#include <vector>    // std::vector
 
-    /// @brief Constructor of the StackVector class from the initializer list.
-    /// @param initializer_list initializer list to move data from to the StackVector's data.
-    StackVector(std::initializer_list<T> initializer_list)
-    {
-        if (initializer_list.size() > N)
-        {
-            throw std::overflow_error("Initializer list too large for StackVector");
-        }
-        size_ = initializer_list.size();
-        std::move(std::make_move_iterator(initializer_list.begin()), std::make_move_iterator(initializer_list.end()),
-                  data_.begin());
-    }
+// Compile-time checks: StackVector is built, mutated and read back entirely during constant evaluation
 
-    /// @brief Copy constructor.
-    /// @param other The object to copy data from.
-    StackVector(const StackVector &other) : data_(other.data_), size_(other.size_)
-    {
-    }
-
-    /// @brief Copy assignment operator.
-    /// @param other The object to copy data from.
-    /// @return New StackVector object constructed from copying data from the other StackVector.
-    StackVector &operator=(const StackVector &other)
+/// @brief Generates the first Count prime numbers at compile time.
+template <std::size_t Count> constexpr StackVector<int, Count> makePrimeTable()
+{
+    StackVector<int, Count> primes;
+    for (int candidate = 2; primes.size() < Count; ++candidate)
     {
-        if (this == &other)
+        bool is_prime = true;
+        for (const auto prime : primes)
         {
-            return *this;
+            if (prime * prime > candidate)
+            {
+                break;
+            }
+            if (candidate % prime == 0)
+            {
+                is_prime = false;
+                break;
+            }
         }
-
-        data_ = other.data_;
-        size_ = other.size_;
-
-        return *this;
-    }
-
-    /// @brief Move constructor.
-    /// @param other Other StackVector to move data from.
-    StackVector(StackVector &&other) noexcept : data_(std::move(other.data_)), size_(other.size_)
-    {
-        other.size_ = 0;
-    }
-
-    /// @brief Move operator.
-    /// @param other Other StackVector to move data from.
-    /// @return Moved StackVector.
-    StackVector &operator=(StackVector &&other) noexcept
-    {
-        if (this == &other)
+        if (is_prime)
         {
-            return *this;
+            primes.push_back(candidate);
         }
-
-        data_ = std::move(other.data_);
-        size_ = other.size_;
-        other.size_ = 0;
-
-        return *this;
     }
+    return primes;
+}
 
-    /// @brief Swap data between two StackVector objects.
-    /// @param other Other StackVector to exchange data with.
-    void swap(StackVector &other) noexcept
-    {
-        data_.swap(other.data_);
-        std::swap(size_, other.size_);
-    }
-
-    /// @brief Returns whether the StackVector is empty.
-    /// @return True if empty, else False
-    bool empty() const noexcept
-    {
-        return (size_ == 0UL);
-    }
-
-    /// @brief Gets the number of elements in the StackVector.
-    /// @return Current data size.
-    size_type size() const noexcept
-    {
-        return size_;
-    }
+constexpr auto prime_table = makePrimeTable<10>();
+static_assert(prime_table.size() == 10);
+static_assert(prime_table.front() == 2 && prime_table[4] == 11 && prime_table.back() == 29);
 
-    /// @brief Get the capacity of StackVector
-    /// @return Maximum number of elements that StackVector can hold
-    size_type max_size() const noexcept
-    {
-        return N;
-    }
-
-    /// @brief Resizes StackVector to 0
-    void clear() noexcept
+constexpr bool testMutation()
+{
+    StackVector<int, 8> vec = {1, 2, 3};
+    vec.insert(vec.begin() + 1, 10);
+    vec.emplace(vec.begin(), 20);
+    vec.erase(vec.begin() + 2);
+    vec.pop_back();
+    vec.resize(5, 7);
+    // 20 1 2 7 7
+    if (vec.size() != 5 || vec[0] != 20 || vec[1] != 1 || vec[2] != 2 || vec[4] != 7)
     {
-        size_ = 0UL;
+        return false;
     }
 
-    /// @brief Add a value to the end of StackVector
-    /// @param value Value to be copied
-    /// @throws std::overflow_error if the StackVector is full.
-    void push_back(const T &value)
-    {
-        if (size_ >= N)
-        {
-            throw std::overflow_error("StackVector is full");
-        }
-        data_[size_++] = value;
-    }
+    const int extra[] = {4, 5, 6};
+    vec.insert(vec.begin() + 1, extra, extra + 3);
+    vec.erase(vec.begin() + 5, vec.end());
+    // 20 4 5 6 1
+    StackVector<int, 8> copy = vec;
+    copy.swap(vec);
+    vec.clear();
+    return vec.empty() && copy.size() == 5 && copy[1] == 4 && copy[4] == 1 && copy.at(3) == 6;
+}
 
-    /// @brief Move a value to the end of the StackVector.
-    /// @param value Value to be moved.
-    /// @throws std::overflow_error if the StackVector is full.
-    void push_back(T &&value)
-    {
-        if (size_ >= N)
-        {
-            throw std::overflow_error("StackVector is full");
-        }
-        data_[size_++] = std::move(value);
-    }
+static_assert(testMutation());
 
-    /// @brief Add a value to the end of the StackVector.
-    /// @tparam ...Args Argument types forwarded to construct the new element.
-    /// @param ...args Argument values forwarded to construct the new element.
-    /// @throws std::overflow_error if the StackVector is full.
-    template <typename... Args> void emplace_back(Args &&...args)
+constexpr bool testNonTrivialElements()
+{
+    struct Counter
     {
-        if (size_ >= N)
+        constexpr explicit Counter(int *live) : live(live)
         {
-            throw std::overflow_error("StackVector is full");
+            ++*live;
         }
-        data_[size_++] = T(std::forward<Args>(args)...);
-    }
 
-    /// @brief Construct and insert element at the specified position of the StackVector.
-    /// @tparam ...Args Argument types forwarded to construct the new element.
-    /// @param pos Random access iterator position that points to the insertion position in the StackVector.
-    /// @param ...args Argument values forwarded to construct the new element.
-    /// @return Updated Pointer to the StackVector data.
-    /// @throws std::out_of_range if either maximum size of the StackVector was exceeded or the invalid iterator
-    /// position was provided.
-    template <typename... Args> iterator emplace(iterator pos, Args &&...args)
-    {
-        if (size_ >= N)
+        constexpr Counter(const Counter &other) : live(other.live)
         {
-            throw std::out_of_range("StackVector maximum size exceeded");
+            ++*live;
         }
 
-        if (pos < begin() || pos > end())
-        {
-            throw std::out_of_range("Invalid iterator position");
-        }
+        constexpr Counter &operator=(const Counter &other) = default;
 
-        if (pos != end())
+        constexpr ~Counter()
         {
-            std::move_backward(pos, end(), end() + 1);
+            --*live;
         }
-        *pos = T(std::forward<Args>(args)...);
 
-        ++size_;
-        return pos;
-    }
+        int *live;
+    };
 
-    /// @brief Remove one element from the end of the StackVector.
-    /// @throws std::underflow_error if the StackVector is empty.
-    void pop_back()
+    int live = 0;
     {
-        if (empty())
+        StackVector<Counter, 4> counters;
+        counters.emplace_back(&live);
+        counters.emplace_back(&live);
+        counters.insert(counters.begin(), Counter(&live));
+        counters.erase(counters.begin() + 1);
+        if (live != 2)
         {
-            throw std::underflow_error("StackVector is empty");
+            return false;
         }
-        --size_;
     }
+    return live == 0;
+}
 
-    /// @brief Insert an element at a specified position.
-    /// @param pos Position of the StackVector where the new elements are inserted provided as a random access iterator.
-    /// @param value Value to be copied to the inserted elements.
-    /// @return Random access iterator that points to elements.
-    /// @throws std::overflow_error if the StackVector is full.
-    /// @throws std::out_of_range error if the provided insert position is out of range.
-    iterator insert(iterator pos, const T &value)
-    {
-        if (size_ >= N)
-        {
-            throw std::overflow_error("StackVector is full");
-        }
-        if (pos < begin() || pos > end())
-        {
-            throw std::out_of_range("Insert position out of range");
-        }
-
-        std::move_backward(pos, end(), end() + 1);
-        *pos = value;
-        ++size_;
-
-        return pos;
-    }
+static_assert(testNonTrivialElements());
 
-    /// @brief Insert an element at a specified position.
-    /// @param pos Position of the StackVector where the new elements are inserted provided as a random access iterator.
-    /// @param value Value to be moved to the inserted elements.
-    /// @return Random access iterator that points to elements.
-    /// @throws std::overflow_error if the StackVector is full.
-    /// @throws std::out_of_range error if the provided insert position is out of range.
-    iterator insert(iterator pos, T &&value)
+/// @brief Element whose copies throw once a budget is used up and that counts the live objects.
+struct ThrowingCopy
+{
+    explicit ThrowingCopy(int value) : value(value)
     {
-        if (size_ >= N)
-        {
-            throw std::overflow_error("StackVector is full");
-        }
-        if (pos < begin() || pos > end())
-        {
-            throw std::out_of_range("Insert position out of range");
-        }
-
-        std::move_backward(pos, end(), end() + 1);
-        *pos = std::move(value);
-        ++size_;
-
-        return pos;
+        ++live;
     }
 
-    /// @brief Removes from the StackVector a single element.
-    /// @param pos Random access iterator position corresponding to the element to be removed.
-    /// @return New access iterator with a removed element.
-    /// @throws std::out_of_range if invalid position is provided.
-    iterator erase(iterator pos)
+    ThrowingCopy(const ThrowingCopy &other) : value(other.value)
     {
-        if (pos < begin() || pos >= end())
-        {
-            throw std::out_of_range("Invalid iterator position");
-        }
-
-        iterator next = pos + 1;
-        std::move(next, end(), pos);
-        --size_;
-
-        return pos;
+        spendCopy();
+        ++live;
     }
 
-    /// @brief Removes from the StackVector a range of elements [first, last).
-    /// @param first Random access iterator type to the first element to be removed.
-    /// @param last Random access iterator type to last non-inclusive element.
-    /// @return New access iterator with removed elements.
-    /// @throws std::out_of_range if invalid position is provided.
-    iterator erase(iterator first, iterator last)
+    ThrowingCopy(ThrowingCopy &&other) noexcept : value(other.value)
     {
-        if (first < begin() || first > last || last > end())
-        {
-            throw std::out_of_range("Invalid iterator range");
-        }
-
-        iterator new_end = std::move(last, end(), first);
-        size_ -= std::distance(first, last);
-
-        return first;
+        ++live;
     }
 
-    /// @brief Get a reference to the element stored at the specified position.
-    /// @param index Index to the element stored in the StackVector.
-    /// @return Non-const reference to the element in the data.
-    reference operator[](size_type index) noexcept
+    ThrowingCopy &operator=(const ThrowingCopy &other)
     {
-        return data_[index];
+        spendCopy();
+        value = other.value;
+        return *this;
     }
 
-    /// @brief Get a constant reference to the element stored at the specified position.
-    /// @param index Index to the element stored in the StackVector.
-    /// @return Const reference to the element in the data.
-    const_reference operator[](size_type index) const noexcept
+    ThrowingCopy &operator=(ThrowingCopy &&other) noexcept = default;
+
+    ~ThrowingCopy()
     {
-        return data_[index];
+        --live;
     }
 
-    /// @brief Get a reference to the element stored at the specified position.
-    /// @param index Index to the element stored in the StackVector.
-    /// @return Non-const reference to the element in the data.
-    /// @throws std::out_of_range If the index is out of range.
-    reference at(size_type index) const
+    static void spendCopy()
     {
-        if (index >= size_)
+        if (copies_left-- == 0)
         {
-            throw std::out_of_range("StackVector index out of range");
+            throw std::runtime_error("Copy failed");
         }
-        return data_[index];
-    }
-
-    /// @brief Returns an iterator pointing to the first element in the StackVector.
-    /// @return Non-const pointer to the first position of the data stored within the StackVector.
-    iterator begin() noexcept
-    {
-        return data_.data();
     }
 
-    /// @brief Returns an iterator pointing to the first element in the StackVector.
-    /// @return Const pointer to the first position of the data stored within the StackVector.
-    const_iterator cbegin() const noexcept
-    {
-        return data_.data();
-    }
-
-    /// @brief Returns an iterator referring to the element one past the end position of the StackVector.
-    /// @return Non-const pointer to the past-the-end position of the data stored within the StackVector.
-    iterator end() noexcept
-    {
-        return data_.data() + size_;
-    }
-
-    /// @brief Returns an iterator referring to the element one past the end position of the StackVector.
-    /// @return Const pointer to the past-the-end position of the data stored within the StackVector.
-    const_iterator cend() const noexcept
-    {
-        return data_.data() + size_;
-    }
-
-    /// @brief Returns a reverse iterator pointing to the last element in the StackVector.
-    /// @return Non-const pointer to the last element of the data stored within the StackVector.
-    reverse_iterator rbegin() noexcept
-    {
-        return reverse_iterator(end());
-    }
-
-    /// @brief Returns a const reverse iterator pointing to the last element in the StackVector.
-    /// @return Const pointer to the last element of the data stored within the StackVector.
-    const_reverse_iterator crbegin() const noexcept
-    {
-        return const_reverse_iterator(end());
-    }
-
-    /// @brief Returns a reverse iterator pointing to the before the start element in the StackVector.
-    /// @return Non-const pointer to the element of the data stored within the StackVector preceding the first element.
-    reverse_iterator rend() noexcept
-    {
-        return reverse_iterator(begin());
-    }
+    int value;
+    static inline int live = 0;
+    static inline int copies_left = 0;
+};
 
-    /// @brief Returns a const reverse iterator pointing to the before the start element in the StackVector.
-    /// @return Const pointer to the element of the data stored within the StackVector preceding the first element.
-    const_reverse_iterator crend() const noexcept
+/// @brief Checks that a range insert that throws part-way leaves no element behind that the StackVector does not own.
+bool testInsertRollback()
+{
+    std::vector<ThrowingCopy> source;
+    source.reserve(3);
+    for (int value = 10; value < 13; ++value)
     {
-        return const_reverse_iterator(begin());
+        source.emplace_back(value);
     }
-
-    /// @brief Returns the non-const reference to the first element in the StackVector.
-    /// @throws std::out_of_range if the StackVector is empty.
-    reference front()
-    {
-        if (empty())
+    const auto insertThrows = [&source](std::size_t size, std::size_t offset, std::size_t count, int copies) {
+        StackVector<ThrowingCopy, 8> vec;
+        for (std::size_t i = 0; i < size; ++i)
         {
-            throw std::out_of_range("StackVector is empty");
+            vec.emplace_back(static_cast<int>(i));
         }
-        return data_[0];
-    }
-
-    /// @brief Returns the const reference to the first element in the StackVector.
-    /// @throws std::out_of_range if the StackVector is empty.
-    const_reference front() const
-    {
-        if (empty())
+        ThrowingCopy::copies_left = copies;
+        try
         {
-            throw std::out_of_range("StackVector is empty");
+            vec.insert(vec.begin() + offset, source.begin(), source.begin() + count);
         }
-        return data_[0];
-    }
-
-    /// @brief Returns the non-const reference to the last element in the StackVector.
-    /// @throws std::out_of_range if the StackVector is empty.
-    reference back()
-    {
-        if (empty())
+        catch (const std::runtime_error &)
         {
-            throw std::out_of_range("StackVector is empty");
+            return ThrowingCopy::live == static_cast<int>(vec.size() + source.size());
         }
-        return data_[size_ - 1];
+        return false;
+    };
+    // The last copy assignment throws after the tail was moved into uninitialized storage, once with the inserted
+    // range inside the old elements and once reaching past them
+    if (!insertThrows(4, 0, 2, 1) || !insertThrows(3, 2, 3, 2))
+    {
+        return false;
     }
 
-    /// @brief Returns the const reference to the last element in the StackVector.
-    /// @throws std::out_of_range if the StackVector is empty.
-    const_reference back() const
+    // A single pass range that overflows is rolled back to the old elements
+    StackVector<int, 4> vec = {1, 2, 3};
+    std::istringstream input("4 5 6");
+    try
     {
-        if (empty())
-        {
-            throw std::out_of_range("StackVector is empty");
-        }
-        return data_[size_ - 1];
+        vec.insert(vec.begin(), std::istream_iterator<int>(input), std::istream_iterator<int>());
     }
-
-  private:
-    std::array<T, N> data_;
-    size_type size_;
-};
+    catch (const std::overflow_error &)
+    {
+        return vec.size() == 3 && vec[0] == 1 && vec[1] == 2 && vec[2] == 3;
+    }
+    return false;
+}
 
 int main()
 {
+    if (!testInsertRollback())
+    {
+        std::cout << "A throwing range insert left the StackVector inconsistent" << std::endl;
+        return EXIT_FAILURE;
+    }
+
     StackVector<int, 10> vec;
 
     // Add elements to the StackVector
@@ -497,8 +277,45 @@ int main()
     std::cout << vec2.front() << std::endl;
     std::cout << vec2.back() << std::endl;
 
+    // Elements are constructed in place and destroyed on removal, so non-trivial types are handled correctly
+    StackVector<std::string, 8> words;
+    words.emplace_back(3, 'a');
+    words.emplace_back("stack");
+    words.insert(words.begin(), "first");
+    words.emplace(words.begin() + 1, "second");
+    words.erase(words.begin() + 2);
+    for (const auto &word : words)
+    {
+        std::cout << word << " ";
+    }
+    std::cout << std::endl;
+
+    // Bulk operations check the capacity once and copy contiguous ranges in one go
+    const std::vector<int> source = {7, 8, 9};
+    StackVector<int, 16> vec4;
+    vec4.assign(source.begin(), source.end());
+    vec4.append_range(source);
+    vec4.insert(vec4.begin() + 1, source.begin(), source.end());
+    vec4.resize(vec4.size() + 2);
+    vec4.resize(vec4.size() + 2, -1);
+    for (const auto &val : vec4)
+    {
+        std::cout << val << " ";
+    }
+    std::cout << std::endl;
+
+    // Lookup table generated at compile time
+    for (const auto &prime : prime_table)
+    {
+        std::cout << prime << " ";
+    }
+    std::cout << std::endl;
+
+    // 4 GB of ints do not fit on any thread stack, so this StackVector keeps its elements in one heap block
     StackVector<int, 1'000'000'000> vec3;
-    std::cout << "Size of the vector: " << vec3.max_size() << std::endl;
+    vec3.push_back(42);
+    std::cout << "Size of the vector: " << vec3.max_size() << ", inline storage: " << vec3.inline_storage
+              << ", front: " << vec3.front() << std::endl;
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,1063 @@
+#pragma once
+
+#include <algorithm>        // std::move_backward, std::copy, std::rotate
+#include <cassert>          // assert
+#include <cstddef>          // std::ptrdiff_t
+#include <cstdint>          // std::size_t
+#include <cstring>          // std::memcpy, std::memmove
+#include <initializer_list> // std::initializer_list
+#include <iterator>         // std::reverse_iterator, std::distance, std::iterator_traits, std::data, std::size
+#include <limits>           // std::numeric_limits
+#include <memory>           // std::allocator, std::construct_at, std::destroy, std::uninitialized_copy
+#include <new>              // std::align_val_t
+#include <stdexcept>        // std::overflow_error, std::underflow_error
+#include <type_traits>      // std::is_constant_evaluated, std::is_trivially_copyable_v, std::conditional_t
+#include <utility>          // std::move, std::swap
+
+/// @brief Storage alignment that allows aligned 256-bit (AVX/AVX2) loads and stores of StackVector elements.
+inline constexpr std::size_t stack_vector_simd_alignment = 32;
+
+/// @brief Storage alignment of one cache line, which also pads a StackVector to a whole number of cache lines.
+inline constexpr std::size_t stack_vector_cache_line_alignment = 64;
+
+/// @brief Largest element storage, in bytes, that a StackVector keeps inline by default. Thread stacks can be as small
+/// as 512 KiB (macOS secondary threads) or 1 MiB (Windows), so larger capacities are moved to the heap.
+inline constexpr std::size_t stack_vector_max_inline_bytes = 256 * 1024;
+
+/// @brief StackVector is a stack allocated resizable vector with a fixed capacity. Elements live in uninitialized
+/// storage and are only constructed when inserted, so creating a StackVector costs O(size()) rather than O(N) and T
+/// does not need to be default constructible. For trivially copyable T, copies, moves and element shifts are done
+/// with memcpy/memmove over the live size() prefix only. The whole container is constexpr (C++20), so it can be
+/// built, mutated and read back during constant evaluation, e.g. to generate lookup tables at compile time.
+/// If N elements of T take more than MaxInlineBytes, the storage is instead a single heap block of N elements that is
+/// allocated when the StackVector is created and never reallocated, so the capacity stays fixed and element
+/// addresses stay stable, but a huge capacity cannot overflow the stack.
+/// @tparam T Type of the values
+/// @tparam N Number of elements
+/// @tparam Alignment Alignment of the element storage and of the StackVector object itself. Use
+/// stack_vector_simd_alignment for aligned SIMD loads and stack_vector_cache_line_alignment to also pad the object to
+/// whole cache lines, so that StackVectors owned by different threads never share a cache line.
+/// @tparam MaxInlineBytes Largest element storage, in bytes, that is kept inside the StackVector object.
+template <typename T, std::size_t N, std::size_t Alignment = alignof(T),
+          std::size_t MaxInlineBytes = stack_vector_max_inline_bytes>
+class alignas(Alignment) StackVector final
+{
+    static_assert((Alignment & (Alignment - 1)) == 0, "StackVector alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "StackVector alignment must not be weaker than the alignment of T");
+    static_assert(N <= std::numeric_limits<std::size_t>::max() / sizeof(T), "StackVector capacity is too large");
+
+    template <typename InputIt>
+    using RequireInputIterator = std::enable_if_t<
+        std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>>;
+
+    template <typename Range, typename = void> struct HasData : std::false_type
+    {
+    };
+
+    template <typename Range>
+    struct HasData<Range, std::void_t<decltype(std::data(std::declval<const Range &>())),
+                                      decltype(std::size(std::declval<const Range &>()))>> : std::true_type
+    {
+    };
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /// @brief Whether the elements are stored inside the StackVector object rather than in a heap block.
+    static constexpr bool inline_storage = (N * sizeof(T) <= MaxInlineBytes);
+
+    /// @brief Default constructor of the StackVector class.
+    constexpr StackVector() = default;
+
+    /// @brief Destructor of the StackVector class, destroys all constructed elements.
+    constexpr ~StackVector()
+    {
+        clear();
+    }
+
+    /// @brief Constructor of the StackVector class from the initializer list.
+    /// @param initializer_list initializer list to copy data from to the StackVector's data.
+    /// @throws std::overflow_error if the initializer list holds more than N elements.
+    constexpr StackVector(std::initializer_list<T> initializer_list)
+    {
+        if (initializer_list.size() > N)
+        {
+            throw std::overflow_error("Initializer list too large for StackVector");
+        }
+        uninitializedCopy(initializer_list.begin(), initializer_list.end(), data());
+        size_ = initializer_list.size();
+    }
+
+    /// @brief Copy constructor. Only the constructed elements of the other StackVector are copied.
+    /// @param other The object to copy data from.
+    constexpr StackVector(const StackVector &other)
+    {
+        copyFrom(other);
+    }
+
+    /// @brief Copy assignment operator.
+    /// @param other The object to copy data from.
+    /// @return New StackVector object constructed from copying data from the other StackVector.
+    constexpr StackVector &operator=(const StackVector &other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        copyFrom(other);
+
+        return *this;
+    }
+
+    /// @brief Move constructor. The elements are moved one by one, also for heap storage, since every StackVector
+    /// owns its storage for its whole lifetime.
+    /// @param other Other StackVector to move data from.
+    constexpr StackVector(StackVector &&other) noexcept(inline_storage && std::is_nothrow_move_constructible_v<T>)
+    {
+        moveFrom(other);
+    }
+
+    /// @brief Move operator. With heap storage the two blocks are exchanged instead of moving the elements.
+    /// @param other Other StackVector to move data from.
+    /// @return Moved StackVector.
+    constexpr StackVector &operator=(StackVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        if constexpr (inline_storage)
+        {
+            moveFrom(other);
+        }
+        else
+        {
+            std::swap(storage_.elements, other.storage_.elements);
+            std::swap(size_, other.size_);
+        }
+
+        return *this;
+    }
+
+    /// @brief Swap data between two StackVector objects.
+    /// @param other Other StackVector to exchange data with.
+    constexpr void swap(StackVector &other) noexcept(std::is_nothrow_swappable_v<T> &&
+                                                     std::is_nothrow_move_constructible_v<T>)
+    {
+        if constexpr (!inline_storage)
+        {
+            std::swap(storage_.elements, other.storage_.elements);
+            std::swap(size_, other.size_);
+            return;
+        }
+
+        StackVector &shorter = (size_ < other.size_) ? *this : other;
+        StackVector &longer = (size_ < other.size_) ? other : *this;
+
+        // Swap the common prefix in place, then move the remaining tail of the longer vector over
+        for (size_type i = 0; i < shorter.size_; ++i)
+        {
+            using std::swap;
+            swap(shorter.data()[i], longer.data()[i]);
+        }
+        for (size_type i = shorter.size_; i < longer.size_; ++i)
+        {
+            std::construct_at(shorter.data() + i, std::move(longer.data()[i]));
+        }
+        destroyRange(longer.data() + shorter.size_, longer.data() + longer.size_);
+        std::swap(size_, other.size_);
+    }
+
+    /// @brief Returns whether the StackVector is empty.
+    /// @return True if empty, else False
+    constexpr bool empty() const noexcept
+    {
+        return (size_ == 0UL);
+    }
+
+    /// @brief Gets the number of elements in the StackVector.
+    /// @return Current data size.
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /// @brief Get the capacity of StackVector
+    /// @return Maximum number of elements that StackVector can hold
+    constexpr size_type max_size() const noexcept
+    {
+        return N;
+    }
+
+    /// @brief Destroys all elements and resizes StackVector to 0
+    constexpr void clear() noexcept
+    {
+        destroyRange(begin(), end());
+        size_ = 0UL;
+    }
+
+    /// @brief Add a value to the end of StackVector
+    /// @param value Value to be copied
+    /// @throws std::overflow_error if the StackVector is full.
+    constexpr void push_back(const T &value)
+    {
+        emplace_back(value);
+    }
+
+    /// @brief Move a value to the end of the StackVector.
+    /// @param value Value to be moved.
+    /// @throws std::overflow_error if the StackVector is full.
+    constexpr void push_back(T &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    /// @brief Construct a value in place at the end of the StackVector.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the constructed element.
+    /// @throws std::overflow_error if the StackVector is full.
+    template <typename... Args> constexpr reference emplace_back(Args &&...args)
+    {
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackVector is full");
+        }
+        pointer element = std::construct_at(data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *element;
+    }
+
+    /// @brief Construct and insert element at the specified position of the StackVector.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param pos Random access iterator position that points to the insertion position in the StackVector.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Updated Pointer to the StackVector data.
+    /// @throws std::out_of_range if either maximum size of the StackVector was exceeded or the invalid iterator
+    /// position was provided.
+    template <typename... Args> constexpr iterator emplace(iterator pos, Args &&...args)
+    {
+        if (size_ >= N)
+        {
+            throw std::out_of_range("StackVector maximum size exceeded");
+        }
+
+        if (pos < begin() || pos > end())
+        {
+            throw std::out_of_range("Invalid iterator position");
+        }
+
+        if (pos == end())
+        {
+            std::construct_at(pos, std::forward<Args>(args)...);
+            ++size_;
+            return pos;
+        }
+
+        // Construct first: the arguments may refer to elements that are about to be shifted
+        T value(std::forward<Args>(args)...);
+        return insertShifted(pos, std::move(value));
+    }
+
+    /// @brief Remove one element from the end of the StackVector.
+    /// @throws std::underflow_error if the StackVector is empty.
+    constexpr void pop_back()
+    {
+        if (empty())
+        {
+            throw std::underflow_error("StackVector is empty");
+        }
+        --size_;
+        destroyAt(data() + size_);
+    }
+
+    /// @brief Add a value to the end of the StackVector without a capacity check. Intended for hot loops where the
+    /// caller guarantees that size() < max_size(); the precondition is only asserted in debug builds.
+    /// @param value Value to be copied
+    constexpr void unchecked_push_back(const T &value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        unchecked_emplace_back(value);
+    }
+
+    /// @brief Move a value to the end of the StackVector without a capacity check.
+    /// @param value Value to be moved.
+    constexpr void unchecked_push_back(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        unchecked_emplace_back(std::move(value));
+    }
+
+    /// @brief Construct a value in place at the end of the StackVector without a capacity check.
+    /// @tparam ...Args Argument types forwarded to construct the new element.
+    /// @param ...args Argument values forwarded to construct the new element.
+    /// @return Reference to the constructed element.
+    template <typename... Args>
+    constexpr reference unchecked_emplace_back(Args &&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        assert(size_ < N && "StackVector is full");
+        pointer element = std::construct_at(data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *element;
+    }
+
+    /// @brief Remove one element from the end of the StackVector without checking that it is not empty.
+    constexpr void unchecked_pop_back() noexcept
+    {
+        assert(!empty() && "StackVector is empty");
+        --size_;
+        destroyAt(data() + size_);
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the StackVector where the new elements are inserted provided as a random access iterator.
+    /// @param value Value to be copied to the inserted elements.
+    /// @return Random access iterator that points to elements.
+    /// @throws std::overflow_error if the StackVector is full.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    constexpr iterator insert(iterator pos, const T &value)
+    {
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackVector is full");
+        }
+        if (pos < begin() || pos > end())
+        {
+            throw std::out_of_range("Insert position out of range");
+        }
+
+        if (pos == end())
+        {
+            std::construct_at(pos, value);
+            ++size_;
+            return pos;
+        }
+
+        // Copy first: the value may refer to an element that is about to be shifted
+        T copy(value);
+        return insertShifted(pos, std::move(copy));
+    }
+
+    /// @brief Insert an element at a specified position.
+    /// @param pos Position of the StackVector where the new elements are inserted provided as a random access iterator.
+    /// @param value Value to be moved to the inserted elements.
+    /// @return Random access iterator that points to elements.
+    /// @throws std::overflow_error if the StackVector is full.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    constexpr iterator insert(iterator pos, T &&value)
+    {
+        if (size_ >= N)
+        {
+            throw std::overflow_error("StackVector is full");
+        }
+        if (pos < begin() || pos > end())
+        {
+            throw std::out_of_range("Insert position out of range");
+        }
+
+        if (pos == end())
+        {
+            std::construct_at(pos, std::move(value));
+            ++size_;
+            return pos;
+        }
+
+        return insertShifted(pos, std::move(value));
+    }
+
+    /// @brief Insert the elements of the range [first, last) at a specified position. The tail is shifted once by
+    /// the number of inserted elements.
+    /// @tparam InputIt Type of the iterators to the source range, which must not point into this StackVector.
+    /// @param pos Position of the StackVector where the new elements are inserted provided as a random access iterator.
+    /// @param first Iterator to the first element to insert.
+    /// @param last Iterator past the last element to insert.
+    /// @return Random access iterator that points to the first inserted element.
+    /// @throws std::overflow_error if the elements do not fit into the StackVector.
+    /// @throws std::out_of_range error if the provided insert position is out of range.
+    /// If an element throws, a single pass range leaves the StackVector as it was, and a forward range leaves it
+    /// valid, holding every element that was constructed so far.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr iterator insert(iterator pos, InputIt first, InputIt last)
+    {
+        if (pos < begin() || pos > end())
+        {
+            throw std::out_of_range("Insert position out of range");
+        }
+
+        if constexpr (!isForwardIterator<InputIt>())
+        {
+            // Single pass ranges cannot be measured up front, so they are appended and rotated into place
+            const size_type old_size = size_;
+            try
+            {
+                for (; first != last; ++first)
+                {
+                    emplace_back(*first);
+                }
+            }
+            catch (...)
+            {
+                // An overflow or a throwing element drops the appended part, so the order was never disturbed
+                destroyRange(begin() + old_size, end());
+                size_ = old_size;
+                throw;
+            }
+            std::rotate(pos, begin() + old_size, end());
+            return pos;
+        }
+        else
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count > N - size_)
+            {
+                throw std::overflow_error("StackVector is full");
+            }
+
+            if constexpr (isTriviallyCopyableSource<InputIt>())
+            {
+                moveBitwise(pos, static_cast<size_type>(end() - pos), pos + count);
+                copyBitwise(first, count, pos);
+                size_ += count;
+            }
+            else
+            {
+                // Every part constructed past the old end is counted in size_ at once, so that an exception from a
+                // later step leaves no element behind that the StackVector does not destroy
+                const auto tail = static_cast<size_type>(end() - pos);
+                const iterator old_end = end();
+                if (count <= tail)
+                {
+                    // The last count elements move into uninitialized storage, the rest are assigned
+                    uninitializedMove(old_end - count, old_end, old_end);
+                    size_ += count;
+                    std::move_backward(pos, old_end - count, old_end);
+                    std::copy(first, last, pos);
+                }
+                else
+                {
+                    // The inserted range reaches past the old end: part of it is constructed, part assigned
+                    InputIt middle = std::next(first, static_cast<difference_type>(tail));
+                    uninitializedCopy(middle, last, old_end);
+                    size_ += count - tail;
+                    uninitializedMove(pos, old_end, pos + count);
+                    size_ += tail;
+                    std::copy(first, middle, pos);
+                }
+            }
+            return pos;
+        }
+    }
+
+    /// @brief Replace the contents of the StackVector with the elements of the range [first, last).
+    /// @tparam InputIt Type of the iterators to the source range, which must not point into this StackVector.
+    /// @param first Iterator to the first element to copy.
+    /// @param last Iterator past the last element to copy.
+    /// @throws std::overflow_error if the elements do not fit into the StackVector.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr void assign(InputIt first, InputIt last)
+    {
+        if constexpr (isForwardIterator<InputIt>())
+        {
+            if (static_cast<size_type>(std::distance(first, last)) > N)
+            {
+                throw std::overflow_error("StackVector is full");
+            }
+        }
+        clear();
+        appendUnchecked(first, last);
+    }
+
+    /// @brief Append all elements of a range to the end of the StackVector. Ranges with contiguous storage, such as
+    /// std::vector, std::array and C arrays, are copied with a single memcpy for trivially copyable T.
+    /// @tparam Range Type of the source range, which must not be this StackVector.
+    /// @param range Range providing begin() and end(), and optionally data() and size().
+    /// @throws std::overflow_error if the elements do not fit into the StackVector.
+    template <typename Range> constexpr void append_range(const Range &range)
+    {
+        if constexpr (isContiguousRange<Range>())
+        {
+            const auto *first = std::data(range);
+            appendChecked(first, first + std::size(range));
+        }
+        else
+        {
+            appendChecked(std::begin(range), std::end(range));
+        }
+    }
+
+    /// @brief Resizes the StackVector to contain count elements. New elements are value-initialized.
+    /// @param count New size of the StackVector.
+    /// @throws std::overflow_error if count exceeds the capacity.
+    constexpr void resize(size_type count)
+    {
+        if (count > N)
+        {
+            throw std::overflow_error("StackVector is full");
+        }
+        if (count < size_)
+        {
+            destroyRange(begin() + count, end());
+        }
+        else
+        {
+            uninitializedValueConstruct(end(), begin() + count);
+        }
+        size_ = count;
+    }
+
+    /// @brief Resizes the StackVector to contain count elements. New elements are copies of value.
+    /// @param count New size of the StackVector.
+    /// @param value Value to initialize the new elements with.
+    /// @throws std::overflow_error if count exceeds the capacity.
+    constexpr void resize(size_type count, const T &value)
+    {
+        if (count > N)
+        {
+            throw std::overflow_error("StackVector is full");
+        }
+        if (count < size_)
+        {
+            destroyRange(begin() + count, end());
+        }
+        else
+        {
+            uninitializedFill(end(), begin() + count, value);
+        }
+        size_ = count;
+    }
+
+    /// @brief Removes from the StackVector a single element.
+    /// @param pos Random access iterator position corresponding to the element to be removed.
+    /// @return New access iterator with a removed element.
+    /// @throws std::out_of_range if invalid position is provided.
+    constexpr iterator erase(iterator pos)
+    {
+        if (pos < begin() || pos >= end())
+        {
+            throw std::out_of_range("Invalid iterator position");
+        }
+
+        iterator next = pos + 1;
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            moveBitwise(next, static_cast<size_type>(end() - next), pos);
+        }
+        else
+        {
+            std::move(next, end(), pos);
+            destroyAt(data() + size_ - 1);
+        }
+        --size_;
+
+        return pos;
+    }
+
+    /// @brief Removes from the StackVector a range of elements [first, last).
+    /// @param first Random access iterator type to the first element to be removed.
+    /// @param last Random access iterator type to last non-inclusive element.
+    /// @return New access iterator with removed elements.
+    /// @throws std::out_of_range if invalid position is provided.
+    constexpr iterator erase(iterator first, iterator last)
+    {
+        if (first < begin() || first > last || last > end())
+        {
+            throw std::out_of_range("Invalid iterator range");
+        }
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            moveBitwise(last, static_cast<size_type>(end() - last), first);
+        }
+        else
+        {
+            iterator new_end = std::move(last, end(), first);
+            destroyRange(new_end, end());
+        }
+        size_ -= std::distance(first, last);
+
+        return first;
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the StackVector.
+    /// @return Non-const reference to the element in the data.
+    constexpr reference operator[](size_type index) noexcept
+    {
+        return data()[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the StackVector.
+    /// @return Const reference to the element in the data.
+    constexpr const_reference operator[](size_type index) const noexcept
+    {
+        return data()[index];
+    }
+
+    /// @brief Get a reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the StackVector.
+    /// @return Non-const reference to the element in the data.
+    /// @throws std::out_of_range If the index is out of range.
+    constexpr reference at(size_type index)
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackVector index out of range");
+        }
+        return data()[index];
+    }
+
+    /// @brief Get a constant reference to the element stored at the specified position.
+    /// @param index Index to the element stored in the StackVector.
+    /// @return Const reference to the element in the data.
+    /// @throws std::out_of_range If the index is out of range.
+    constexpr const_reference at(size_type index) const
+    {
+        if (index >= size_)
+        {
+            throw std::out_of_range("StackVector index out of range");
+        }
+        return data()[index];
+    }
+
+    /// @brief Direct access to the underlying element storage.
+    /// @return Non-const pointer to the first element.
+    constexpr pointer data() noexcept
+    {
+        return storage_.elements;
+    }
+
+    /// @brief Direct access to the underlying element storage.
+    /// @return Const pointer to the first element.
+    constexpr const_pointer data() const noexcept
+    {
+        return storage_.elements;
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the StackVector.
+    /// @return Non-const pointer to the first position of the data stored within the StackVector.
+    constexpr iterator begin() noexcept
+    {
+        return data();
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the StackVector.
+    /// @return Const pointer to the first position of the data stored within the StackVector.
+    constexpr const_iterator begin() const noexcept
+    {
+        return data();
+    }
+
+    /// @brief Returns an iterator pointing to the first element in the StackVector.
+    /// @return Const pointer to the first position of the data stored within the StackVector.
+    constexpr const_iterator cbegin() const noexcept
+    {
+        return data();
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the StackVector.
+    /// @return Non-const pointer to the past-the-end position of the data stored within the StackVector.
+    constexpr iterator end() noexcept
+    {
+        return data() + size_;
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the StackVector.
+    /// @return Const pointer to the past-the-end position of the data stored within the StackVector.
+    constexpr const_iterator end() const noexcept
+    {
+        return data() + size_;
+    }
+
+    /// @brief Returns an iterator referring to the element one past the end position of the StackVector.
+    /// @return Const pointer to the past-the-end position of the data stored within the StackVector.
+    constexpr const_iterator cend() const noexcept
+    {
+        return data() + size_;
+    }
+
+    /// @brief Returns a reverse iterator pointing to the last element in the StackVector.
+    /// @return Non-const pointer to the last element of the data stored within the StackVector.
+    constexpr reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the last element in the StackVector.
+    /// @return Const pointer to the last element of the data stored within the StackVector.
+    constexpr const_reverse_iterator crbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    /// @brief Returns a reverse iterator pointing to the before the start element in the StackVector.
+    /// @return Non-const pointer to the element of the data stored within the StackVector preceding the first element.
+    constexpr reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    /// @brief Returns a const reverse iterator pointing to the before the start element in the StackVector.
+    /// @return Const pointer to the element of the data stored within the StackVector preceding the first element.
+    constexpr const_reverse_iterator crend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    /// @brief Returns the non-const reference to the first element in the StackVector.
+    /// @throws std::out_of_range if the StackVector is empty.
+    constexpr reference front()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackVector is empty");
+        }
+        return data()[0];
+    }
+
+    /// @brief Returns the const reference to the first element in the StackVector.
+    /// @throws std::out_of_range if the StackVector is empty.
+    constexpr const_reference front() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackVector is empty");
+        }
+        return data()[0];
+    }
+
+    /// @brief Returns the non-const reference to the last element in the StackVector.
+    /// @throws std::out_of_range if the StackVector is empty.
+    constexpr reference back()
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackVector is empty");
+        }
+        return data()[size_ - 1];
+    }
+
+    /// @brief Returns the const reference to the last element in the StackVector.
+    /// @throws std::out_of_range if the StackVector is empty.
+    constexpr const_reference back() const
+    {
+        if (empty())
+        {
+            throw std::out_of_range("StackVector is empty");
+        }
+        return data()[size_ - 1];
+    }
+
+  private:
+    /// @brief Returns whether the iterator type allows the range to be measured before it is copied.
+    template <typename InputIt> static constexpr bool isForwardIterator()
+    {
+        return std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>;
+    }
+
+    /// @brief Returns whether a range can be copied from the iterator type with memcpy.
+    template <typename InputIt> static constexpr bool isTriviallyCopyableSource()
+    {
+        if constexpr (std::is_pointer_v<InputIt>)
+        {
+            using source_type = std::remove_cv_t<std::remove_pointer_t<InputIt>>;
+            return std::is_trivially_copyable_v<T> && std::is_same_v<source_type, T>;
+        }
+        return false;
+    }
+
+    /// @brief Returns whether the range exposes its elements as one contiguous block through data() and size().
+    template <typename Range> static constexpr bool isContiguousRange()
+    {
+        return HasData<Range>::value;
+    }
+
+    /// @brief Copies count trivially copyable elements between non-overlapping ranges with memcpy. During constant
+    /// evaluation, where memcpy is not available, the elements are copy constructed one by one.
+    static constexpr void copyBitwise(const_pointer source, size_type count, pointer destination) noexcept
+    {
+        if (std::is_constant_evaluated())
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                std::construct_at(destination + i, source[i]);
+            }
+            return;
+        }
+        std::memcpy(static_cast<void *>(destination), static_cast<const void *>(source), count * sizeof(T));
+    }
+
+    /// @brief Moves count trivially copyable elements between possibly overlapping ranges with memmove. During
+    /// constant evaluation the elements are copy constructed one by one in an order that is safe for the overlap.
+    static constexpr void moveBitwise(const_pointer source, size_type count, pointer destination) noexcept
+    {
+        if (std::is_constant_evaluated())
+        {
+            if (destination < source)
+            {
+                for (size_type i = 0; i < count; ++i)
+                {
+                    std::construct_at(destination + i, source[i]);
+                }
+            }
+            else
+            {
+                for (size_type i = count; i > 0; --i)
+                {
+                    std::construct_at(destination + i - 1, source[i - 1]);
+                }
+            }
+            return;
+        }
+        std::memmove(static_cast<void *>(destination), static_cast<const void *>(source), count * sizeof(T));
+    }
+
+    /// @brief Copy constructs the elements of [first, last) into uninitialized storage at destination.
+    template <typename InputIt>
+    static constexpr pointer uninitializedCopy(InputIt first, InputIt last, pointer destination)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            return std::uninitialized_copy(first, last, destination);
+        }
+        for (; first != last; ++first, ++destination)
+        {
+            std::construct_at(destination, *first);
+        }
+        return destination;
+    }
+
+    /// @brief Move constructs the elements of [first, last) into uninitialized storage at destination.
+    static constexpr pointer uninitializedMove(pointer first, pointer last, pointer destination)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            return std::uninitialized_move(first, last, destination);
+        }
+        for (; first != last; ++first, ++destination)
+        {
+            std::construct_at(destination, std::move(*first));
+        }
+        return destination;
+    }
+
+    /// @brief Constructs copies of value into the uninitialized storage [first, last).
+    static constexpr void uninitializedFill(pointer first, pointer last, const T &value)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            std::uninitialized_fill(first, last, value);
+            return;
+        }
+        for (; first != last; ++first)
+        {
+            std::construct_at(first, value);
+        }
+    }
+
+    /// @brief Value-initializes the elements of the uninitialized storage [first, last).
+    static constexpr void uninitializedValueConstruct(pointer first, pointer last)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            std::uninitialized_value_construct(first, last);
+            return;
+        }
+        for (; first != last; ++first)
+        {
+            std::construct_at(first);
+        }
+    }
+
+    /// @brief Destroys the element at the given position, see destroyRange.
+    static constexpr void destroyAt(pointer element) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            std::destroy_at(element);
+        }
+    }
+
+    /// @brief Destroys the elements of [first, last). Trivially destructible elements are left alone, so that they
+    /// stay valid constant expression values when the StackVector is used as a compile-time table.
+    static constexpr void destroyRange(pointer first, pointer last) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            std::destroy(first, last);
+        }
+    }
+
+    /// @brief Appends the range [first, last) after checking the capacity once for forward ranges.
+    template <typename InputIt> constexpr void appendChecked(InputIt first, InputIt last)
+    {
+        if constexpr (isForwardIterator<InputIt>())
+        {
+            if (static_cast<size_type>(std::distance(first, last)) > N - size_)
+            {
+                throw std::overflow_error("StackVector is full");
+            }
+        }
+        appendUnchecked(first, last);
+    }
+
+    /// @brief Appends the range [first, last). Forward ranges must already be known to fit.
+    template <typename InputIt> constexpr void appendUnchecked(InputIt first, InputIt last)
+    {
+        if constexpr (isTriviallyCopyableSource<InputIt>())
+        {
+            const auto count = static_cast<size_type>(last - first);
+            copyBitwise(first, count, end());
+            size_ += count;
+        }
+        else if constexpr (isForwardIterator<InputIt>())
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            uninitializedCopy(first, last, end());
+            size_ += count;
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                emplace_back(*first);
+            }
+        }
+    }
+
+    /// @brief Opens a gap at a position before end() and moves the value into it.
+    /// @param pos Position inside [begin(), end()) to insert at.
+    /// @param value Value to be moved into the gap.
+    /// @return Iterator pointing to the inserted element.
+    constexpr iterator insertShifted(iterator pos, T &&value)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            // The whole tail is shifted with a single memmove and the gap is overwritten
+            moveBitwise(pos, static_cast<size_type>(end() - pos), pos + 1);
+            std::construct_at(pos, std::move(value));
+        }
+        else
+        {
+            // The last element is moved into uninitialized storage, the rest are shifted by assignment
+            std::construct_at(end(), std::move(*(end() - 1)));
+            std::move_backward(pos, end() - 1, end());
+            *pos = std::move(value);
+        }
+        ++size_;
+        return pos;
+    }
+
+    /// @brief Copy constructs the elements of the other StackVector into this empty StackVector.
+    /// @param other The object to copy data from.
+    constexpr void copyFrom(const StackVector &other)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            copyBitwise(other.data(), other.size_, data());
+        }
+        else
+        {
+            uninitializedCopy(other.begin(), other.end(), data());
+        }
+        size_ = other.size_;
+    }
+
+    /// @brief Move constructs the elements of the other StackVector into this empty StackVector and empties the
+    /// other StackVector.
+    /// @param other The object to move data from.
+    constexpr void moveFrom(StackVector &other)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            copyBitwise(other.data(), other.size_, data());
+        }
+        else
+        {
+            uninitializedMove(other.begin(), other.end(), data());
+        }
+        size_ = other.size_;
+        other.clear();
+    }
+
+    /// @brief Uninitialized element storage. The union suppresses construction and destruction of the elements, while
+    /// keeping the storage typed as T rather than as bytes, so the compiler knows that element stores cannot alias
+    /// size_ and can keep it in a register across push loops.
+    union alignas(Alignment) InlineStorage
+    {
+        constexpr InlineStorage()
+        {
+            // A constexpr StackVector variable must not contain uninitialized values, so trivial elements are
+            // value-initialized when the StackVector is created during constant evaluation
+            if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+            {
+                if (std::is_constant_evaluated())
+                {
+                    for (std::size_t i = 0; i < N; ++i)
+                    {
+                        std::construct_at(elements + i);
+                    }
+                }
+            }
+        }
+
+        constexpr ~InlineStorage()
+        {
+        }
+
+        T elements[N > 0 ? N : 1];
+    };
+
+    /// @brief Uninitialized element storage in one heap block, allocated up front for all N elements. The allocator
+    /// typically serves such large blocks with mmap, so only the pages that elements are written to get committed.
+    struct HeapStorage
+    {
+        constexpr HeapStorage() : elements(allocate())
+        {
+        }
+
+        constexpr ~HeapStorage()
+        {
+            deallocate(elements);
+        }
+
+        HeapStorage(const HeapStorage &) = delete;
+        HeapStorage &operator=(const HeapStorage &) = delete;
+
+        static constexpr T *allocate()
+        {
+            if (std::is_constant_evaluated())
+            {
+                return std::allocator<T>().allocate(N);
+            }
+            return static_cast<T *>(::operator new(N * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        static constexpr void deallocate(T *elements) noexcept
+        {
+            if (std::is_constant_evaluated())
+            {
+                std::allocator<T>().deallocate(elements, N);
+                return;
+            }
+            ::operator delete(elements, N * sizeof(T), std::align_val_t{Alignment});
+        }
+
+        T *elements;
+    };
+
+    std::conditional_t<inline_storage, InlineStorage, HeapStorage> storage_;
+    size_type size_ = 0;
+};
@@ -0,0 +1,141 @@
+#include "stack_vector.hpp"
+
+#include <algorithm>   // std::max
+#include <chrono>      // std::chrono::high_resolution_clock
+#include <cstdint>     // std::size_t, std::uint64_t, std::uintptr_t
+#include <immintrin.h> // _mm256_load_ps, _mm256_loadu_ps, _mm256_add_ps
+#include <iostream>    // std::cout
+#include <memory>      // std::make_unique
+#include <thread>      // std::thread
+#include <vector>      // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t number_of_floats = 4096;
+
+using AlignedFloats = StackVector<float, number_of_floats, stack_vector_simd_alignment>;
+using NaturalFloats = StackVector<float, number_of_floats>;
+
+/// @brief Places a naturally aligned StackVector 4 bytes into a cache line, so its elements straddle 32-byte
+/// boundaries.
+struct MisalignedFloats
+{
+    alignas(stack_vector_cache_line_alignment) float padding;
+    NaturalFloats vector;
+};
+
+/// @brief Sums the elements with aligned AVX2 loads. The storage must be 32-byte aligned.
+__attribute__((noinline)) float sumAligned(const AlignedFloats &vector)
+{
+    __m256 sum = _mm256_setzero_ps();
+    for (std::size_t i = 0; i < vector.size(); i += 8)
+    {
+        sum = _mm256_add_ps(sum, _mm256_load_ps(vector.data() + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+/// @brief Sums the elements with unaligned AVX2 loads, which works for any storage alignment.
+__attribute__((noinline)) float sumUnaligned(const NaturalFloats &vector)
+{
+    __m256 sum = _mm256_setzero_ps();
+    for (std::size_t i = 0; i < vector.size(); i += 8)
+    {
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(vector.data() + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+template <typename Vector, typename Sum> double benchmarkSum(const Vector &vector, Sum sum)
+{
+    constexpr std::size_t number_of_iterations = 1'000'000;
+
+    float total = 0.0F;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        total += sum(vector);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+    doNotOptimize(total);
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Every thread repeatedly updates the single element of its own StackVector. The StackVectors sit next to each
+/// other in one array, so unless they are padded to whole cache lines, neighbouring threads write to the same line.
+template <typename Counter> double benchmarkFalseSharing(const std::size_t number_of_threads)
+{
+    constexpr std::size_t number_of_updates = 10'000'000;
+
+    std::vector<Counter> counters(number_of_threads);
+    for (auto &counter : counters)
+    {
+        counter.push_back(0);
+    }
+
+    std::vector<std::thread> threads;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t thread_no = 0; thread_no < number_of_threads; ++thread_no)
+    {
+        threads.emplace_back([&counter = counters[thread_no]] {
+            for (std::size_t update = 0; update < number_of_updates; ++update)
+            {
+                ++counter[0];
+                // Forces every update to be written back to memory instead of being kept in a register
+                doNotOptimize(counter[0]);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        std::cout << "AVX2 is not supported on this CPU" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto aligned = std::make_unique<AlignedFloats>();
+    auto misaligned = std::make_unique<MisalignedFloats>();
+    aligned->resize(number_of_floats, 1.0F);
+    misaligned->vector.resize(number_of_floats, 1.0F);
+
+    std::cout << "Aligned storage address % 32: " << reinterpret_cast<std::uintptr_t>(aligned->data()) % 32
+              << ", misaligned storage address % 32: "
+              << reinterpret_cast<std::uintptr_t>(misaligned->vector.data()) % 32 << std::endl;
+    std::cout << "Elapsed time (AVX2 sum, 32-byte aligned StackVector): " << benchmarkSum(*aligned, sumAligned)
+              << std::endl;
+    std::cout << "Elapsed time (AVX2 sum, misaligned StackVector): " << benchmarkSum(misaligned->vector, sumUnaligned)
+              << std::endl;
+
+    using PackedCounter = StackVector<std::uint64_t, 1>;
+    using PaddedCounter = StackVector<std::uint64_t, 1, stack_vector_cache_line_alignment>;
+
+    const std::size_t number_of_threads = std::max(2U, std::thread::hardware_concurrency());
+    std::cout << "sizeof(PackedCounter): " << sizeof(PackedCounter)
+              << ", sizeof(PaddedCounter): " << sizeof(PaddedCounter) << std::endl;
+    std::cout << "Elapsed time (" << number_of_threads
+              << " threads, packed StackVectors): " << benchmarkFalseSharing<PackedCounter>(number_of_threads)
+              << std::endl;
+    std::cout << "Elapsed time (" << number_of_threads << " threads, cache line padded StackVectors): "
+              << benchmarkFalseSharing<PaddedCounter>(number_of_threads) << std::endl;
+
+    return EXIT_SUCCESS;
+}
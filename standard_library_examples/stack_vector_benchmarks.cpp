@@ -0,0 +1,340 @@
+#include "stack_vector.hpp"
+
+#include <array>    // std::array
+#include <chrono>   // std::chrono::high_resolution_clock
+#include <cstdint>  // std::size_t
+#include <iostream> // std::cout
+#include <vector>   // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief Element type whose construction is expensive compared to its use.
+struct HeavyObject
+{
+    HeavyObject()
+    {
+        payload.fill(0.0);
+    }
+
+    explicit HeavyObject(double value)
+    {
+        payload.fill(value);
+    }
+
+    std::array<double, 64> payload;
+};
+
+/// @brief Float with a user-provided copy constructor, which forces StackVector onto its element-wise code paths.
+struct WrappedFloat
+{
+    WrappedFloat(float value) : value(value)
+    {
+    }
+
+    WrappedFloat(const WrappedFloat &other) : value(other.value)
+    {
+    }
+
+    WrappedFloat &operator=(const WrappedFloat &other)
+    {
+        value = other.value;
+        return *this;
+    }
+
+    float value;
+};
+
+/// @brief Reproduces the previous StackVector layout, where every one of the N slots is default constructed up front.
+template <typename T, std::size_t N> struct ArrayBackedVector
+{
+    void push_back(T &&value)
+    {
+        data_[size_++] = std::move(value);
+    }
+
+    std::array<T, N> data_;
+    std::size_t size_ = 0;
+};
+
+/// @brief Creates short-lived vectors with a large capacity holding only a few heavy elements.
+void benchmarkConstruction()
+{
+    constexpr std::size_t capacity = 256;
+    constexpr std::size_t number_of_elements = 4;
+    constexpr std::size_t number_of_iterations = 20'000;
+
+    std::chrono::_V2::high_resolution_clock::time_point start_time;
+    std::chrono::_V2::high_resolution_clock::time_point stop_time;
+
+    // std::array storage default constructs all N elements
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        ArrayBackedVector<HeavyObject, capacity> vector;
+        for (std::size_t i = 0; i < number_of_elements; ++i)
+        {
+            vector.push_back(HeavyObject(static_cast<double>(i)));
+        }
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (std::array storage, " << number_of_elements << "/" << capacity
+              << " heavy elements): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    // Uninitialized storage constructs only the elements that are inserted
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        StackVector<HeavyObject, capacity> vector;
+        for (std::size_t i = 0; i < number_of_elements; ++i)
+        {
+            vector.emplace_back(static_cast<double>(i));
+        }
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (StackVector storage, " << number_of_elements << "/" << capacity
+              << " heavy elements): " << (stop_time - start_time).count() / 1e9 << std::endl;
+}
+
+/// @brief Copies a large-capacity vector that holds only a few trivially copyable elements.
+void benchmarkTriviallyCopyableCopy()
+{
+    constexpr std::size_t capacity = 4096;
+    constexpr std::size_t number_of_elements = 10;
+    constexpr std::size_t number_of_iterations = 1'000'000;
+
+    std::chrono::_V2::high_resolution_clock::time_point start_time;
+    std::chrono::_V2::high_resolution_clock::time_point stop_time;
+
+    ArrayBackedVector<float, capacity> array_source;
+    StackVector<float, capacity> source;
+    StackVector<WrappedFloat, capacity> wrapped_source;
+    for (std::size_t i = 0; i < number_of_elements; ++i)
+    {
+        array_source.push_back(static_cast<float>(i));
+        source.push_back(static_cast<float>(i));
+        wrapped_source.push_back(static_cast<float>(i));
+    }
+
+    // Copying std::array storage copies all N slots
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(array_source);
+        ArrayBackedVector<float, capacity> copy = array_source;
+        doNotOptimize(copy);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (std::array storage copy, " << number_of_elements << "/" << capacity
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    // Element-wise copy of the live prefix
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(wrapped_source);
+        StackVector<WrappedFloat, capacity> copy = wrapped_source;
+        doNotOptimize(copy);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (StackVector element-wise copy, " << number_of_elements << "/" << capacity
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    // Single memcpy of the live prefix
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        doNotOptimize(source);
+        StackVector<float, capacity> copy = source;
+        doNotOptimize(copy);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (StackVector memcpy copy, " << number_of_elements << "/" << capacity
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+}
+
+/// @brief Repeatedly inserts at and erases from the front of a vector, shifting the whole tail each time.
+template <typename T> double benchmarkShift(const std::size_t number_of_elements)
+{
+    constexpr std::size_t capacity = 4096;
+    constexpr std::size_t number_of_iterations = 100'000;
+
+    StackVector<T, capacity> vector;
+    for (std::size_t i = 0; i < number_of_elements; ++i)
+    {
+        vector.push_back(static_cast<float>(i));
+    }
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        vector.insert(vector.begin(), static_cast<float>(iteration));
+        vector.erase(vector.begin());
+        doNotOptimize(vector);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Fills a vector from a contiguous source and inserts a block into its middle, element by element and in bulk.
+void benchmarkBulkOperations()
+{
+    constexpr std::size_t capacity = 1024;
+    constexpr std::size_t number_of_elements = 512;
+    constexpr std::size_t number_of_inserted_elements = 64;
+    constexpr std::size_t number_of_iterations = 100'000;
+
+    std::chrono::_V2::high_resolution_clock::time_point start_time;
+    std::chrono::_V2::high_resolution_clock::time_point stop_time;
+
+    std::vector<float> source(number_of_elements);
+    for (std::size_t i = 0; i < number_of_elements; ++i)
+    {
+        source[i] = static_cast<float>(i);
+    }
+
+    // One bounds check per element
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        StackVector<float, capacity> vector;
+        for (const auto &value : source)
+        {
+            vector.push_back(value);
+        }
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (push_back loop, " << number_of_elements
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    // One bounds check and one memcpy
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        StackVector<float, capacity> vector;
+        vector.append_range(source);
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (append_range, " << number_of_elements
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    StackVector<float, capacity> base;
+    base.append_range(source);
+
+    // The tail is shifted once per inserted element
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        StackVector<float, capacity> vector = base;
+        auto position = vector.begin() + number_of_elements / 2;
+        for (std::size_t i = 0; i < number_of_inserted_elements; ++i)
+        {
+            position = vector.insert(position, source[i]) + 1;
+        }
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (single-element insert loop, " << number_of_inserted_elements
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+
+    // The tail is shifted once in total
+    start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        StackVector<float, capacity> vector = base;
+        vector.insert(vector.begin() + number_of_elements / 2, source.data(),
+                      source.data() + number_of_inserted_elements);
+        doNotOptimize(vector);
+    }
+    stop_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Elapsed time (range insert, " << number_of_inserted_elements
+              << " floats): " << (stop_time - start_time).count() / 1e9 << std::endl;
+}
+
+using PushLoopVector = StackVector<float, 4096>;
+
+// The push loop kernels are kept out of line so that their code can be compared side by side, e.g. with
+//   objdump -d --no-show-raw-insn -C stack_vector_benchmarks | grep -A24 "<pushLoop"
+// Built with -O3 -DNDEBUG, pushLoopChecked stays scalar with a compare and branch to the cold overflow_error path per
+// element and writes size_ back every iteration. pushLoopUnchecked has no exception path, so size_ is kept in a
+// register and the loop body becomes packed movups/addps/movups, like pushLoopBulk which sizes the vector once and
+// writes through data().
+
+__attribute__((noinline)) void pushLoopChecked(PushLoopVector &vector, const float *__restrict values,
+                                               std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        vector.push_back(values[i] * 2.0F);
+    }
+}
+
+__attribute__((noinline)) void pushLoopUnchecked(PushLoopVector &vector, const float *__restrict values,
+                                                 std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        vector.unchecked_push_back(values[i] * 2.0F);
+    }
+}
+
+__attribute__((noinline)) void pushLoopBulk(PushLoopVector &vector, const float *__restrict values, std::size_t count)
+{
+    const std::size_t offset = vector.size();
+    vector.resize(offset + count);
+    float *__restrict destination = vector.data() + offset;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        destination[i] = values[i] * 2.0F;
+    }
+}
+
+/// @brief Times one of the push loop kernels filling the whole vector.
+template <typename Kernel> double benchmarkPushLoop(Kernel kernel, const std::vector<float> &values)
+{
+    constexpr std::size_t number_of_iterations = 100'000;
+
+    PushLoopVector vector;
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t iteration = 0; iteration < number_of_iterations; ++iteration)
+    {
+        vector.clear();
+        kernel(vector, values.data(), values.size());
+        doNotOptimize(vector);
+    }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    benchmarkConstruction();
+    benchmarkTriviallyCopyableCopy();
+
+    constexpr std::size_t number_of_shifted_elements = 1000;
+    std::cout << "Elapsed time (StackVector element-wise insert/erase, " << number_of_shifted_elements
+              << " floats): " << benchmarkShift<WrappedFloat>(number_of_shifted_elements) << std::endl;
+    std::cout << "Elapsed time (StackVector memmove insert/erase, " << number_of_shifted_elements
+              << " floats): " << benchmarkShift<float>(number_of_shifted_elements) << std::endl;
+
+    benchmarkBulkOperations();
+
+    const std::vector<float> push_values(PushLoopVector().max_size(), 1.0F);
+    std::cout << "Elapsed time (checked push_back loop, " << push_values.size()
+              << " floats): " << benchmarkPushLoop(pushLoopChecked, push_values) << std::endl;
+    std::cout << "Elapsed time (unchecked_push_back loop, " << push_values.size()
+              << " floats): " << benchmarkPushLoop(pushLoopUnchecked, push_values) << std::endl;
+    std::cout << "Elapsed time (resize and write through data(), " << push_values.size()
+              << " floats): " << benchmarkPushLoop(pushLoopBulk, push_values) << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm> // std::min
+#include <array>     // std::array
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::steady_clock
+#include <cstdint>   // std::int64_t, std::size_t, std::uint8_t, std::uint32_t, std::uint64_t
+
+/// @brief Priority class of a task. Schedulers run the tasks of a higher class first, but age the waiting lower
+/// classes so that they do not starve.
+enum class TaskPriority : std::uint8_t
+{
+    high,
+    normal,
+    low
+};
+
+inline constexpr std::size_t number_of_task_priorities = 3;
+
+/// @brief Number of tasks of higher priority that a scheduler runs while a lower priority class waits, before it looks
+/// at the lower class first once.
+inline constexpr std::uint32_t task_priority_aging_period = 16;
+
+/// @brief Time before its deadline from which a task runs ahead of all priority classes.
+inline constexpr std::int64_t task_deadline_lead_ns = 100'000;
+
+/// @brief Returns the index of the priority class, 0 for the highest.
+constexpr std::size_t priorityIndex(TaskPriority priority) noexcept
+{
+    return static_cast<std::size_t>(priority);
+}
+
+/// @brief TaskAging decides in which order a scheduler looks at the priority classes. Normally that is from the
+/// highest to the lowest, but every class below the highest ages by one whenever a task of a higher class runs, and
+/// once a class is task_priority_aging_period tasks old it is looked at first, until it has run a task or turned out
+/// to be empty. Under saturation every class therefore gets at least about one of task_priority_aging_period tasks
+/// of the classes above it. The ages are plain counters, so every scheduling thread keeps its own TaskAging.
+class TaskAging
+{
+  public:
+    /// @brief Returns the index of the class to look at first: the lowest aged class, or else the highest class.
+    std::size_t firstLevel() const noexcept
+    {
+        for (std::size_t level = number_of_task_priorities; level-- > 1;)
+        {
+            if (ages_[level] >= task_priority_aging_period)
+            {
+                return level;
+            }
+        }
+        return 0;
+    }
+
+    /// @brief Returns the index of the class to look at in the given rank of the search: the first level, then the
+    /// others from the highest.
+    static std::size_t levelAt(std::size_t first_level, std::size_t rank) noexcept
+    {
+        if (rank == 0)
+        {
+            return first_level;
+        }
+        return rank <= first_level ? rank - 1 : rank;
+    }
+
+    /// @brief Records that a task of the class at the level runs, after a search that started at first_level. A first
+    /// level that had no task is not aged anymore.
+    void ran(std::size_t first_level, std::size_t level) noexcept
+    {
+        ages_[first_level] = 0;
+        ages_[level] = 0;
+        for (std::size_t lower = level + 1; lower < number_of_task_priorities; ++lower)
+        {
+            ages_[lower] = std::min(ages_[lower] + 1, task_priority_aging_period);
+        }
+    }
+
+  private:
+    std::array<std::uint32_t, number_of_task_priorities> ages_{};
+};
+
+/// @brief Returns a timestamp for measuring short latencies: the time stamp counter on x86, which is cheaper to read
+/// than the steady clock, and the steady clock in nanoseconds elsewhere.
+inline std::uint64_t latencyTicks() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// @brief LatencyTickCalibration relates latency ticks to nanoseconds by reading both clocks at its construction and
+/// again when asked, so the longer it lives, the more exact it gets.
+class LatencyTickCalibration
+{
+  public:
+    LatencyTickCalibration() noexcept : origin_(std::chrono::steady_clock::now()), origin_ticks_(latencyTicks())
+    {
+    }
+
+    /// @brief Returns the nanoseconds per tick since the construction, or 1 if no time has passed yet.
+    double nanosecondsPerTick() const noexcept
+    {
+        const auto elapsed_ns = (std::chrono::steady_clock::now() - origin_).count();
+        const std::uint64_t elapsed_ticks = latencyTicks() - origin_ticks_;
+        if (elapsed_ns <= 0 || elapsed_ticks == 0)
+        {
+            return 1.0;
+        }
+        return static_cast<double>(elapsed_ns) / static_cast<double>(elapsed_ticks);
+    }
+
+  private:
+    const std::chrono::steady_clock::time_point origin_;
+    const std::uint64_t origin_ticks_;
+};
+
+/// @brief Snapshot of a histogram of the latencies of one priority class, from pushing a task until it starts.
+/// Buckets are log-linear: every power of two is split into four buckets, so a percentile is exact to within 25 %.
+struct TaskLatencyHistogram
+{
+    /// @brief Number of buckets, enough for latencies of more than 2^40 ticks.
+    static constexpr std::size_t number_of_buckets = 160;
+
+    /// @brief Returns the bucket of a latency in ticks. Latencies below four ticks have a bucket each.
+    static std::size_t bucket(std::uint64_t ticks) noexcept
+    {
+        if (ticks < 4)
+        {
+            return static_cast<std::size_t>(ticks);
+        }
+        const std::size_t exponent = 63 - static_cast<std::size_t>(__builtin_clzll(ticks));
+        const std::size_t sub_bucket = (ticks >> (exponent - 2)) & 3;
+        return std::min(4 * (exponent - 1) + sub_bucket, number_of_buckets - 1);
+    }
+
+    /// @brief Returns the largest latency, in ticks, that falls into the bucket.
+    static std::uint64_t bucketLimit(std::size_t bucket) noexcept
+    {
+        if (bucket < 4)
+        {
+            return bucket;
+        }
+        const std::size_t exponent = bucket / 4 + 1;
+        return ((std::uint64_t{4} + bucket % 4 + 1) << (exponent - 2)) - 1;
+    }
+
+    /// @brief Returns the number of recorded latencies.
+    std::uint64_t count() const noexcept
+    {
+        std::uint64_t total = 0;
+        for (const std::uint64_t bucket_count : counts)
+        {
+            total += bucket_count;
+        }
+        return total;
+    }
+
+    /// @brief Returns the latency in nanoseconds that the given fraction of the tasks did not exceed, as the upper
+    /// limit of its bucket, or 0 if nothing was recorded.
+    double percentile(double fraction) const noexcept
+    {
+        const std::uint64_t total = count();
+        if (total == 0)
+        {
+            return 0.0;
+        }
+        const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total - 1));
+        std::uint64_t seen = 0;
+        for (std::size_t bucket_no = 0; bucket_no < number_of_buckets; ++bucket_no)
+        {
+            seen += counts[bucket_no];
+            if (seen > rank)
+            {
+                return static_cast<double>(bucketLimit(bucket_no)) * nanoseconds_per_tick;
+            }
+        }
+        return static_cast<double>(bucketLimit(number_of_buckets - 1)) * nanoseconds_per_tick;
+    }
+
+    std::array<std::uint64_t, number_of_buckets> counts{};
+    double nanoseconds_per_tick = 1.0;
+};
+
+/// @brief Latency counters of all priority classes for one recording thread, or for several with atomic increments,
+/// on their own cache lines.
+struct alignas(64) TaskLatencyCounters
+{
+    TaskLatencyCounters()
+    {
+        reset();
+    }
+
+    /// @brief Counts a latency. Only a single thread may record with single_writer set, which saves the atomic
+    /// read-modify-write.
+    void record(std::size_t level, std::uint64_t ticks, bool single_writer) noexcept
+    {
+        std::atomic<std::uint64_t> &count = counts[level][TaskLatencyHistogram::bucket(ticks)];
+        if (single_writer)
+        {
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief Adds the counts of the class at the level to the histogram.
+    void addTo(std::size_t level, TaskLatencyHistogram &histogram) const noexcept
+    {
+        for (std::size_t bucket_no = 0; bucket_no < TaskLatencyHistogram::number_of_buckets; ++bucket_no)
+        {
+            histogram.counts[bucket_no] += counts[level][bucket_no].load(std::memory_order_relaxed);
+        }
+    }
+
+    void reset() noexcept
+    {
+        for (auto &level_counts : counts)
+        {
+            for (auto &count : level_counts)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::array<std::array<std::atomic<std::uint64_t>, TaskLatencyHistogram::number_of_buckets>,
+               number_of_task_priorities>
+        counts;
+};
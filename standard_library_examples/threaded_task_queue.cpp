@@ -1,12 +1,19 @@
+#include "inplace_function.hpp"
+#include "task_priority.hpp"
+
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cmath>
 #include <condition_variable>
 #include <csignal>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <mutex>
-#include <queue>
+#include <new>
 #include <thread>
 #include <vector>
 
@@ -14,9 +21,34 @@ using namespace std::chrono_literals;
 
 #define PRINT_DEBUG_INFO 0
 
+/// @brief Number of tasks that a TaskDispatchQueue holds per priority class before its ring first grows.
+constexpr std::size_t task_dispatch_queue_initial_capacity = 256;
+
 namespace
 {
 std::atomic<bool> stop_status = false;
+std::atomic<std::size_t> number_of_allocations = 0;
+}
+
+/// @brief Counts every allocation of the program, so that main can show that enqueueing allocates nothing.
+void *operator new(std::size_t size)
+{
+    number_of_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
 }
 
 void signalHandler(int signum)
@@ -25,28 +57,104 @@ void signalHandler(int signum)
     stop_status = true;
 }
 
+/// @brief Task of a TaskDispatchQueue, with the time of its push in latency ticks and its deadline, if any.
+struct QueuedTask
+{
+    InplaceFunction<void()> function;
+    std::uint64_t push_ticks = 0;
+    std::int64_t deadline_ns = 0;
+};
+
+/// @brief Heap order of the tasks with a deadline, which puts the earliest deadline at the front.
+struct LaterDeadline
+{
+    bool operator()(const QueuedTask &lhs, const QueuedTask &rhs) const noexcept
+    {
+        return lhs.deadline_ns > rhs.deadline_ns;
+    }
+};
+
+/// @brief TaskRing is an unbounded FIFO of tasks in a ring whose size is a power of two. The ring doubles when it is
+/// full and never shrinks, so once it has held its peak number of tasks, pushing and popping allocate nothing.
+class TaskRing
+{
+  public:
+    explicit TaskRing(std::size_t initial_size = task_dispatch_queue_initial_capacity) : slots_(initial_size)
+    {
+    }
+
+    bool empty() const noexcept
+    {
+        return head_ == tail_;
+    }
+
+    /// @brief Appends the task, doubling the ring if it is full.
+    void push(QueuedTask &&task)
+    {
+        if (tail_ - head_ == slots_.size())
+        {
+            grow();
+        }
+        slots_[tail_++ & (slots_.size() - 1)] = std::move(task);
+    }
+
+    /// @brief Removes and returns the oldest task, which must exist.
+    QueuedTask pop() noexcept
+    {
+        return std::move(slots_[head_++ & (slots_.size() - 1)]);
+    }
+
+  private:
+    /// @brief Replaces the ring by one of twice the size that holds the same tasks from its first slot on.
+    void grow()
+    {
+        std::vector<QueuedTask> bigger(2 * slots_.size());
+        for (std::size_t index = head_; index != tail_; ++index)
+        {
+            bigger[index - head_] = std::move(slots_[index & (slots_.size() - 1)]);
+        }
+        tail_ -= head_;
+        head_ = 0;
+        slots_.swap(bigger);
+    }
+
+    std::vector<QueuedTask> slots_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+};
+
+/// @brief TaskDispatchQueue runs tasks on a fixed set of threads that share one queue per priority class under a
+/// mutex. A thread takes the oldest task of the highest class, except when TaskAging puts a starving lower class first.
+/// The queues are TaskRings of InplaceFunctions, so enqueueing allocates only while a queue grows to a new peak.
+/// Like in WorkStealingThreadPool, a task may have a deadline: it then waits in a heap of its class ordered by
+/// deadline, behind the other tasks of the class, until its deadline is less than task_deadline_lead_ns away and the
+/// next thread runs it ahead of all classes. The time from push to start of every task is recorded per class in
+/// histograms that latencyHistogram() returns, and that the destructor prints.
 class TaskDispatchQueue
 {
   public:
     explicit TaskDispatchQueue(unsigned int num_threads = std::thread::hardware_concurrency())
     {
         creation_time_ = std::chrono::steady_clock::now();
+        for (auto &tasks : deadline_tasks_)
+        {
+            tasks.reserve(task_dispatch_queue_initial_capacity);
+        }
         for (unsigned int thread_no = 0; thread_no < num_threads; ++thread_no)
         {
             threads_.emplace_back([this] {
                 while (true)
                 {
-                    std::function<void()> task;
+                    InplaceFunction<void()> task;
                     {
                         std::unique_lock<std::mutex> lock(mutex_);
-                        condition_variable_.wait(lock, [this] { return stop_status || !tasks_.empty(); });
+                        condition_variable_.wait(lock, [this] { return stop_status || number_of_tasks_ > 0; });
 
-                        if (stop_status && tasks_.empty())
+                        if (stop_status && number_of_tasks_ == 0)
                         {
                             break;
                         }
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
+                        task = popTask();
 
 #if PRINT_DEBUG_INFO
                         std::cout << "Thread " << std::this_thread::get_id() << " received task\n";
@@ -75,22 +183,139 @@ class TaskDispatchQueue
         }
         deletion_time_ = std::chrono::steady_clock::now();
         std::cout << "Elapsed time: " << (deletion_time_ - creation_time_).count() / 1e9 << " seconds\n";
+        const char *class_names[] = {"high", "normal", "low"};
+        for (std::size_t level = 0; level < number_of_task_priorities; ++level)
+        {
+            const TaskLatencyHistogram histogram = latencyHistogram(static_cast<TaskPriority>(level));
+            if (histogram.count() > 0)
+            {
+                std::cout << "Latency (" << class_names[level] << ", " << histogram.count() << " tasks): p50 "
+                          << histogram.percentile(0.50) / 1e9 << " seconds, p99 " << histogram.percentile(0.99) / 1e9
+                          << " seconds\n";
+            }
+        }
     };
 
     template <typename Predicate, typename... Args> void enqueue(Predicate &&func, Args &&...args)
+    {
+        enqueueWithPriority(TaskPriority::normal, std::forward<Predicate>(func), std::forward<Args>(args)...);
+    }
+
+    template <typename Predicate, typename... Args>
+    void enqueueWithPriority(TaskPriority priority, Predicate &&func, Args &&...args)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            tasks_[priorityIndex(priority)].push(
+                {std::bind(std::forward<Predicate>(func), std::forward<Args>(args)...), latencyTicks()});
+            ++number_of_tasks_;
+        };
+        condition_variable_.notify_one();
+    }
+
+    /// @brief Enqueues a task with the given priority that should start before the deadline.
+    template <typename Predicate, typename... Args>
+    void enqueueWithDeadline(TaskPriority priority, std::chrono::steady_clock::time_point deadline, Predicate &&func,
+                             Args &&...args)
     {
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            tasks_.emplace(std::bind(std::forward<Predicate>(func), std::forward<Args>(args)...));
+            std::vector<QueuedTask> &tasks = deadline_tasks_[priorityIndex(priority)];
+            tasks.push_back({std::bind(std::forward<Predicate>(func), std::forward<Args>(args)...), latencyTicks(),
+                             deadline.time_since_epoch().count()});
+            std::push_heap(tasks.begin(), tasks.end(), LaterDeadline());
+            ++number_of_deadline_tasks_;
+            ++number_of_tasks_;
         };
         condition_variable_.notify_one();
     }
 
+    /// @brief Returns the histogram of the times from push to start of the tasks of the priority class.
+    TaskLatencyHistogram latencyHistogram(TaskPriority priority) const
+    {
+        TaskLatencyHistogram histogram;
+        latencies_.addTo(priorityIndex(priority), histogram);
+        histogram.nanoseconds_per_tick = tick_calibration_.nanosecondsPerTick();
+        return histogram;
+    }
+
   private:
+    /// @brief Takes the next task, which must exist, and records its latency: a task whose deadline is close, from
+    /// the highest class, or else in the order that the aging gives, the oldest task of a class before its tasks with
+    /// a deadline. Must be called under the mutex.
+    InplaceFunction<void()> popTask()
+    {
+        const std::size_t first_level = aging_.firstLevel();
+        QueuedTask task;
+        std::size_t level = lateLevel();
+        if (level < number_of_task_priorities)
+        {
+            task = popDeadlineTask(level);
+        }
+        else
+        {
+            for (std::size_t rank = 0;; ++rank)
+            {
+                level = TaskAging::levelAt(first_level, rank);
+                if (!tasks_[level].empty())
+                {
+                    task = tasks_[level].pop();
+                    break;
+                }
+                if (!deadline_tasks_[level].empty())
+                {
+                    task = popDeadlineTask(level);
+                    break;
+                }
+            }
+        }
+        --number_of_tasks_;
+        aging_.ran(first_level, level);
+        latencies_.record(level, latencyTicks() - task.push_ticks, true);
+        return std::move(task.function);
+    }
+
+    /// @brief Returns the highest class with a task whose deadline is less than task_deadline_lead_ns away, or
+    /// number_of_task_priorities if there is none. Reads the clock only while there are tasks with a deadline.
+    std::size_t lateLevel() const
+    {
+        if (number_of_deadline_tasks_ == 0)
+        {
+            return number_of_task_priorities;
+        }
+        const std::int64_t late_deadline_ns =
+            std::chrono::steady_clock::now().time_since_epoch().count() + task_deadline_lead_ns;
+        for (std::size_t level = 0; level < number_of_task_priorities; ++level)
+        {
+            if (!deadline_tasks_[level].empty() && deadline_tasks_[level].front().deadline_ns <= late_deadline_ns)
+            {
+                return level;
+            }
+        }
+        return number_of_task_priorities;
+    }
+
+    /// @brief Takes the task of the class with the earliest deadline, which must exist.
+    QueuedTask popDeadlineTask(std::size_t level)
+    {
+        std::vector<QueuedTask> &tasks = deadline_tasks_[level];
+        std::pop_heap(tasks.begin(), tasks.end(), LaterDeadline());
+        QueuedTask task = std::move(tasks.back());
+        tasks.pop_back();
+        --number_of_deadline_tasks_;
+        return task;
+    }
+
     std::condition_variable condition_variable_;
     std::mutex mutex_;
     std::vector<std::thread> threads_;
-    std::queue<std::function<void()>> tasks_;
+    std::array<TaskRing, number_of_task_priorities> tasks_;
+    std::array<std::vector<QueuedTask>, number_of_task_priorities> deadline_tasks_;
+    std::size_t number_of_tasks_ = 0;
+    std::size_t number_of_deadline_tasks_ = 0;
+    TaskAging aging_;
+    TaskLatencyCounters latencies_;
+    const LatencyTickCalibration tick_calibration_;
     std::chrono::time_point<std::chrono::steady_clock> creation_time_;
     std::chrono::time_point<std::chrono::steady_clock> deletion_time_;
 };
@@ -114,10 +339,24 @@ int main()
     };
 
     TaskDispatchQueue task_queue{};
+    const std::size_t allocations_before = number_of_allocations.load();
     for (int task_no = 0; task_no < 10000; ++task_no)
     {
-        task_queue.enqueue(task, task_no);
+        if (task_no % 100 == 99)
+        {
+            task_queue.enqueueWithPriority(TaskPriority::high, task, task_no);
+        }
+        else if (task_no % 100 == 49)
+        {
+            task_queue.enqueueWithDeadline(TaskPriority::low, std::chrono::steady_clock::now() + 50ms, task, task_no);
+        }
+        else
+        {
+            task_queue.enqueue(task, task_no);
+        }
     }
+    // Only the growth of the rings to their peak allocates
+    std::cout << "Allocations while enqueueing: " << number_of_allocations.load() - allocations_before << std::endl;
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "work_stealing_thread_pool.hpp"
+
+#include <algorithm> // std::nth_element
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::steady_clock, std::chrono::high_resolution_clock
+#include <cstddef>   // std::ptrdiff_t
+#include <cstdint>   // std::size_t, std::uint32_t
+#include <iostream>  // std::cout
+#include <thread>    // std::this_thread::sleep_for, std::thread::hardware_concurrency
+#include <vector>    // std::vector
+
+#include <sys/resource.h> // getrusage
+
+using namespace std::chrono_literals;
+
+constexpr std::size_t number_of_wake_ups = 1000;
+
+/// @brief Returns the CPU time, user and system, that all threads of the process have used so far, in seconds.
+double processCpuSeconds()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/// @brief Returns the latency below which the given fraction of the samples lie.
+double percentile(std::vector<double> &samples, double fraction)
+{
+    const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+/// @brief Sleeps for a second while the pool has no work and returns the CPU time that the process used meanwhile, as
+/// a fraction of the wall time.
+double measureIdleCpuUse()
+{
+    // Lets the workers finish spinning first
+    std::this_thread::sleep_for(100ms);
+    const double cpu_before = processCpuSeconds();
+    const auto start_time = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(1s);
+    const auto stop_time = std::chrono::steady_clock::now();
+    const double cpu_after = processCpuSeconds();
+
+    return (cpu_after - cpu_before) / ((stop_time - start_time).count() / 1e9);
+}
+
+/// @brief Pushes one task at a time after the given pause and returns the time from each push until the task starts,
+/// in microseconds. A pause longer than the spinning of the workers measures the wake-up of a parked worker.
+std::vector<double> measureWakeLatencies(WorkStealingThreadPool &pool, std::chrono::microseconds pause)
+{
+    std::vector<double> latencies;
+    std::atomic<bool> started{false};
+    for (std::size_t wake_up_no = 0; wake_up_no < number_of_wake_ups; ++wake_up_no)
+    {
+        if (pause.count() > 0)
+        {
+            std::this_thread::sleep_for(pause);
+        }
+        std::chrono::high_resolution_clock::time_point start_time;
+        started.store(false);
+        const auto push_time = std::chrono::high_resolution_clock::now();
+        pool.pushTask([&started, &start_time] {
+            start_time = std::chrono::high_resolution_clock::now();
+            started.store(true, std::memory_order_release);
+        });
+        while (!started.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        latencies.push_back((start_time - push_time).count() / 1e3);
+    }
+    return latencies;
+}
+
+/// @brief Prints the median and 99th percentile of the latencies.
+void printLatencies(const char *name, std::vector<double> latencies)
+{
+    std::cout << "Wake latency (" << name << "): p50 " << percentile(latencies, 0.50) << " us, p99 "
+              << percentile(latencies, 0.99) << " us" << std::endl;
+}
+
+int main()
+{
+    const std::uint32_t number_of_threads = std::max(1U, std::thread::hardware_concurrency());
+    WorkStealingThreadPool pool(number_of_threads);
+
+    std::cout << "Idle CPU use of " << number_of_threads
+              << " workers: " << 100.0 * measureIdleCpuUse() << " % of one core" << std::endl;
+    printLatencies("parked workers", measureWakeLatencies(pool, 2ms));
+    printLatencies("spinning workers", measureWakeLatencies(pool, 0us));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "work_stealing_thread_pool.hpp"
+
+#include <algorithm> // std::max, std::nth_element
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::steady_clock
+#include <cstddef>   // std::ptrdiff_t
+#include <cstdint>   // std::size_t, std::uint32_t, std::uint64_t
+#include <iostream>  // std::cout
+#include <thread>    // std::this_thread::sleep_for, std::this_thread::yield, std::thread::hardware_concurrency
+#include <vector>    // std::vector
+
+using namespace std::chrono_literals;
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::size_t bulk_tasks_per_thread = 50'000;
+constexpr std::uint32_t work_per_bulk_task = 16384;
+constexpr std::size_t number_of_probes = 2000;
+
+/// @brief A piece of work of some microseconds.
+void work(std::uint64_t seed, std::uint32_t iterations)
+{
+    for (std::uint32_t i = 0; i < iterations; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        doNotOptimize(seed);
+    }
+}
+
+/// @brief Returns the latency below which the given fraction of the samples lie.
+double percentile(std::vector<double> &samples, double fraction)
+{
+    const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+/// @brief Saturates a pool with a backlog of low priority bulk tasks, pushes a probe task every 200 us meanwhile, and
+/// prints the latencies from push to start of the probes and the latency histograms of the pool.
+/// @param probe_deadline Deadline of the probes relative to their push, or zero for none.
+void benchmarkProbes(const char *name, std::uint32_t number_of_threads, TaskPriority probe_priority,
+                     std::chrono::microseconds probe_deadline = 0us)
+{
+    WorkStealingThreadPool pool(number_of_threads, 1);
+    const std::size_t number_of_bulk_tasks = bulk_tasks_per_thread * number_of_threads;
+    std::atomic<std::size_t> completed{0};
+    for (std::size_t task_no = 0; task_no < number_of_bulk_tasks; ++task_no)
+    {
+        pool.pushTask(
+            [&completed, task_no] {
+                work(task_no, work_per_bulk_task);
+                completed.fetch_add(1, std::memory_order_relaxed);
+            },
+            TaskPriority::low);
+    }
+
+    std::vector<double> latencies(number_of_probes);
+    for (std::size_t probe_no = 0; probe_no < number_of_probes; ++probe_no)
+    {
+        const auto push_time = std::chrono::steady_clock::now();
+        auto probe = [&completed, &latencies, probe_no, push_time] {
+            latencies[probe_no] = (std::chrono::steady_clock::now() - push_time).count() / 1e3;
+            completed.fetch_add(1, std::memory_order_relaxed);
+        };
+        if (probe_deadline.count() > 0)
+        {
+            pool.pushTask(probe, probe_priority, push_time + probe_deadline);
+        }
+        else
+        {
+            pool.pushTask(probe, probe_priority);
+        }
+        std::this_thread::sleep_for(200us);
+    }
+    while (completed.load(std::memory_order_relaxed) < number_of_bulk_tasks + number_of_probes)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    std::cout << "Probe latency (" << name << "): p50 " << percentile(latencies, 0.50) << " us, p99 "
+              << percentile(latencies, 0.99) << " us" << std::endl;
+    const char *class_names[] = {"high", "normal", "low"};
+    for (std::size_t level = 0; level < number_of_task_priorities; ++level)
+    {
+        const TaskLatencyHistogram histogram = pool.latencyHistogram(static_cast<TaskPriority>(level));
+        if (histogram.count() > 0)
+        {
+            std::cout << "  Histogram (" << class_names[level] << ", " << histogram.count() << " tasks): p50 "
+                      << histogram.percentile(0.50) / 1e3 << " us, p99 " << histogram.percentile(0.99) / 1e3 << " us"
+                      << std::endl;
+        }
+    }
+}
+
+int main()
+{
+    const std::uint32_t number_of_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    benchmarkProbes("low priority like the backlog", number_of_threads, TaskPriority::low);
+    benchmarkProbes("high priority", number_of_threads, TaskPriority::high);
+    // Probes with a deadline wait behind the backlog of their class until they are task_deadline_lead_ns from their
+    // deadline, so they should start about 0.9 ms and 4.9 ms after their push
+    benchmarkProbes("low priority like the backlog, 1 ms deadline", number_of_threads, TaskPriority::low, 1000us);
+    benchmarkProbes("low priority like the backlog, 5 ms deadline", number_of_threads, TaskPriority::low, 5000us);
+
+    return EXIT_SUCCESS;
+}
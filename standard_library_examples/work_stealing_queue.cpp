@@ -1,3 +1,5 @@
+#include "inplace_function.hpp"
+
 #include <chrono>           // std::chrono::high_resolution_clock::now()
 #include <cmath>            // std::sin
 #include <csignal>          // std::signal
@@ -20,7 +22,7 @@ class WorkStealingQueue
     {
     }
 
-    void enqueue(std::function<void()> &&task)
+    void enqueue(InplaceFunction<void()> &&task)
     {
         task_group_.run([task{std::move(task)}, this] { task(); });
     }
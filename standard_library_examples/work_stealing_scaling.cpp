@@ -0,0 +1,109 @@
+#include "work_stealing_thread_pool.hpp"
+
+#include <algorithm> // std::max
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::high_resolution_clock
+#include <cstdint>   // std::size_t, std::uint32_t, std::uint64_t
+#include <iostream>  // std::cout
+#include <thread>    // std::thread::hardware_concurrency, std::this_thread::yield
+#include <vector>    // std::vector
+
+/// @brief Prevents the compiler from optimizing away computations whose results are otherwise unused.
+template <typename T> inline void doNotOptimize(T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+constexpr std::uint32_t tree_depth = 20;
+constexpr std::size_t number_of_flat_tasks = 1'000'000;
+constexpr std::uint32_t work_per_task = 64;
+
+/// @brief A fine-grained piece of work of a few hundred nanoseconds.
+void work(std::uint64_t seed)
+{
+    for (std::uint32_t i = 0; i < work_per_task; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        doNotOptimize(seed);
+    }
+}
+
+/// @brief Task that splits into two child tasks until the depth is used up and then does a piece of work, so that all
+/// tasks are pushed by the workers themselves and spread only by stealing.
+void splitTask(WorkStealingThreadPool &pool, std::atomic<std::size_t> &completed, std::uint32_t depth)
+{
+    if (depth == 0)
+    {
+        work(depth);
+        completed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pool.pushTask([&pool, &completed, depth] { splitTask(pool, completed, depth - 1); });
+    pool.pushTask([&pool, &completed, depth] { splitTask(pool, completed, depth - 1); });
+}
+
+/// @brief Waits until the counter reaches the target.
+void waitFor(const std::atomic<std::size_t> &counter, const std::size_t target)
+{
+    while (counter.load(std::memory_order_relaxed) < target)
+    {
+        std::this_thread::yield();
+    }
+}
+
+/// @brief Runs a binary tree of 2^tree_depth leaf tasks and returns the elapsed time.
+double benchmarkTaskTree(const std::uint32_t number_of_threads)
+{
+    WorkStealingThreadPool pool(number_of_threads);
+    std::atomic<std::size_t> completed{0};
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    pool.pushTask([&pool, &completed] { splitTask(pool, completed, tree_depth); });
+    waitFor(completed, std::size_t{1} << tree_depth);
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+/// @brief Pushes number_of_flat_tasks independent tasks from outside the pool and returns the elapsed time.
+double benchmarkFlatTasks(const std::uint32_t number_of_threads)
+{
+    WorkStealingThreadPool pool(number_of_threads);
+    std::atomic<std::size_t> completed{0};
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    for (std::size_t task_no = 0; task_no < number_of_flat_tasks; ++task_no)
+    {
+        pool.pushTask([&completed, task_no] {
+            work(task_no);
+            completed.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    waitFor(completed, number_of_flat_tasks);
+    const auto stop_time = std::chrono::high_resolution_clock::now();
+
+    return (stop_time - start_time).count() / 1e9;
+}
+
+int main()
+{
+    const std::uint32_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::uint32_t> thread_counts;
+    for (std::uint32_t number_of_threads = 1; number_of_threads < max_threads; number_of_threads *= 2)
+    {
+        thread_counts.push_back(number_of_threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    // Split tasks are 2^(tree_depth+1)-1 tasks in total, of which 2^tree_depth do work
+    const auto number_of_tree_tasks = static_cast<double>((std::size_t{1} << (tree_depth + 1)) - 1);
+    for (const std::uint32_t number_of_threads : thread_counts)
+    {
+        const double tree_time = benchmarkTaskTree(number_of_threads);
+        std::cout << "Elapsed time (task tree, " << number_of_threads << " threads): " << tree_time
+                  << ", tasks per second: " << number_of_tree_tasks / tree_time << std::endl;
+        const double flat_time = benchmarkFlatTasks(number_of_threads);
+        std::cout << "Elapsed time (external tasks, " << number_of_threads << " threads): " << flat_time
+                  << ", tasks per second: " << number_of_flat_tasks / flat_time << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1319 @@
+#pragma once
+
+#include "event_count.hpp"
+#include "inplace_function.hpp"
+#include "object_pool.hpp"
+#include "task_priority.hpp"
+
+#include <algorithm>   // std::push_heap, std::pop_heap
+#include <array>       // std::array
+#include <atomic>      // std::atomic
+#include <cassert>     // assert
+#include <chrono>      // std::chrono::steady_clock
+#include <climits>     // INT_MAX
+#include <cstdint>     // std::int64_t, std::size_t, std::uint32_t, std::uint64_t, INT64_MAX
+#include <exception>   // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <functional>  // std::invoke
+#include <future>      // std::future_error, std::future_errc
+#include <memory>      // std::unique_ptr, std::make_unique
+#include <mutex>       // std::mutex, std::lock_guard
+#include <new>         // std::launder, ::new
+#include <thread>      // std::thread
+#include <type_traits> // std::conditional_t, std::decay_t, std::invoke_result_t, std::is_void_v
+#include <utility>     // std::exchange, std::forward, std::move
+#include <vector>      // std::vector
+
+#include <time.h> // timespec
+
+/// @brief ChaseLevDeque is the lock-free work-stealing deque of Chase and Lev ("Dynamic Circular Work-Stealing Deque",
+/// 2005), in the C++ memory model formulation of Lê et al. (2013). The owner thread pushes and takes at the bottom,
+/// in LIFO order, without any read-modify-write unless the deque is about to run empty. Any other thread steals from
+/// the top, in FIFO order, with one compare-and-swap. The owner and the thieves only contend for the last element.
+/// The ring of slots doubles when it is full; a ring that is replaced is kept until the deque is destroyed, because a
+/// thief may still read from it.
+/// @tparam T Type of the elements, which are stored as pointers
+template <typename T> class ChaseLevDeque final
+{
+    /// @brief Ring of slots whose size is a power of two, indexed by the unbounded top and bottom counters.
+    struct Ring
+    {
+        explicit Ring(std::int64_t size) : mask(size - 1), slots(new std::atomic<T *>[static_cast<std::size_t>(size)])
+        {
+        }
+
+        T *get(std::int64_t index) const noexcept
+        {
+            return slots[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T *element) noexcept
+        {
+            slots[index & mask].store(element, std::memory_order_relaxed);
+        }
+
+        const std::int64_t mask;
+        const std::unique_ptr<std::atomic<T *>[]> slots;
+    };
+
+  public:
+    /// @brief Constructor of the ChaseLevDeque class.
+    /// @param initial_size Initial number of slots, which must be a power of two.
+    explicit ChaseLevDeque(std::int64_t initial_size = 256)
+    {
+        rings_.push_back(std::make_unique<Ring>(initial_size));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    /// @brief Adds an element at the bottom. Must only be called by the owner thread.
+    void push(T *element)
+    {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t top = top_.load(std::memory_order_acquire);
+        Ring *ring = ring_.load(std::memory_order_relaxed);
+        if (bottom - top > ring->mask)
+        {
+            ring = grow(ring, top, bottom);
+        }
+        ring->put(bottom, element);
+        // Publishes the element, and the object it points to, to the thieves that read the new bottom
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /// @brief Removes the element at the bottom, the one pushed last. Must only be called by the owner thread.
+    /// @return The element, or nullptr if the deque is empty or a thief took the last element.
+    T *take() noexcept
+    {
+        const std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring *ring = ring_.load(std::memory_order_relaxed);
+        // Reserves the bottom element before looking at top; both are sequentially consistent so that a concurrent
+        // thief sees the reservation or the owner sees the steal
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_seq_cst);
+        if (top > bottom)
+        {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T *element = ring->get(bottom);
+        if (top == bottom)
+        {
+            // Last element: race the thieves for it
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                element = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return element;
+    }
+
+    /// @brief Removes the element at the top, the oldest one. May be called by any thread.
+    /// @return The element, or nullptr if the deque is empty or another thread took the element first.
+    T *steal() noexcept
+    {
+        std::int64_t top = top_.load(std::memory_order_seq_cst);
+        const std::int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+        T *element = ring_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return element;
+    }
+
+    /// @brief Returns whether the deque looked empty at some point during the call.
+    bool empty() const noexcept
+    {
+        return top_.load(std::memory_order_relaxed) >= bottom_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /// @brief Replaces the ring by one of twice the size that holds the same elements.
+    Ring *grow(Ring *ring, std::int64_t top, std::int64_t bottom)
+    {
+        rings_.push_back(std::make_unique<Ring>(2 * (ring->mask + 1)));
+        Ring *bigger = rings_.back().get();
+        for (std::int64_t index = top; index < bottom; ++index)
+        {
+            bigger->put(index, ring->get(index));
+        }
+        ring_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Ring *> ring_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+/// @brief PointerRing is an unbounded FIFO of pointers for a single thread at a time, in a ring whose size is a power
+/// of two. The ring doubles when it is full and never shrinks, so once it has held its peak number of elements,
+/// pushing and popping allocate nothing, unlike a std::deque, which allocates and frees a block every 64 pointers.
+/// @tparam T Type of the elements, which are stored as pointers
+template <typename T> class PointerRing final
+{
+  public:
+    /// @brief Constructor of the PointerRing class.
+    /// @param initial_size Initial number of slots, which must be a power of two.
+    explicit PointerRing(std::size_t initial_size = 256) : slots_(initial_size)
+    {
+    }
+
+    bool empty() const noexcept
+    {
+        return head_ == tail_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return tail_ - head_;
+    }
+
+    /// @brief Appends the element, doubling the ring if it is full.
+    void push(T *element)
+    {
+        if (size() == slots_.size())
+        {
+            grow();
+        }
+        slots_[tail_++ & (slots_.size() - 1)] = element;
+    }
+
+    /// @brief Removes and returns the oldest element, which must exist.
+    T *pop() noexcept
+    {
+        return slots_[head_++ & (slots_.size() - 1)];
+    }
+
+  private:
+    /// @brief Replaces the ring by one of twice the size that holds the same elements from its first slot on.
+    void grow()
+    {
+        std::vector<T *> bigger(2 * slots_.size());
+        for (std::size_t index = head_; index != tail_; ++index)
+        {
+            bigger[index - head_] = slots_[index & (slots_.size() - 1)];
+        }
+        tail_ -= head_;
+        head_ = 0;
+        slots_.swap(bigger);
+    }
+
+    std::vector<T *> slots_;
+    std::size_t head_ = 0;
+    std::size_t tail_ = 0;
+};
+
+/// @brief Number of times an idle worker looks for a task before it parks, pausing in between.
+inline constexpr std::uint32_t work_stealing_spin_attempts = 64;
+
+/// @brief Number of pause instructions between two looks of a spinning worker.
+inline constexpr std::uint32_t work_stealing_pauses_per_attempt = 32;
+
+/// @brief Default interval at which pushed tasks are sampled for the latency histograms. Reading the clock at push and
+/// at start costs about as much as scheduling a small task, so only one of this many tasks per pushing thread pays it.
+inline constexpr std::uint32_t work_stealing_latency_sampling_interval = 32;
+
+template <typename T> class FutureState;
+template <typename T> class PoolFuture;
+template <typename T> class FuturePromise;
+
+/// @brief WorkStealingThreadPool runs tasks on a fixed set of worker threads, each of which owns a ChaseLevDeque.
+/// A task pushed by a worker goes to the bottom of its own deque, and the worker takes its own tasks back in LIFO
+/// order, which keeps recently touched data in its cache. A worker whose deque is empty takes a task pushed by a
+/// thread outside the pool from the shared injection queue, or steals the oldest task of a randomly chosen victim,
+/// which spreads the stealing evenly and tends to take the largest pieces of work. Tasks are InplaceFunctions that are
+/// created in a thread-cached ObjectPool, so pushing a task does not allocate in steady state. A worker that finds no
+/// task spins for a bounded number of attempts, which hides the wake-up latency from bursts of tasks, and then parks
+/// on an EventCount, so idle workers do not use the CPU. Every push wakes one parked worker, if there is one.
+/// submit() returns a PoolFuture for the result of the task.
+///
+/// Every task has a TaskPriority, and every priority class has its own deque per worker and its own injection queue.
+/// A worker first looks at its own deques and the shared queues of all classes, from the highest class, and only
+/// then steals, again from the highest class, so that a high priority task never waits behind bulk work that the
+/// worker could have deferred. TaskAging keeps the lower classes from starving. A task without an explicit priority
+/// gets the priority of the task that pushes it, or normal priority outside the pool. A task may also have a
+/// deadline: it then waits in a queue of its class ordered by deadline, which a worker only looks at after the
+/// worker's own deque and the injection queue of the class, and once its deadline is less than task_deadline_lead_ns
+/// away, the next worker that looks for a task runs it ahead of all classes. The time from push to start of a sample
+/// of the tasks is recorded per class in histograms that latencyHistogram() returns.
+class WorkStealingThreadPool
+{
+  public:
+    /// @brief Type of the tasks, whose captures must fit into the inline buffer of the InplaceFunction.
+    using Task = InplaceFunction<void()>;
+
+    /// @brief Constructor of the WorkStealingThreadPool class.
+    /// @param num_threads Number of worker threads.
+    /// @param latency_sampling_interval Record the latency of every latency_sampling_interval-th task that a thread
+    /// pushes, 0 disables the latency histograms.
+    explicit WorkStealingThreadPool(std::uint32_t num_threads = std::thread::hardware_concurrency(),
+                                    std::uint32_t latency_sampling_interval = work_stealing_latency_sampling_interval)
+        : latency_sampling_interval_(latency_sampling_interval)
+    {
+        for (std::uint32_t i = 0; i < num_threads; ++i)
+        {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->random_state = 2654435769U * (i + 1);
+        }
+        for (std::uint32_t i = 0; i < num_threads; ++i)
+        {
+            threads_.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+    /// @brief Destructor of the WorkStealingThreadPool class, stops the workers and discards the tasks that have not
+    /// started yet. The futures of discarded submit() tasks and then() continuations complete with a broken_promise
+    /// std::future_error, so that nobody waits on the destroyed pool.
+    ~WorkStealingThreadPool()
+    {
+        done_.store(true);
+        idle_.notifyAll();
+        for (auto &thread : threads_)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+        // Breaking the promise of a future runs its continuation, which may push another task onto this pool
+        for (bool discarded = true; discarded;)
+        {
+            discarded = false;
+            for (auto &worker : workers_)
+            {
+                for (auto &deque : worker->deques)
+                {
+                    while (ScheduledTask *task = deque.take())
+                    {
+                        taskPool().destroy(task);
+                        discarded = true;
+                    }
+                }
+            }
+            for (std::size_t level = 0; level < number_of_task_priorities; ++level)
+            {
+                while (ScheduledTask *task = popInjectedTask(level))
+                {
+                    taskPool().destroy(task);
+                    discarded = true;
+                }
+                while (ScheduledTask *task = popDeadlineTask(level))
+                {
+                    taskPool().destroy(task);
+                    discarded = true;
+                }
+            }
+        }
+    }
+
+    /// @brief Pushes a task with the priority of the task that runs on the calling thread, or with normal priority
+    /// outside the pool. A worker of the pool pushes onto its own deque, any other thread onto the injection queue.
+    template <typename F> void pushTask(F &&task)
+    {
+        pushTask(std::forward<F>(task), current_priority_);
+    }
+
+    /// @brief Pushes a task with the given priority.
+    template <typename F> void pushTask(F &&task, TaskPriority priority)
+    {
+        ScheduledTask *scheduled_task =
+            taskPool().create(std::forward<F>(task), priority, no_deadline, samplePushTicks());
+        const std::size_t level = priorityIndex(priority);
+        if (current_pool_ == this)
+        {
+            workers_[current_worker_index_]->deques[level].push(scheduled_task);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(injection_mutex_);
+            try
+            {
+                injected_tasks_[level].push(scheduled_task);
+            }
+            catch (...)
+            {
+                taskPool().destroy(scheduled_task);
+                throw;
+            }
+            number_of_injected_tasks_[level].store(injected_tasks_[level].size(), std::memory_order_release);
+        }
+        idle_.notifyOne();
+    }
+
+    /// @brief Pushes a task with the given priority that should start before the deadline. It runs after the queued
+    /// tasks of its priority class, in order of deadline, and ahead of all classes once the deadline is close.
+    template <typename F>
+    void pushTask(F &&task, TaskPriority priority, std::chrono::steady_clock::time_point deadline)
+    {
+        const std::int64_t deadline_ns = deadline.time_since_epoch().count();
+        ScheduledTask *scheduled_task =
+            taskPool().create(std::forward<F>(task), priority, deadline_ns, samplePushTicks());
+        DeadlineQueue &queue = deadline_queues_[priorityIndex(priority)];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            try
+            {
+                queue.tasks.push_back(scheduled_task);
+            }
+            catch (...)
+            {
+                taskPool().destroy(scheduled_task);
+                throw;
+            }
+            std::push_heap(queue.tasks.begin(), queue.tasks.end(), LaterDeadline());
+            queue.earliest_deadline_ns.store(queue.tasks.front()->deadline_ns, std::memory_order_relaxed);
+            queue.size.store(queue.tasks.size(), std::memory_order_release);
+        }
+        number_of_deadline_tasks_.fetch_add(1, std::memory_order_release);
+        idle_.notifyOne();
+    }
+
+    /// @brief Pushes a task with the priority of the task that runs on the calling thread, or with normal priority
+    /// outside the pool, and returns a future for its result, or for the exception that it throws.
+    template <typename F> PoolFuture<std::invoke_result_t<std::decay_t<F> &>> submit(F &&function)
+    {
+        return submit(std::forward<F>(function), current_priority_);
+    }
+
+    /// @brief Pushes a task with the given priority and returns a future for its result, or for the exception that
+    /// it throws.
+    template <typename F>
+    PoolFuture<std::invoke_result_t<std::decay_t<F> &>> submit(F &&function, TaskPriority priority)
+    {
+        using Result = std::invoke_result_t<std::decay_t<F> &>;
+        FutureState<Result> *state = FutureState<Result>::create(this);
+        PoolFuture<Result> future(state);
+        pushTask(
+            [producer = FuturePromise<Result>(state), function = std::forward<F>(function)]() mutable {
+                producer.fulfil(function);
+            },
+            priority);
+        return future;
+    }
+
+    /// @brief Runs one pending task on the calling thread, if there is one, so that a thread that waits for a result
+    /// helps to compute it. On a worker, the task comes from where the worker would look next; on any other thread,
+    /// from the shared queues or a random worker, from the highest priority class.
+    /// @return Whether a task was run.
+    bool tryRunPendingTask()
+    {
+        if (current_pool_ == this)
+        {
+            Worker &worker = *workers_[current_worker_index_];
+            ScheduledTask *task = findTask(worker);
+            if (task == nullptr)
+            {
+                return false;
+            }
+            runTask(task, worker.latencies, true);
+            return true;
+        }
+
+        ScheduledTask *task = popLateTask();
+        for (std::size_t level = 0; task == nullptr && level < number_of_task_priorities; ++level)
+        {
+            task = popInjectedTask(level);
+            if (task == nullptr)
+            {
+                task = popDeadlineTask(level);
+            }
+            if (task == nullptr)
+            {
+                task = stealTask(external_random_state_, nullptr, level);
+            }
+        }
+        if (task == nullptr)
+        {
+            return false;
+        }
+        runTask(task, external_latencies_, false);
+        return true;
+    }
+
+    /// @brief Returns whether the calling worker's own deque is empty, or, on a thread outside the pool, whether the
+    /// injection queue is empty, for the priority that a task pushed now would get. Lazy splitting of loops uses it
+    /// as the sign that other workers could use more work.
+    bool localQueueEmpty() const noexcept
+    {
+        const std::size_t level = priorityIndex(current_priority_);
+        if (current_pool_ == this)
+        {
+            return workers_[current_worker_index_]->deques[level].empty();
+        }
+        return number_of_injected_tasks_[level].load(std::memory_order_relaxed) == 0;
+    }
+
+    /// @brief Returns whether the calling thread is a worker of the pool.
+    bool isWorkerThread() const noexcept
+    {
+        return current_pool_ == this;
+    }
+
+    /// @brief Returns the number of worker threads.
+    std::size_t numberOfThreads() const noexcept
+    {
+        return threads_.size();
+    }
+
+    /// @brief Returns the histogram of the times from push to start of the sampled tasks of the priority class that
+    /// started since the pool was created or the histograms were reset.
+    TaskLatencyHistogram latencyHistogram(TaskPriority priority) const
+    {
+        TaskLatencyHistogram histogram;
+        const std::size_t level = priorityIndex(priority);
+        for (const auto &worker : workers_)
+        {
+            worker->latencies.addTo(level, histogram);
+        }
+        external_latencies_.addTo(level, histogram);
+        histogram.nanoseconds_per_tick = tick_calibration_.nanosecondsPerTick();
+        return histogram;
+    }
+
+    /// @brief Clears the latency histograms of all priority classes. Latencies that workers record meanwhile may be
+    /// lost.
+    void resetLatencyHistograms() noexcept
+    {
+        for (auto &worker : workers_)
+        {
+            worker->latencies.reset();
+        }
+        external_latencies_.reset();
+    }
+
+  private:
+    /// @brief Task together with what the scheduler needs to know about it.
+    struct ScheduledTask
+    {
+        template <typename F>
+        ScheduledTask(F &&function, TaskPriority priority, std::int64_t deadline_ns, std::uint64_t push_ticks)
+            : function(std::forward<F>(function)), push_ticks(push_ticks), deadline_ns(deadline_ns), priority(priority)
+        {
+        }
+
+        Task function;
+        /// @brief Time of the push in latency ticks, or 0 if the latency of the task is not sampled.
+        std::uint64_t push_ticks;
+        std::int64_t deadline_ns;
+        TaskPriority priority;
+    };
+
+    /// @brief Heap order of the deadline queues, which puts the earliest deadline at the front.
+    struct LaterDeadline
+    {
+        bool operator()(const ScheduledTask *lhs, const ScheduledTask *rhs) const noexcept
+        {
+            return lhs->deadline_ns > rhs->deadline_ns;
+        }
+    };
+
+    /// @brief Tasks with a deadline of one priority class, in a heap under a mutex, with their number and the earliest
+    /// deadline readable without the lock.
+    struct alignas(64) DeadlineQueue
+    {
+        std::mutex mutex;
+        std::vector<ScheduledTask *> tasks;
+        std::atomic<std::size_t> size{0};
+        std::atomic<std::int64_t> earliest_deadline_ns{no_deadline};
+    };
+
+    /// @brief Deques of a worker per priority class, the state of its victim selection and aging, and its latency
+    /// counters, on their own cache lines.
+    struct alignas(64) Worker
+    {
+        std::array<ChaseLevDeque<ScheduledTask>, number_of_task_priorities> deques;
+        std::uint32_t random_state = 0;
+        TaskAging aging;
+        TaskLatencyCounters latencies;
+    };
+
+    static constexpr std::int64_t no_deadline = INT64_MAX;
+
+    static ObjectPool<ScheduledTask> &taskPool()
+    {
+        return ObjectPool<ScheduledTask>::shared();
+    }
+
+    /// @brief Main loop of the worker thread with the given index.
+    void run(std::uint32_t worker_index)
+    {
+        current_pool_ = this;
+        current_worker_index_ = worker_index;
+        Worker &worker = *workers_[worker_index];
+        while (!done_.load(std::memory_order_relaxed))
+        {
+            ScheduledTask *task = findTask(worker);
+            if (task == nullptr)
+            {
+                task = spinForTask(worker);
+            }
+            if (task == nullptr)
+            {
+                // Park, unless a task or the stop request arrived after the last look
+                idle_.prepareWait();
+                task = findTask(worker);
+                if (task == nullptr && !done_.load())
+                {
+                    idle_.commitWait();
+                    continue;
+                }
+                idle_.cancelWait();
+            }
+            if (task != nullptr)
+            {
+                runTask(task, worker.latencies, true);
+            }
+        }
+        current_pool_ = nullptr;
+    }
+
+    /// @brief Returns the current time in latency ticks if the task that the calling thread pushes now is sampled,
+    /// and 0 otherwise.
+    std::uint64_t samplePushTicks() const noexcept
+    {
+        if (latency_sampling_interval_ == 0 || ++pushes_since_sample_ < latency_sampling_interval_)
+        {
+            return 0;
+        }
+        pushes_since_sample_ = 0;
+        return latencyTicks();
+    }
+
+    /// @brief Records the latency of the task if it is sampled, runs it with its priority as the one of the calling
+    /// thread, and destroys it.
+    void runTask(ScheduledTask *task, TaskLatencyCounters &latencies, bool single_writer)
+    {
+        if (task->push_ticks != 0)
+        {
+            latencies.record(priorityIndex(task->priority), latencyTicks() - task->push_ticks, single_writer);
+        }
+        const TaskPriority outer_priority = std::exchange(current_priority_, task->priority);
+        task->function();
+        current_priority_ = outer_priority;
+        taskPool().destroy(task);
+    }
+
+    /// @brief Looks for a task: first for a task whose deadline is close, then in the worker's own deques and the
+    /// shared queues, and then in the deques of the others, each time from the class that the aging puts first.
+    ScheduledTask *findTask(Worker &worker)
+    {
+        ScheduledTask *task = popLateTask();
+        const std::size_t first_level = worker.aging.firstLevel();
+        for (std::size_t rank = 0; task == nullptr && rank < number_of_task_priorities; ++rank)
+        {
+            const std::size_t level = TaskAging::levelAt(first_level, rank);
+            // The owner never sees its own deque falsely empty, and the check spares take() its fence
+            if (!worker.deques[level].empty())
+            {
+                task = worker.deques[level].take();
+            }
+            if (task == nullptr)
+            {
+                task = popInjectedTask(level);
+            }
+            if (task == nullptr)
+            {
+                task = popDeadlineTask(level);
+            }
+        }
+        for (std::size_t rank = 0; task == nullptr && rank < number_of_task_priorities; ++rank)
+        {
+            task = stealTask(worker.random_state, &worker, TaskAging::levelAt(first_level, rank));
+        }
+        if (task != nullptr)
+        {
+            worker.aging.ran(first_level, priorityIndex(task->priority));
+        }
+        return task;
+    }
+
+    /// @brief Looks for a task up to work_stealing_spin_attempts times, pausing in between.
+    __attribute__((noinline)) ScheduledTask *spinForTask(Worker &worker)
+    {
+        for (std::uint32_t attempt = 0; attempt < work_stealing_spin_attempts; ++attempt)
+        {
+            for (std::uint32_t pause = 0; pause < work_stealing_pauses_per_attempt; ++pause)
+            {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            }
+            if (done_.load(std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            if (ScheduledTask *task = findTask(worker))
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Takes the oldest task of the priority class pushed from outside the pool, without taking the lock if
+    /// there is none.
+    ScheduledTask *popInjectedTask(std::size_t level)
+    {
+        if (number_of_injected_tasks_[level].load(std::memory_order_acquire) == 0)
+        {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        PointerRing<ScheduledTask> &tasks = injected_tasks_[level];
+        if (tasks.empty())
+        {
+            return nullptr;
+        }
+        ScheduledTask *task = tasks.pop();
+        number_of_injected_tasks_[level].store(tasks.size(), std::memory_order_release);
+        return task;
+    }
+
+    /// @brief Takes the task of the priority class with the earliest deadline, if its deadline is not later than the
+    /// given one, without taking the lock if there is none.
+    ScheduledTask *popDeadlineTask(std::size_t level, std::int64_t latest_deadline_ns = no_deadline)
+    {
+        DeadlineQueue &queue = deadline_queues_[level];
+        if (queue.size.load(std::memory_order_acquire) == 0 ||
+            queue.earliest_deadline_ns.load(std::memory_order_relaxed) > latest_deadline_ns)
+        {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty() || queue.tasks.front()->deadline_ns > latest_deadline_ns)
+        {
+            return nullptr;
+        }
+        std::pop_heap(queue.tasks.begin(), queue.tasks.end(), LaterDeadline());
+        ScheduledTask *task = queue.tasks.back();
+        queue.tasks.pop_back();
+        queue.earliest_deadline_ns.store(queue.tasks.empty() ? no_deadline : queue.tasks.front()->deadline_ns,
+                                         std::memory_order_relaxed);
+        queue.size.store(queue.tasks.size(), std::memory_order_release);
+        number_of_deadline_tasks_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    /// @brief Takes a task whose deadline is less than task_deadline_lead_ns away, from the highest priority class
+    /// that has one. Reads the clock only while there are tasks with a deadline.
+    ScheduledTask *popLateTask()
+    {
+        if (number_of_deadline_tasks_.load(std::memory_order_acquire) == 0)
+        {
+            return nullptr;
+        }
+        const std::int64_t late_deadline_ns =
+            std::chrono::steady_clock::now().time_since_epoch().count() + task_deadline_lead_ns;
+        for (std::size_t level = 0; level < number_of_task_priorities; ++level)
+        {
+            if (ScheduledTask *task = popDeadlineTask(level, late_deadline_ns))
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Tries to steal a task of the priority class from every worker but the thief once, starting at a random
+    /// victim.
+    /// @param random_state State of the thief's random number generator.
+    /// @param thief Worker that steals, or nullptr for a thread outside the pool.
+    ScheduledTask *stealTask(std::uint32_t &random_state, const Worker *thief, std::size_t level)
+    {
+        const std::size_t number_of_workers = workers_.size();
+        if (number_of_workers == 0)
+        {
+            return nullptr;
+        }
+        // xorshift32
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        const std::size_t first_victim = random_state % number_of_workers;
+        for (std::size_t i = 0; i < number_of_workers; ++i)
+        {
+            Worker &victim = *workers_[(first_victim + i) % number_of_workers];
+            if (&victim == thief)
+            {
+                continue;
+            }
+            if (ScheduledTask *task = victim.deques[level].steal())
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Pool and index of the worker that runs on the current thread, constant-initialized so that reading them
+    /// needs no thread_local initialization check.
+    static inline thread_local WorkStealingThreadPool *current_pool_ = nullptr;
+    static inline thread_local std::uint32_t current_worker_index_ = 0;
+    /// @brief Priority of the task that runs on the current thread, which tasks pushed without one inherit.
+    static inline thread_local TaskPriority current_priority_ = TaskPriority::normal;
+    /// @brief State of the random victim selection of threads outside the pool.
+    static inline thread_local std::uint32_t external_random_state_ = 2463534242U;
+    /// @brief Number of tasks that the current thread pushed since the last one sampled for the latency histograms.
+    static inline thread_local std::uint32_t pushes_since_sample_ = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex injection_mutex_;
+    std::array<PointerRing<ScheduledTask>, number_of_task_priorities> injected_tasks_;
+    std::array<std::atomic<std::size_t>, number_of_task_priorities> number_of_injected_tasks_{};
+    std::array<DeadlineQueue, number_of_task_priorities> deadline_queues_;
+    std::atomic<std::size_t> number_of_deadline_tasks_{0};
+    std::atomic<bool> done_{false};
+    EventCount idle_;
+    TaskLatencyCounters external_latencies_;
+    const std::uint32_t latency_sampling_interval_;
+    const LatencyTickCalibration tick_calibration_;
+};
+
+/// @brief Number of pause instructions that a thread waiting for a PoolFuture spends before it sleeps, when there is
+/// no pending task to run meanwhile.
+inline constexpr std::uint32_t pool_future_spin_pauses = 1024;
+
+/// @brief Longest sleep of a worker that waits for a PoolFuture before it looks for pending tasks again, so that tasks
+/// pushed while all workers wait are still run.
+inline constexpr long pool_future_worker_sleep_ns = 50'000;
+
+/// @brief FutureState is the shared state of a PoolFuture and of the task or continuation that produces its result.
+/// The result is stored inline, and the state itself is created in a thread-cached ObjectPool, so completing a future
+/// does not allocate in steady state. The state is reference counted by its two sides. One status word records
+/// whether the result is ready, whether a continuation is attached and whether a thread sleeps on it, so that
+/// attaching a continuation and completing race with a single atomic operation each, and completing only makes a
+/// futex call if a thread sleeps.
+/// @tparam T Type of the result
+template <typename T> class FutureState final
+{
+    struct Empty
+    {
+    };
+    using Value = std::conditional_t<std::is_void_v<T>, Empty, T>;
+
+    static constexpr std::uint32_t ready_bit = 1;
+    static constexpr std::uint32_t continuation_bit = 2;
+    static constexpr std::uint32_t waiter_bit = 4;
+
+  public:
+    /// @brief Creates a state that is referenced by a future and by its producer.
+    /// @param pool Pool that runs continuations and whose pending tasks waiting threads run, or nullptr.
+    static FutureState *create(WorkStealingThreadPool *pool)
+    {
+        return ObjectPool<FutureState>::shared().create(pool);
+    }
+
+    explicit FutureState(WorkStealingThreadPool *pool) noexcept : pool_(pool)
+    {
+    }
+
+    FutureState(const FutureState &) = delete;
+    FutureState &operator=(const FutureState &) = delete;
+
+    ~FutureState()
+    {
+        if (has_value_)
+        {
+            value().~Value();
+        }
+    }
+
+    /// @brief Drops one of the two references and destroys the state with the last one.
+    void release() noexcept
+    {
+        if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            ObjectPool<FutureState>::shared().destroy(this);
+        }
+    }
+
+    /// @brief Stores the result of the function called with the arguments, or the exception that it throws, and
+    /// completes the state.
+    template <typename F, typename... Args> void fulfil(F &function, Args &&...args) noexcept
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                std::invoke(function, std::forward<Args>(args)...);
+                ::new (static_cast<void *>(storage_)) Value();
+            }
+            else
+            {
+                ::new (static_cast<void *>(storage_)) Value(std::invoke(function, std::forward<Args>(args)...));
+            }
+            has_value_ = true;
+        }
+        catch (...)
+        {
+            exception_ = std::current_exception();
+        }
+        complete();
+    }
+
+    /// @brief Stores the result and completes the state.
+    template <typename... Args> void setValue(Args &&...args)
+    {
+        ::new (static_cast<void *>(storage_)) Value(std::forward<Args>(args)...);
+        has_value_ = true;
+        complete();
+    }
+
+    /// @brief Stores the exception and completes the state.
+    void setException(std::exception_ptr exception) noexcept
+    {
+        exception_ = std::move(exception);
+        complete();
+    }
+
+    /// @brief Returns whether the result or the exception is stored.
+    bool ready() const noexcept
+    {
+        return (status_.load(std::memory_order_acquire) & ready_bit) != 0;
+    }
+
+    /// @brief Waits until the state is complete. Meanwhile, the calling thread runs pending tasks of the pool, then
+    /// spins, and then sleeps; a worker sleeps only briefly, to look for pending tasks again.
+    void wait() noexcept
+    {
+        std::uint32_t pauses = 0;
+        while (!ready())
+        {
+            if (pool_ != nullptr && pool_->tryRunPendingTask())
+            {
+                continue;
+            }
+            if (pauses < pool_future_spin_pauses)
+            {
+                ++pauses;
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+                continue;
+            }
+            const std::uint32_t status = status_.fetch_or(waiter_bit, std::memory_order_acq_rel) | waiter_bit;
+            if ((status & ready_bit) != 0)
+            {
+                return;
+            }
+            const timespec worker_sleep = {0, pool_future_worker_sleep_ns};
+            const bool worker = pool_ != nullptr && pool_->isWorkerThread();
+            futexWait(&status_, status, worker ? &worker_sleep : nullptr);
+        }
+    }
+
+    /// @brief Waits until the state is complete and returns the result, or throws the stored exception.
+    T get()
+    {
+        wait();
+        if (exception_)
+        {
+            std::rethrow_exception(exception_);
+        }
+        if constexpr (!std::is_void_v<T>)
+        {
+            return std::move(value());
+        }
+    }
+
+    /// @brief Returns the stored exception, or nullptr, once the state is complete.
+    const std::exception_ptr &exception() const noexcept
+    {
+        return exception_;
+    }
+
+    /// @brief Returns the stored result once the state is complete without an exception.
+    Value &value() noexcept
+    {
+        return *std::launder(reinterpret_cast<Value *>(storage_));
+    }
+
+    /// @brief Attaches the continuation that runs when the state completes, or at once if it is complete already.
+    /// Only one continuation can be attached at a time; another one only after the previous one has started.
+    /// @param executor Pool that the continuation is pushed to, or nullptr to run it on the completing thread.
+    void setContinuation(InplaceFunction<void()> &&continuation, WorkStealingThreadPool *executor)
+    {
+        assert((status_.load(std::memory_order_acquire) & continuation_bit) == 0 &&
+               "FutureState already has a continuation");
+        continuation_ = std::move(continuation);
+        executor_ = executor;
+        if ((status_.fetch_or(continuation_bit, std::memory_order_acq_rel) & ready_bit) != 0)
+        {
+            runContinuation();
+        }
+    }
+
+    /// @brief Returns the pool of the state.
+    WorkStealingThreadPool *pool() const noexcept
+    {
+        return pool_;
+    }
+
+  private:
+    void complete() noexcept
+    {
+        const std::uint32_t previous = status_.fetch_or(ready_bit, std::memory_order_acq_rel);
+        if ((previous & continuation_bit) != 0)
+        {
+            runContinuation();
+        }
+        if ((previous & waiter_bit) != 0)
+        {
+            futexWake(&status_, INT_MAX);
+        }
+    }
+
+    /// @brief Takes the continuation out of the state and detaches it before running it, so that whoever gets the
+    /// future from the continuation may attach the next one.
+    void runContinuation() noexcept
+    {
+        InplaceFunction<void()> continuation = std::move(continuation_);
+        WorkStealingThreadPool *const executor = executor_;
+        status_.fetch_and(~continuation_bit, std::memory_order_acq_rel);
+        if (executor != nullptr)
+        {
+            executor->pushTask(std::move(continuation));
+        }
+        else
+        {
+            continuation();
+        }
+    }
+
+    alignas(Value) std::byte storage_[sizeof(Value)];
+    bool has_value_ = false;
+    std::exception_ptr exception_;
+    std::atomic<std::uint32_t> status_{0};
+    std::atomic<std::uint32_t> references_{2};
+    WorkStealingThreadPool *const pool_;
+    WorkStealingThreadPool *executor_ = nullptr;
+    InplaceFunction<void()> continuation_;
+};
+
+/// @brief FuturePromise holds the producer's reference to a FutureState, in a task or continuation that completes
+/// it. A promise that is destroyed before it is fulfilled, because its pool discarded the task, completes the state
+/// with a broken_promise std::future_error, like std::promise.
+/// @tparam T Type of the result
+template <typename T> class FuturePromise final
+{
+  public:
+    /// @brief Constructor of the FuturePromise class, takes over the producer's reference to the state.
+    explicit FuturePromise(FutureState<T> *state) noexcept : state_(state)
+    {
+    }
+
+    FuturePromise(FuturePromise &&other) noexcept : state_(std::exchange(other.state_, nullptr))
+    {
+    }
+
+    FuturePromise(const FuturePromise &) = delete;
+    FuturePromise &operator=(const FuturePromise &) = delete;
+    FuturePromise &operator=(FuturePromise &&) = delete;
+
+    ~FuturePromise()
+    {
+        if (state_ != nullptr)
+        {
+            setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    /// @brief Stores the result of the function called with the arguments, or the exception that it throws, and
+    /// drops the reference to the state.
+    template <typename F, typename... Args> void fulfil(F &function, Args &&...args) noexcept
+    {
+        FutureState<T> *state = std::exchange(state_, nullptr);
+        state->fulfil(function, std::forward<Args>(args)...);
+        state->release();
+    }
+
+    /// @brief Stores the exception and drops the reference to the state.
+    void setException(std::exception_ptr exception) noexcept
+    {
+        FutureState<T> *state = std::exchange(state_, nullptr);
+        state->setException(std::move(exception));
+        state->release();
+    }
+
+  private:
+    FutureState<T> *state_;
+};
+
+/// @brief Result of when_any(): the index of the first future that became ready, and futures for the results of all
+/// futures, in the same order.
+template <typename T> struct WhenAnyResult
+{
+    std::size_t index;
+    std::vector<PoolFuture<T>> futures;
+};
+
+/// @brief Result type of a continuation F of a PoolFuture<T>, which is called with the T, or without arguments for
+/// PoolFuture<void>.
+template <typename F, typename T> struct PoolContinuationResult
+{
+    using type = std::invoke_result_t<std::decay_t<F> &, T>;
+};
+
+template <typename F> struct PoolContinuationResult<F, void>
+{
+    using type = std::invoke_result_t<std::decay_t<F> &>;
+};
+
+/// @brief PoolFuture is the move-only result of WorkStealingThreadPool::submit(). Unlike std::future, waiting for it
+/// runs pending tasks of the pool instead of blocking the thread, then() attaches a continuation that the pool runs
+/// when the result is ready, and when_all() and when_any() combine futures without blocking.
+/// @tparam T Type of the result
+template <typename T> class PoolFuture final
+{
+    template <typename F> using ContinuationResult = typename PoolContinuationResult<F, T>::type;
+
+  public:
+    PoolFuture() noexcept = default;
+
+    /// @brief Constructor of the PoolFuture class, takes over the future's reference to the state.
+    explicit PoolFuture(FutureState<T> *state) noexcept : state_(state)
+    {
+    }
+
+    PoolFuture(PoolFuture &&other) noexcept : state_(std::exchange(other.state_, nullptr))
+    {
+    }
+
+    PoolFuture &operator=(PoolFuture &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            state_ = std::exchange(other.state_, nullptr);
+        }
+        return *this;
+    }
+
+    PoolFuture(const PoolFuture &) = delete;
+    PoolFuture &operator=(const PoolFuture &) = delete;
+
+    ~PoolFuture()
+    {
+        reset();
+    }
+
+    /// @brief Returns whether the future refers to a state.
+    bool valid() const noexcept
+    {
+        return state_ != nullptr;
+    }
+
+    /// @brief Returns whether the result is ready.
+    bool ready() const noexcept
+    {
+        return state_->ready();
+    }
+
+    /// @brief Waits until the result is ready, running pending tasks of the pool meanwhile.
+    void wait() const noexcept
+    {
+        state_->wait();
+    }
+
+    /// @brief Waits until the result is ready and returns it, or throws the exception of the task. The future is
+    /// invalid afterwards.
+    T get()
+    {
+        FutureState<T> *state = std::exchange(state_, nullptr);
+        struct Release
+        {
+            FutureState<T> *state;
+            ~Release()
+            {
+                state->release();
+            }
+        } release{state};
+        return state->get();
+    }
+
+    /// @brief Attaches a continuation that the pool runs with the result once it is ready, and returns a future for
+    /// the result of the continuation. If the task throws, the continuation does not run and the returned future
+    /// holds the exception. The future is invalid afterwards.
+    template <typename F> PoolFuture<ContinuationResult<F>> then(F &&function)
+    {
+        using Result = ContinuationResult<F>;
+        FutureState<Result> *next = FutureState<Result>::create(state_->pool());
+        PoolFuture<Result> future(next);
+        FutureState<T> *previous = state_;
+        previous->setContinuation(
+            [input = std::move(*this), producer = FuturePromise<Result>(next),
+             function = std::forward<F>(function)]() mutable {
+                FutureState<T> *previous = input.state_;
+                if (previous->exception())
+                {
+                    producer.setException(previous->exception());
+                }
+                else if constexpr (std::is_void_v<T>)
+                {
+                    producer.fulfil(function);
+                }
+                else
+                {
+                    producer.fulfil(function, std::move(previous->value()));
+                }
+            },
+            previous->pool());
+        return future;
+    }
+
+  private:
+    template <typename U> friend class PoolFuture;
+    template <typename U> friend PoolFuture<std::vector<PoolFuture<U>>> when_all(std::vector<PoolFuture<U>> futures);
+    template <typename U> friend PoolFuture<WhenAnyResult<U>> when_any(std::vector<PoolFuture<U>> futures);
+
+    void reset() noexcept
+    {
+        if (state_ != nullptr)
+        {
+            std::exchange(state_, nullptr)->release();
+        }
+    }
+
+    FutureState<T> *state_ = nullptr;
+};
+
+/// @brief Returns a future that becomes ready when all futures are ready, and then holds them. The futures are not
+/// waited for; each gets a continuation that counts down, and the last one completes the returned future on its
+/// completing thread.
+template <typename T> PoolFuture<std::vector<PoolFuture<T>>> when_all(std::vector<PoolFuture<T>> futures)
+{
+    using Result = std::vector<PoolFuture<T>>;
+    struct Aggregate
+    {
+        Result futures;
+        std::atomic<std::size_t> remaining;
+        FutureState<Result> *result;
+
+        // Called once per future and once by the caller, who holds a count while attaching the continuations
+        void countDown()
+        {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                result->setValue(std::move(futures));
+                result->release();
+                delete this;
+            }
+        }
+    };
+
+    WorkStealingThreadPool *pool = futures.empty() ? nullptr : futures.front().state_->pool();
+    FutureState<Result> *result = FutureState<Result>::create(pool);
+    auto *aggregate = new Aggregate{std::move(futures), {}, result};
+    aggregate->remaining.store(aggregate->futures.size() + 1, std::memory_order_relaxed);
+    for (PoolFuture<T> &future : aggregate->futures)
+    {
+        future.state_->setContinuation([aggregate] { aggregate->countDown(); }, nullptr);
+    }
+    aggregate->countDown();
+    return PoolFuture<Result>(result);
+}
+
+/// @brief Returns a future that becomes ready when the first of the futures is ready, and then holds its index and
+/// futures for the results of all of them. The input futures keep the continuation that when_any() attaches until
+/// they complete, so the returned futures are new ones, which the continuations complete with the moved results; they
+/// can be passed to when_any() again or get their own continuations. The index is the size of the vector if it is
+/// empty.
+template <typename T> PoolFuture<WhenAnyResult<T>> when_any(std::vector<PoolFuture<T>> futures)
+{
+    using Result = WhenAnyResult<T>;
+    struct Aggregate
+    {
+        std::vector<PoolFuture<T>> futures;
+        std::atomic<bool> decided;
+        std::size_t index;
+        // The result is delivered by the second of the first completing future and the caller, who is done
+        // attaching the continuations, and the aggregate is deleted after the last continuation
+        std::atomic<std::uint32_t> delivery_gate;
+        std::atomic<std::size_t> remaining;
+        FutureState<Result> *result;
+
+        void passGate()
+        {
+            if (delivery_gate.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                result->setValue(Result{index, std::move(futures)});
+                result->release();
+            }
+        }
+
+        void countDown()
+        {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                delete this;
+            }
+        }
+    };
+
+    WorkStealingThreadPool *pool = futures.empty() ? nullptr : futures.front().state_->pool();
+    FutureState<Result> *result = FutureState<Result>::create(pool);
+    const std::size_t number_of_futures = futures.size();
+    std::vector<FutureState<T> *> outputs;
+    outputs.reserve(number_of_futures);
+    std::vector<PoolFuture<T>> output_futures;
+    output_futures.reserve(number_of_futures);
+    for (const PoolFuture<T> &future : futures)
+    {
+        outputs.push_back(FutureState<T>::create(future.state_->pool()));
+        output_futures.emplace_back(outputs.back());
+    }
+    auto *aggregate = new Aggregate{std::move(output_futures), {false}, number_of_futures, {2}, {}, result};
+    aggregate->remaining.store(number_of_futures + 1, std::memory_order_relaxed);
+    if (number_of_futures == 0)
+    {
+        aggregate->passGate();
+    }
+    for (std::size_t index = 0; index < number_of_futures; ++index)
+    {
+        // The continuation takes over the input future's reference to its state
+        FutureState<T> *state = futures[index].state_;
+        state->setContinuation(
+            [aggregate, index, input = std::move(futures[index]),
+             producer = FuturePromise<T>(outputs[index])]() mutable {
+                FutureState<T> *previous = input.state_;
+                if (previous->exception())
+                {
+                    producer.setException(previous->exception());
+                }
+                else
+                {
+                    auto move_value = [previous]() -> T {
+                        if constexpr (!std::is_void_v<T>)
+                        {
+                            return std::move(previous->value());
+                        }
+                    };
+                    producer.fulfil(move_value);
+                }
+                input.reset();
+                if (!aggregate->decided.exchange(true, std::memory_order_acq_rel))
+                {
+                    aggregate->index = index;
+                    aggregate->passGate();
+                }
+                aggregate->countDown();
+            },
+            nullptr);
+    }
+    aggregate->passGate();
+    aggregate->countDown();
+    return PoolFuture<Result>(result);
+}
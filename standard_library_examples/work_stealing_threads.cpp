@@ -1,167 +1,125 @@
-#include <algorithm>  // std::for_each
-#include <cstdint>    // std::uint32_t
-#include <deque>      // std::deque
-#include <functional> // std::function
-#include <future>     // std::async
-#include <iostream>   // std::cout
-#include <memory>     // std::shared_ptr
-#include <mutex>      // std::mutex, std::unique_lock
-#include <thread>     // std::thread
-#include <utility>    // std::move
-#include <vector>     // std::vector
+#include "work_stealing_thread_pool.hpp"
 
-class WorkStealingThreadPool
+#include <chrono>    // std::chrono::high_resolution_clock
+#include <cstdint>   // std::uint32_t
+#include <future>    // std::future, std::packaged_task
+#include <iostream>  // std::cout
+#include <memory>    // std::make_shared
+#include <utility>   // std::move
+#include <vector>    // std::vector
+
+// Function to calculate the factorial of a number
+std::uint64_t factorial(std::uint32_t n)
 {
-  public:
-    WorkStealingThreadPool(std::uint32_t num_threads = std::thread::hardware_concurrency())
-        : done_{false}, queues_{num_threads}
+    std::uint64_t result = 1;
+    for (std::uint32_t i = 1; i <= n; ++i)
     {
-        for (std::uint32_t i = 0; i < num_threads; ++i)
-        {
-            threads_.emplace_back([this] {
-                while (!done_.load())
-                {
-                    std::function<void()> task;
-                    if (tryPopTask(task) || stealTask(task))
-                    {
-                        task();
-                    }
-                    else
-                    {
-                        // Provides a hint to the implementation to reschedule the execution of threads, allowing other
-                        // threads to run.
-                        std::this_thread::yield();
-                    }
-                }
-            });
-        }
+        result *= i;
     }
+    return result;
+}
 
-    ~WorkStealingThreadPool()
+constexpr std::int32_t number_of_rounds = 100000;
+
+/// @brief Computes the factorials through packaged_tasks held by shared_ptrs and waits for each std::future, which
+/// costs two allocations and a blocking wait per result. Returns the elapsed time.
+double benchmarkPackagedTasks(WorkStealingThreadPool &thread_pool, const std::vector<std::uint32_t> &numbers,
+                              std::uint64_t &checksum)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::future<std::uint64_t>> results;
+    for (std::int32_t i = 0; i < number_of_rounds; ++i)
     {
-        done_.store(true);
-        for (auto &thread : threads_)
+        for (const auto &number : numbers)
         {
-            if (thread.joinable())
-            {
-                thread.join();
-            }
+            auto task = std::make_shared<std::packaged_task<std::uint64_t()>>([number] { return factorial(number); });
+            results.push_back(task->get_future());
+            thread_pool.pushTask([task] { (*task)(); });
         }
     }
-
-    template <typename F> void pushTask(F &&task)
+    for (auto &result : results)
     {
-        std::uint32_t current_thread_index = thread_index_++;
-        if (thread_index_ >= threads_.size())
-        {
-            thread_index_ = 0;
-        }
-        {
-            std::unique_lock<std::mutex> lock(queues_mutex_);
-            queues_[current_thread_index].emplace_front(std::forward<F>(task));
-        }
+        checksum += result.get();
     }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
 
-  private:
-    bool tryPopTask(std::function<void()> &task)
-    {
-        std::unique_lock<std::mutex> lock(queues_mutex_, std::try_to_lock);
-        if (!lock)
-        {
-            return false;
-        }
+    return (stop_time - start_time).count() / 1e9;
+}
 
-        for (auto &queue : queues_)
+/// @brief Computes the factorials with submit() and waits for each PoolFuture, running pending tasks meanwhile.
+/// Returns the elapsed time.
+double benchmarkPoolFutures(WorkStealingThreadPool &thread_pool, const std::vector<std::uint32_t> &numbers,
+                            std::uint64_t &checksum)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<PoolFuture<std::uint64_t>> results;
+    for (std::int32_t i = 0; i < number_of_rounds; ++i)
+    {
+        for (const auto &number : numbers)
         {
-            if (!queue.empty())
-            {
-                task = std::move(queue.front());
-                queue.pop_front();
-                return true;
-            }
+            results.push_back(thread_pool.submit([number] { return factorial(number); }));
         }
-        return false;
     }
-
-    bool stealTask(std::function<void()> &task)
+    for (auto &result : results)
     {
-        std::unique_lock<std::mutex> lock(queues_mutex_);
-        for (auto it = queues_.rbegin(); it != queues_.rend(); ++it)
-        {
-            if (!it->empty())
-            {
-                task = std::move(it->back());
-                it->pop_back();
-                return true;
-            }
-        }
-        return false;
+        checksum += result.get();
     }
+    const auto stop_time = std::chrono::high_resolution_clock::now();
 
-    std::vector<std::thread> threads_;
-    std::vector<std::deque<std::function<void()>>> queues_;
-    std::mutex queues_mutex_;
-    std::atomic<std::uint32_t> thread_index_{0};
-    std::atomic<bool> done_;
-};
+    return (stop_time - start_time).count() / 1e9;
+}
 
-template <typename InputIt, typename Func>
-void parallelForEach(InputIt first, InputIt last, Func func, bool parallel = true)
+/// @brief Computes the factorials of every round with submit(), reduces them with then() continuations, and waits
+/// for all rounds at once with when_all(). Returns the elapsed time.
+double benchmarkContinuations(WorkStealingThreadPool &thread_pool, const std::vector<std::uint32_t> &numbers,
+                              std::uint64_t &checksum)
 {
-    if (parallel)
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<PoolFuture<std::uint64_t>> results;
+    for (std::int32_t i = 0; i < number_of_rounds; ++i)
     {
-        WorkStealingThreadPool thread_pool;
-        std::vector<std::future<void>> futures;
-
-        for (auto it = first; it != last; ++it)
-        {
-            futures.push_back(std::async(
-                std::launch::async, [&thread_pool, &func, it] { thread_pool.pushTask([&func, it] { func(*it); }); }));
-        }
-
-        for (auto &future : futures)
+        for (const auto &number : numbers)
         {
-            future.wait();
+            results.push_back(thread_pool.submit([number] { return factorial(number); }).then([](std::uint64_t value) {
+                return value % 1000;
+            }));
         }
     }
-    else
+    for (auto &result : when_all(std::move(results)).get())
     {
-        std::for_each(first, last, func);
+        checksum += result.get();
     }
-}
+    const auto stop_time = std::chrono::high_resolution_clock::now();
 
-// Function to calculate the factorial of a number
-std::uint64_t factorial(std::uint32_t n)
-{
-    std::uint64_t result = 1;
-    for (std::uint32_t i = 1; i <= n; ++i)
-    {
-        result *= i;
-    }
-    return result;
+    return (stop_time - start_time).count() / 1e9;
 }
 
 std::int32_t main(std::int32_t argc, const char **argv)
 {
     std::vector<std::uint32_t> numbers = {10, 5, 8, 12, 6};
-    std::vector<std::future<std::uint64_t>> results;
 
     WorkStealingThreadPool thread_pool;
 
-    for (std::int32_t i = 0; i < 100000; ++i)
+    std::vector<PoolFuture<std::uint64_t>> factorials;
+    for (const auto &number : numbers)
     {
-        for (const auto &number : numbers)
-        {
-            auto task = std::make_shared<std::packaged_task<std::uint64_t()>>([number] { return factorial(number); });
-            results.push_back(task->get_future());
-            thread_pool.pushTask([task] { (*task)(); });
-        }
+        factorials.push_back(thread_pool.submit([number] { return factorial(number); }));
     }
-
-    for (std::uint32_t i = 0; i < results.size(); ++i)
+    WhenAnyResult<std::uint64_t> first = when_any(std::move(factorials)).get();
+    std::cout << "First factorial ready: " << numbers[first.index] << std::endl;
+    for (auto &result : first.futures)
     {
-        std::cout << "Factorial: " << results[i].get() << std::endl;
+        std::cout << "Factorial: " << result.get() << std::endl;
     }
 
+    std::uint64_t checksum = 0;
+    std::cout << "Elapsed time (packaged_task and std::future): "
+              << benchmarkPackagedTasks(thread_pool, numbers, checksum) << std::endl;
+    std::cout << "Elapsed time (submit and PoolFuture): " << benchmarkPoolFutures(thread_pool, numbers, checksum)
+              << std::endl;
+    std::cout << "Elapsed time (submit, then and when_all): "
+              << benchmarkContinuations(thread_pool, numbers, checksum) << std::endl;
+    std::cout << "Checksum: " << checksum << std::endl;
+
     return 0;
-}
\ No newline at end of file
+}